@@ -49,8 +49,10 @@ int main() {
         idx j = static_cast<idx>(std::llround(std::pow(2, n - i - 1)));
         // compute the a^(2^(n-i-1)) mod N
         idx aj = modpow(a, j, N);
-        // apply the controlled modular multiplication
-        psi = applyCTRL(psi, gt.MODMUL(aj, N, n), {i}, second_subsys);
+        // apply the controlled modular multiplication, as a permutation of
+        // the basis states (no 2^n x 2^n matrix is involved)
+        applyCTRL_permutation_inplace(psi, gt.MODMUL_perm(aj, N, n), {i},
+                                      second_subsys);
     }
 
     // apply inverse QFT on first half of the qubits
@@ -39,7 +39,11 @@ namespace qpp {
  * \see qpp::QEngine
  */
 class QCircuit : public IDisplay, public IJSON {
-    friend class QEngine;
+    template <typename>
+    friend class QEngineT;
+    friend class QDensityEngine;
+    friend class QMPSEngine;
+    friend class QStabilizerEngine;
 
     idx nq_;                     ///< number of qudits
     idx nc_;                     ///< number of classical "dits"
@@ -83,6 +87,48 @@ class QCircuit : public IDisplay, public IJSON {
         cmat_hash_tbl_.insert({hashU, U});
     }
 
+    /**
+     * \brief Checks whether a gate is diagonal in the computational basis
+     *
+     * \param U Complex matrix
+     * \return True if all off-diagonal elements of \a U are exactly zero,
+     * false otherwise
+     */
+    static bool is_diagonal_(const cmat& U) { return U.isDiagonal(0); }
+
+    /**
+     * \brief Checks whether a gate is a permutation gate, possibly with
+     * phases, i.e. whether every column of the gate has exactly one non-zero
+     * element, and if so computes the permutation and the phases
+     *
+     * \param U Complex matrix
+     * \param perm Permutation of the basis states, such that
+     * \f$U|m\rangle = \mathrm{phases}(m)|\mathrm{perm}[m]\rangle\f$
+     * \param phases Column vector of the phases
+     * \return True if \a U is a permutation gate, false otherwise
+     */
+    static bool get_permutation_(const cmat& U, std::vector<idx>& perm,
+                                 cmat& phases) {
+        idx D = static_cast<idx>(U.rows());
+        perm.assign(D, 0);
+        phases = cmat::Zero(D, 1);
+        std::vector<bool> is_image(D, false);
+        for (idx j = 0; j < D; ++j) {
+            idx count = 0;
+            for (idx i = 0; i < D && count < 2; ++i)
+                if (U(i, j) != 0.) {
+                    perm[j] = i;
+                    ++count;
+                }
+            if (count != 1 || is_image[perm[j]])
+                return false;
+            is_image[perm[j]] = true;
+            phases(j) = U(perm[j], j);
+        }
+
+        return true;
+    }
+
   public:
     /**
      * \brief Type of gate being executed in a gate step
@@ -100,6 +146,10 @@ class QCircuit : public IDisplay, public IJSON {
 
         FAN, ///< same unitary gate on multiple qudits
 
+        QFT, ///< quantum Fourier transform on multiple qudits
+
+        TFQ, ///< inverse quantum Fourier transform on multiple qudits
+
         SINGLE_CTRL_SINGLE_TARGET, ///< controlled 1 qudit unitary gate with
                                    ///< one control and one target
 
@@ -161,6 +211,12 @@ class QCircuit : public IDisplay, public IJSON {
             case GateType::FAN:
                 os << "FAN";
                 break;
+            case GateType::QFT:
+                os << "QFT";
+                break;
+            case GateType::TFQ:
+                os << "TFQ";
+                break;
             case GateType::JOINT:
                 os << "JOINT";
                 break;
@@ -209,6 +265,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::vector<idx> target_{}; ///< target where the gate is applied
         std::vector<idx> shift_{};  ///< shifts in CTRL gates
         std::string name_{};        ///< custom name of the gate(s)
+        bool diagonal_{false}; ///< the gate is diagonal in the computational
+                               ///< basis, hence so is the whole step
 
         /**
          * \brief Default constructor
@@ -224,13 +282,17 @@ class QCircuit : public IDisplay, public IJSON {
          * \param target Target qudit indexes
          * \param shift Optional gate shifts (for CTRL gates)
          * \param name Optional gate name
+         * \param diagonal Optional flag, true if the gate is diagonal in the
+         * computational basis
          */
         explicit GateStep(GateType gate_type, std::size_t gate_hash,
                           std::vector<idx> ctrl, std::vector<idx> target,
-                          std::vector<idx> shift = {}, std::string name = {})
+                          std::vector<idx> shift = {}, std::string name = {},
+                          bool diagonal = false)
             : gate_type_{gate_type}, gate_hash_{gate_hash},
               ctrl_{std::move(ctrl)}, target_{std::move(target)},
-              shift_{std::move(shift)}, name_{std::move(name)} {}
+              shift_{std::move(shift)}, name_{std::move(name)},
+              diagonal_{diagonal} {}
 
         /**
          * \brief Equality operator
@@ -443,6 +505,140 @@ class QCircuit : public IDisplay, public IJSON {
         NOP,         ///< no-op
     };
 
+    /**
+     * \brief Kernel executed by an instruction of a compiled quantum circuit
+     * description
+     * \see qpp::QCircuit::compile()
+     */
+    enum class KernelType {
+        NOP,         ///< no-op
+        APPLY,       ///< gate applied on the target
+        APPLY_CTRL,  ///< controlled gate
+        APPLY_cCTRL, ///< classically-controlled gate
+        QFT,         ///< quantum Fourier transform on the target, whose
+                     ///< final swaps relabel the target qudits
+        TFQ,         ///< inverse quantum Fourier transform on the target,
+                     ///< whose initial swaps relabel the target qudits
+        MEASURE_Z,   ///< measurement in the computational basis
+        MEASURE_V,   ///< measurement in the basis specified by a matrix
+        RESET,       ///< reset of the target
+        DISCARD,     ///< discard of the target
+        DIAGONAL,    ///< diagonal gate on the target, e.g. a run of fused
+                     ///< diagonal gates, stored as its diagonal
+        PERMUTATION, ///< permutation gate, possibly with phases and
+                     ///< controlled, moving the amplitudes by index
+        RELABEL,     ///< swap of the two target qudits, which exchange
+                     ///< their positions, no amplitude is moved
+    };
+
+    /**
+     * \brief Instruction of a compiled quantum circuit description
+     * \see qpp::QCircuit::compile()
+     *
+     * \note Qudit indexes are relative positions with respect to the
+     * measured qudits, i.e. positions in the state of the non-measured qudits.
+     * The positions of the qudits are not in increasing order once some
+     * qudits were relabeled, see qpp::QCircuit::KernelType::RELABEL.
+     */
+    struct Instruction {
+        KernelType kernel_ = KernelType::NOP; ///< kernel
+        idx ip_{}; ///< index of the step the instruction was lowered from,
+                   ///< the last one for fused diagonal gates
+        const cmat* mat_{nullptr}; ///< matrix applied on the target, or
+                                   ///< measurement matrix; for
+                                   ///< classically-controlled gates, points
+                                   ///< to its first d powers U^0, U^1, ...;
+                                   ///< for diagonal gates, to the column
+                                   ///< vector of the diagonal elements; for
+                                   ///< permutation gates, to the column
+                                   ///< vector of the phases, or null if all
+                                   ///< of them are 1
+        const std::vector<idx>* perm_{nullptr}; ///< permutation of the basis
+                                                ///< states of the target for
+                                                ///< permutation gates
+        std::vector<idx> target_{}; ///< target relative positions
+        std::vector<idx> ctrl_{}; ///< control relative positions, or control
+                                  ///< classical dits for classically-
+                                  ///< controlled gates
+        std::vector<idx> shift_{};    ///< shifts in CTRL gates
+        std::vector<idx> measured_{}; ///< qudits (absolute indexes) that
+                                      ///< are measured by the instruction
+        idx c_reg_{};           ///< classical register of a measurement
+        bool destructive_{true}; ///< destructive measurement
+    };
+
+    /**
+     * \class qpp::QCircuit::Program
+     * \brief Quantum circuit description lowered to a flat and immutable
+     * stream of instructions
+     * \see qpp::QCircuit::compile()
+     *
+     * \note A program refers to the matrices stored in the quantum circuit
+     * description it was compiled from, hence it is valid only as long as the
+     * latter is alive and is not modified. It is movable but not copyable, as
+     * its instructions point to the matrices and permutations it owns.
+     */
+    class Program {
+        friend class QCircuit;
+
+        std::vector<cmat> mats_{}; ///< matrices computed at compile time
+        std::vector<std::vector<idx>> perms_{}; ///< permutations of the
+                                                ///< permutation gates
+        std::vector<Instruction> instructions_{}; ///< instructions
+        std::vector<idx> step_begin_{}; ///< index of the first instruction of
+                                        ///< every step, followed by the
+                                        ///< number of instructions
+
+      public:
+        /**
+         * \brief Default constructor
+         */
+        Program() = default;
+
+        /**
+         * \brief Default move constructor
+         */
+        Program(Program&&) = default;
+
+        /**
+         * \brief Default move assignment operator
+         *
+         * \return Reference to the current instance
+         */
+        Program& operator=(Program&&) = default;
+
+        /**
+         * \brief Deleted copy constructor
+         */
+        Program(const Program&) = delete;
+
+        /**
+         * \brief Deleted copy assignment operator
+         */
+        Program& operator=(const Program&) = delete;
+
+        /**
+         * \brief Instructions of the program, in execution order
+         *
+         * \return Instructions of the program
+         */
+        const std::vector<Instruction>& get_instructions() const noexcept {
+            return instructions_;
+        }
+
+        /**
+         * \brief Index of the first instruction lowered from the step \a ip
+         * of the quantum circuit description
+         *
+         * \note The instructions of the step \a ip are the ones from
+         * get_step_begin(\a ip) to get_step_begin(\a ip + 1), excluded
+         *
+         * \param ip Step index, up to the number of steps (included)
+         * \return Index of the first instruction of the step
+         */
+        idx get_step_begin(idx ip) const { return step_begin_.at(ip); }
+    };
+
   private:
     std::vector<GateStep> gates_{};           ///< gates
     std::vector<MeasureStep> measurements_{}; ///< measurements
@@ -474,6 +670,46 @@ class QCircuit : public IDisplay, public IJSON {
         return cmat_hash_tbl_;
     }
 
+    /**
+     * \brief Matrix jointly applied on the target of a gate step
+     *
+     * \note The CTRL-U-U-...-U gate steps (and their classically-controlled
+     * counterparts) store only the single qudit gate U, which is expanded
+     * here to its tensor power acting on all the target qudits
+     *
+     * \param gate_step Gate step
+     * \return Matrix applied on the target of \a gate_step
+     */
+    cmat get_target_mat_(const GateStep& gate_step) const {
+        const cmat& U = cmat_hash_tbl_.at(gate_step.gate_hash_);
+        switch (gate_step.gate_type_) {
+            case GateType::SINGLE_CTRL_MULTIPLE_TARGET:
+            case GateType::MULTIPLE_CTRL_MULTIPLE_TARGET:
+            case GateType::SINGLE_cCTRL_MULTIPLE_TARGET:
+            case GateType::MULTIPLE_cCTRL_MULTIPLE_TARGET:
+                return kronpow(U, gate_step.target_.size());
+            default:
+                return U;
+        }
+    }
+
+    /**
+     * \brief Checks whether a gate step swaps two qudits, i.e. whether it
+     * applies qpp::Gates::SWAPd() on two target qudits, with no control
+     *
+     * \param gate_step Gate step
+     * \return True if \a gate_step swaps two qudits, false otherwise
+     */
+    bool is_swap_(const GateStep& gate_step) const {
+        if ((gate_step.gate_type_ != GateType::TWO &&
+             gate_step.gate_type_ != GateType::JOINT) ||
+            gate_step.target_.size() != 2)
+            return false;
+
+        return cmat_hash_tbl_.at(gate_step.gate_hash_) ==
+               Gates::get_instance().SWAPd(d_);
+    }
+
   public:
     /**
      * \class qpp::QCircuit::iterator
@@ -1401,7 +1637,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::SINGLE, hashU, std::vector<idx>{},
-                            std::vector<idx>{i}, std::vector<idx>{}, name);
+                            std::vector<idx>{i}, std::vector<idx>{}, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -1445,7 +1682,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::TWO, hashU, std::vector<idx>{},
-                            std::vector<idx>{i, j}, std::vector<idx>{}, name);
+                            std::vector<idx>{i, j}, std::vector<idx>{}, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -1493,7 +1731,7 @@ class QCircuit : public IDisplay, public IJSON {
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::THREE, hashU, std::vector<idx>{},
                             std::vector<idx>{i, j, k}, std::vector<idx>{},
-                            name);
+                            name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -1549,7 +1787,7 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::FAN, hashU, std::vector<idx>{}, target,
-                            std::vector<idx>{}, name);
+                            std::vector<idx>{}, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         gate_count_[name] += target.size();
 
@@ -1606,7 +1844,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::FAN, hashU, std::vector<idx>{},
-                            get_non_measured(), std::vector<idx>{}, name);
+                            get_non_measured(), std::vector<idx>{}, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         gate_count_[name] += get_non_measured().size();
 
@@ -1666,7 +1905,7 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::JOINT, hashU, std::vector<idx>{}, target,
-                            std::vector<idx>{}, name);
+                            std::vector<idx>{}, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -1707,51 +1946,23 @@ class QCircuit : public IDisplay, public IJSON {
             throw exception::Duplicates("qpp::QCircuit::QFT()", context);
         // END EXCEPTION CHECKS
 
-        idx n_subsys = target.size();
-        if (d_ == 2) // qubits
-        {
-            for (idx i = 0; i < n_subsys; ++i) {
-                // apply Hadamard on qubit i
-                gate(Gates::get_instance().H, target[i]);
-                // apply controlled rotations
-                for (idx j = 2; j <= n_subsys - i; ++j) {
-                    // construct Rj
-                    cmat Rj(2, 2);
-                    Rj << 1, 0, 0, std::exp(2.0 * pi * 1_i / std::pow(2, j));
-                    CTRL(Rj, target[i + j - 1], target[i], {},
-                         "CTRL-R" + std::to_string(j));
-                }
-            }
-            if (swap) {
-                // we have the qubits in reversed order, we must swap them
-                for (idx i = 0; i < n_subsys / 2; ++i) {
-                    gate(Gates::get_instance().SWAP, target[i],
-                         target[n_subsys - i - 1]);
-                }
-            }
+        std::size_t hashFd = hash_eigen(Gates::get_instance().Fd(d_));
+        add_hash_(Gates::get_instance().Fd(d_), hashFd);
+        gates_.emplace_back(GateType::QFT, hashFd, std::vector<idx>{}, target,
+                            std::vector<idx>{}, "QFT");
+        step_types_.emplace_back(StepType::GATE);
+        ++gate_count_["QFT"];
 
-        } else { // qudits
-            for (idx i = 0; i < n_subsys; ++i) {
-                // apply qudit Fourier on qudit i
-                gate(Gates::get_instance().Fd(d_), target[i], "Fd");
-                // apply controlled rotations
-                for (idx j = 2; j <= n_subsys - i; ++j) {
-                    // construct Rj
-                    cmat Rj = cmat::Zero(d_, d_);
-                    for (idx m = 0; m < d_; ++m) {
-                        Rj(m, m) =
-                            std::exp(2.0 * pi * m * 1_i / std::pow(d_, j));
-                    }
-                    CTRL(Rj, target[i + j - 1], target[i], {},
-                         "CTRL-R" + std::to_string(j) + "d");
-                }
-            }
-            if (swap) {
-                // we have the qudits in reversed order, we must swap them
-                for (idx i = 0; i < n_subsys / 2; ++i) {
-                    gate(Gates::get_instance().SWAPd(d_), target[i],
-                         target[n_subsys - i - 1], "SWAPd");
-                }
+        for (auto&& elem : target) {
+            clean_qudits_[elem] = false;
+        }
+
+        idx n_subsys = target.size();
+        if (!swap) {
+            // the qudits are left in reversed order, we undo the swaps
+            for (idx i = 0; i < n_subsys / 2; ++i) {
+                gate(Gates::get_instance().SWAPd(d_), target[i],
+                     target[n_subsys - i - 1], d_ == 2 ? "SWAP" : "SWAPd");
             }
         }
 
@@ -1790,8 +2001,7 @@ class QCircuit : public IDisplay, public IJSON {
      * \param swap Swaps the qubits at the end (true by default)
      * \return Reference to the current instance
      */
-    QCircuit& TFQ(const std::vector<idx>& target,
-                  QPP_UNUSED_ bool swap = true) {
+    QCircuit& TFQ(const std::vector<idx>& target, bool swap = true) {
         // EXCEPTION CHECKS
 
         std::string context{"Step " + std::to_string(get_step_count())};
@@ -1813,53 +2023,26 @@ class QCircuit : public IDisplay, public IJSON {
         // END EXCEPTION CHECKS
 
         idx n_subsys = target.size();
-        if (d_ == 2) // qubits
-        {
-            if (swap) {
-                // we have the qubits in reversed order, we must swap them
-                for (idx i = n_subsys / 2; i-- > 0;) {
-                    gate(Gates::get_instance().SWAP, target[i],
-                         target[n_subsys - i - 1]);
-                }
-            }
-            for (idx i = n_subsys; i-- > 0;) {
-                // apply controlled rotations
-                for (idx j = n_subsys - i + 1; j-- > 2;) {
-                    // construct Rj
-                    cmat Rj(2, 2);
-                    Rj << 1, 0, 0, std::exp(-2.0 * pi * 1_i / std::pow(2, j));
-                    CTRL(Rj, target[i + j - 1], target[i], {},
-                         "CTRL-R" + std::to_string(j) + "+");
-                }
-                // apply Hadamard on qubit i
-                gate(Gates::get_instance().H, target[i]);
-            }
-        } else { // qudits
-            if (swap) {
-                // we have the qudits in reversed order, we must swap them
-                for (idx i = n_subsys / 2; i-- > 0;) {
-                    gate(Gates::get_instance().SWAPd(d_), target[i],
-                         target[n_subsys - i - 1], "SWAPd");
-                }
-            }
-            for (idx i = n_subsys; i-- > 0;) {
-                // apply controlled rotations
-                for (idx j = n_subsys - i + 1; j-- > 2;) {
-                    // construct Rj
-                    cmat Rj = cmat::Zero(d_, d_);
-                    for (idx m = 0; m < d_; ++m) {
-                        Rj(m, m) =
-                            std::exp(-2.0 * pi * m * 1_i / std::pow(d_, j));
-                    }
-                    CTRL(Rj, target[i + j - 1], target[i], {},
-                         "CTRL-R" + std::to_string(j) + "d+");
-                }
-                // apply qudit Fourier on qudit i
-                gate(qpp::adjoint(Gates::get_instance().Fd(d_)), target[i],
-                     "Fd+");
+        if (!swap) {
+            // the qudits are expected in reversed order, we undo the swaps
+            for (idx i = n_subsys / 2; i-- > 0;) {
+                gate(Gates::get_instance().SWAPd(d_), target[i],
+                     target[n_subsys - i - 1], d_ == 2 ? "SWAP" : "SWAPd");
             }
         }
 
+        cmat Fd_adjoint = qpp::adjoint(Gates::get_instance().Fd(d_));
+        std::size_t hashFd_adjoint = hash_eigen(Fd_adjoint);
+        add_hash_(Fd_adjoint, hashFd_adjoint);
+        gates_.emplace_back(GateType::TFQ, hashFd_adjoint, std::vector<idx>{},
+                            target, std::vector<idx>{}, "TFQ");
+        step_types_.emplace_back(StepType::GATE);
+        ++gate_count_["TFQ"];
+
+        for (auto&& elem : target) {
+            clean_qudits_[elem] = false;
+        }
+
         return *this;
     }
 
@@ -1933,7 +2116,7 @@ class QCircuit : public IDisplay, public IJSON {
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::SINGLE_CTRL_SINGLE_TARGET, hashU,
                             std::vector<idx>{ctrl}, std::vector<idx>{target},
-                            std::vector<idx>{shift}, name);
+                            std::vector<idx>{shift}, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2011,7 +2194,7 @@ class QCircuit : public IDisplay, public IJSON {
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::SINGLE_CTRL_MULTIPLE_TARGET, hashU,
                             std::vector<idx>{ctrl}, target,
-                            std::vector<idx>{shift}, name);
+                            std::vector<idx>{shift}, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2095,7 +2278,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::MULTIPLE_CTRL_SINGLE_TARGET, hashU, ctrl,
-                            std::vector<idx>{target}, shift, name);
+                            std::vector<idx>{target}, shift, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2193,7 +2377,7 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::MULTIPLE_CTRL_MULTIPLE_TARGET, hashU,
-                            ctrl, target, shift, name);
+                            ctrl, target, shift, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2295,7 +2479,7 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::JOINT_CTRL, hashU, ctrl, target, shift,
-                            name);
+                            name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2359,7 +2543,7 @@ class QCircuit : public IDisplay, public IJSON {
         gates_.emplace_back(GateType::SINGLE_cCTRL_SINGLE_TARGET, hashU,
                             std::vector<idx>{ctrl_dit},
                             std::vector<idx>{target}, std::vector<idx>{shift},
-                            name);
+                            name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2430,7 +2614,7 @@ class QCircuit : public IDisplay, public IJSON {
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::SINGLE_cCTRL_MULTIPLE_TARGET, hashU,
                             std::vector<idx>{ctrl_dit}, target,
-                            std::vector<idx>{shift}, name);
+                            std::vector<idx>{shift}, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2507,7 +2691,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::MULTIPLE_cCTRL_SINGLE_TARGET, hashU,
-                            ctrl_dits, std::vector<idx>{target}, shift, name);
+                            ctrl_dits, std::vector<idx>{target}, shift, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2592,7 +2777,8 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::MULTIPLE_cCTRL_MULTIPLE_TARGET, hashU,
-                            ctrl_dits, std::vector<idx>{target}, shift, name);
+                            ctrl_dits, std::vector<idx>{target}, shift, name,
+                            is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2687,7 +2873,7 @@ class QCircuit : public IDisplay, public IJSON {
         std::size_t hashU = hash_eigen(U);
         add_hash_(U, hashU);
         gates_.emplace_back(GateType::JOINT_cCTRL, hashU, ctrl_dits, target,
-                            shift, name);
+                            shift, name, is_diagonal_(U));
         step_types_.emplace_back(StepType::GATE);
         ++gate_count_[name];
 
@@ -2853,14 +3039,16 @@ class QCircuit : public IDisplay, public IJSON {
         if (name.empty())
             name = "m" + qpp::Gates::get_instance().get_name(V);
 
+        std::size_t hashV = hash_eigen(V);
+        add_hash_(V, hashV);
         if (destructive) {
             measured_[target] = true;
             measurements_.emplace_back(MeasureType::MEASURE_V,
-                                       std::vector<std::size_t>{hash_eigen(V)},
+                                       std::vector<std::size_t>{hashV},
                                        std::vector<idx>{target}, c_reg, name);
         } else {
             measurements_.emplace_back(MeasureType::MEASURE_V_ND,
-                                       std::vector<std::size_t>{hash_eigen(V)},
+                                       std::vector<std::size_t>{hashV},
                                        std::vector<idx>{target}, c_reg, name);
         }
         step_types_.emplace_back(StepType::MEASUREMENT);
@@ -2922,15 +3110,17 @@ class QCircuit : public IDisplay, public IJSON {
         if (name.empty())
             name = "m" + qpp::Gates::get_instance().get_name(V);
 
+        std::size_t hashV = hash_eigen(V);
+        add_hash_(V, hashV);
         if (destructive) {
             for (auto&& elem : target)
                 measured_[elem] = true;
             measurements_.emplace_back(MeasureType::MEASURE_V_MANY,
-                                       std::vector<std::size_t>{hash_eigen(V)},
+                                       std::vector<std::size_t>{hashV},
                                        target, c_reg, name);
         } else {
             measurements_.emplace_back(MeasureType::MEASURE_V_MANY_ND,
-                                       std::vector<std::size_t>{hash_eigen(V)},
+                                       std::vector<std::size_t>{hashV},
                                        target, c_reg, name);
         }
         step_types_.emplace_back(StepType::MEASUREMENT);
@@ -3364,6 +3554,10 @@ class QCircuit : public IDisplay, public IJSON {
 
             // modify and add hash
             elem.gate_hash_ = hashUdagger;
+            if (elem.gate_type_ == GateType::QFT)
+                elem.gate_type_ = GateType::TFQ;
+            else if (elem.gate_type_ == GateType::TFQ)
+                elem.gate_type_ = GateType::QFT;
             if (!elem.name_.empty())
                 elem.name_ += "+";
             add_hash_(Udagger, hashUdagger);
@@ -3602,6 +3796,598 @@ class QCircuit : public IDisplay, public IJSON {
         return *this;
     }
 
+    /**
+     * \brief Fuses adjacent gates acting on overlapping qudits into joint
+     * gates acting on at most \a k qudits, in place
+     *
+     * \note Measurements, classically-controlled gates and no-ops act as
+     * fusion barriers, i.e., gates are never moved across them. Gates acting
+     * on more than \a k qudits are kept as they are, and gates applied on all
+     * qudits via qpp::QCircuit::gate_fan() are split into single qudit gates
+     * first. Each fused gate is named "FUSED".
+     *
+     * \param k Maximum number of qudits a fused gate acts on
+     * \return Reference to the current instance
+     */
+    QCircuit& fuse(idx k = 2) {
+        // EXCEPTION CHECKS
+
+        if (k == 0)
+            throw exception::OutOfRange("qpp::QCircuit::fuse()");
+        // END EXCEPTION CHECKS
+
+        // gate step gates_[gate_ip], or only its part acting on fan_target if
+        // it is a FAN gate
+        struct Atom {
+            idx gate_ip;
+            idx fan_target;
+        };
+        // gates acting on the qudits in support (sorted), in execution order
+        struct Block {
+            std::vector<idx> support;
+            std::vector<Atom> atoms;
+        };
+
+        QCircuit result{*this};
+        result.gates_.clear();
+        result.measurements_.clear();
+        result.step_types_.clear();
+        result.gate_count_.clear();
+        result.measurement_count_.clear();
+
+        // qudits on which an atom acts, sorted
+        auto get_support = [&](const Atom& atom) {
+            const GateStep& gate = gates_[atom.gate_ip];
+            if (gate.gate_type_ == GateType::FAN)
+                return std::vector<idx>{atom.fan_target};
+            std::vector<idx> support = gate.target_;
+            if (is_CTRL(gate))
+                support.insert(std::end(support), std::begin(gate.ctrl_),
+                               std::end(gate.ctrl_));
+            std::sort(std::begin(support), std::end(support));
+            return support;
+        };
+
+        // emits an atom as an unmodified gate step
+        auto emit_atom = [&](const Atom& atom) {
+            GateStep gate = gates_[atom.gate_ip];
+            if (gate.gate_type_ == GateType::FAN) {
+                gate.gate_type_ = GateType::SINGLE;
+                gate.target_ = {atom.fan_target};
+            }
+            result.gates_.emplace_back(gate);
+            result.step_types_.emplace_back(StepType::GATE);
+            ++result.gate_count_[gate.name_];
+        };
+
+        // emits a block as a single gate step
+        auto emit_block = [&](const Block& block) {
+            if (block.atoms.size() == 1) {
+                emit_atom(block.atoms[0]);
+                return;
+            }
+
+            idx n = block.support.size();
+            std::vector<idx> dims(n, d_);
+            idx D = static_cast<idx>(std::llround(std::pow(d_, n)));
+            // relative position of qudits w.r.t. the block support
+            auto get_pos = [&](const std::vector<idx>& qudits) {
+                std::vector<idx> pos;
+                for (auto&& q : qudits)
+                    pos.emplace_back(
+                        std::distance(std::begin(block.support),
+                                      std::lower_bound(std::begin(block.support),
+                                                       std::end(block.support),
+                                                       q)));
+                return pos;
+            };
+
+            // computes the block unitary column by column
+            cmat U = cmat::Identity(D, D);
+            ket col(D);
+            for (auto&& atom : block.atoms) {
+                const GateStep& gate = gates_[atom.gate_ip];
+                std::vector<idx> ctrl, target;
+                cmat A;
+                if (gate.gate_type_ == GateType::FAN) {
+                    target = get_pos({atom.fan_target});
+                    A = cmat_hash_tbl_.at(gate.gate_hash_);
+                } else {
+                    target = get_pos(gate.target_);
+                    if (is_CTRL(gate))
+                        ctrl = get_pos(gate.ctrl_);
+                    A = get_target_mat_(gate);
+                }
+                for (idx j = 0; j < D; ++j) {
+                    col = U.col(j);
+                    applyCTRL_inplace(col, A, ctrl, target, dims,
+                                      is_CTRL(gate) ? gate.shift_
+                                                    : std::vector<idx>{});
+                    U.col(j) = col;
+                }
+            }
+
+            GateType gate_type = GateType::JOINT;
+            if (n == 1)
+                gate_type = GateType::SINGLE;
+            else if (n == 2)
+                gate_type = GateType::TWO;
+            else if (n == 3)
+                gate_type = GateType::THREE;
+            std::size_t hashU = hash_eigen(U);
+            result.add_hash_(U, hashU);
+            result.gates_.emplace_back(gate_type, hashU, std::vector<idx>{},
+                                       block.support, std::vector<idx>{},
+                                       "FUSED", is_diagonal_(U));
+            result.step_types_.emplace_back(StepType::GATE);
+            ++result.gate_count_["FUSED"];
+        };
+
+        // the open blocks have pairwise disjoint supports, hence commute
+        std::vector<Block> blocks;
+        auto flush_all = [&]() {
+            for (auto&& block : blocks)
+                emit_block(block);
+            blocks.clear();
+        };
+        auto add_atom = [&](const Atom& atom) {
+            std::vector<idx> support = get_support(atom);
+            std::vector<idx> merged_support = support;
+            std::vector<Block> overlapping, rest;
+            for (auto&& block : blocks) {
+                std::vector<idx> common;
+                std::set_intersection(
+                    std::begin(block.support), std::end(block.support),
+                    std::begin(support), std::end(support),
+                    std::back_inserter(common));
+                if (common.empty()) {
+                    rest.emplace_back(block);
+                } else {
+                    overlapping.emplace_back(block);
+                    merged_support.insert(std::end(merged_support),
+                                          std::begin(block.support),
+                                          std::end(block.support));
+                }
+            }
+            std::sort(std::begin(merged_support), std::end(merged_support));
+            merged_support.erase(std::unique(std::begin(merged_support),
+                                             std::end(merged_support)),
+                                 std::end(merged_support));
+
+            blocks = std::move(rest);
+            if (merged_support.size() <= k) {
+                // fuse the atom with all the blocks it overlaps
+                Block block{merged_support, {}};
+                for (auto&& elem : overlapping)
+                    block.atoms.insert(std::end(block.atoms),
+                                       std::begin(elem.atoms),
+                                       std::end(elem.atoms));
+                block.atoms.emplace_back(atom);
+                blocks.emplace_back(std::move(block));
+            } else {
+                // the atom cannot be fused, emit the blocks it overlaps
+                for (auto&& elem : overlapping)
+                    emit_block(elem);
+                if (support.size() <= k)
+                    blocks.emplace_back(Block{support, {atom}});
+                else
+                    emit_atom(atom);
+            }
+        };
+
+        idx gate_ip = 0;
+        idx measurement_ip = 0;
+        for (auto&& step_type : step_types_) {
+            switch (step_type) {
+                case StepType::GATE: {
+                    const GateStep& gate = gates_[gate_ip];
+                    if (is_cCTRL(gate) || gate.gate_type_ == GateType::QFT ||
+                        gate.gate_type_ == GateType::TFQ) {
+                        flush_all();
+                        emit_atom(Atom{gate_ip, 0});
+                    } else if (gate.gate_type_ == GateType::FAN) {
+                        for (auto&& target : gate.target_)
+                            add_atom(Atom{gate_ip, target});
+                    } else if (gate.gate_type_ != GateType::NONE)
+                        add_atom(Atom{gate_ip, 0});
+                    ++gate_ip;
+                    break;
+                }
+                case StepType::MEASUREMENT: {
+                    flush_all();
+                    const MeasureStep& measurement =
+                        measurements_[measurement_ip++];
+                    result.measurements_.emplace_back(measurement);
+                    result.step_types_.emplace_back(StepType::MEASUREMENT);
+                    ++result.measurement_count_[measurement.name_];
+                    break;
+                }
+                case StepType::NOP:
+                    flush_all();
+                    result.step_types_.emplace_back(StepType::NOP);
+                    break;
+                case StepType::NONE:
+                    break;
+            }
+        }
+        flush_all();
+
+        *this = std::move(result);
+
+        return *this;
+    }
+
+    /**
+     * \brief Lowers the quantum circuit description to a flat stream of
+     * instructions
+     * \see qpp::QCircuit::Program
+     *
+     * \note All matrices are resolved once: gates refer to the matrices
+     * stored in the quantum circuit description, while the matrices acting on
+     * multiple targets of controlled gates and the powers of the matrices of
+     * classically-controlled gates are computed here. Gates applied on all
+     * qudits via qpp::QCircuit::gate_fan() are lowered to one instruction per
+     * qudit. Qudit indexes are lowered to their relative positions with
+     * respect to the measured qudits, assuming the program is executed from
+     * the beginning with no qudit measured.
+     *
+     * \note Diagonal gate steps, see qpp::QCircuit::GateStep::diagonal_, are
+     * lowered to qpp::QCircuit::KernelType::DIAGONAL instructions, executed
+     * as a single elementwise multiplication of the state by the diagonal.
+     * Runs of consecutive diagonal gate steps, acting on any qudits, are
+     * fused into one such instruction as long as the union of their supports
+     * has dimension at most 4096, in which case the instruction belongs to
+     * the last step of the run. Classically-controlled gates are not fused.
+     *
+     * \note Permutation gates, possibly with phases and controlled, e.g.
+     * X, CNOT, SWAP, Toffoli or modular multiplications, are lowered to
+     * qpp::QCircuit::KernelType::PERMUTATION instructions that move the
+     * amplitudes by index, with no matrix-vector multiplication.
+     *
+     * \note Swaps of two qudits, see qpp::QCircuit::is_swap_(), are lowered
+     * to qpp::QCircuit::KernelType::RELABEL instructions: the two qudits
+     * exchange their positions and all later instructions refer to the new
+     * positions, hence no amplitude is moved. The final swaps of the quantum
+     * Fourier transform, and the initial swaps of its inverse, are absorbed
+     * in the same way.
+     *
+     * \param fuse_diagonal If false, diagonal gate steps are not fused
+     * together, e.g. when something has to happen in between the steps
+     * \return Compiled quantum circuit description
+     */
+    Program compile(bool fuse_diagonal = true) const {
+        Program result;
+        result.instructions_.reserve(get_step_count());
+        result.step_begin_.reserve(get_step_count() + 1);
+
+        // relative position of every qudit, -1 for measured qudits
+        std::vector<idx> subsys(nq_);
+        std::iota(std::begin(subsys), std::end(subsys), 0);
+        auto get_relative_pos = [&](const std::vector<idx>& v) {
+            std::vector<idx> rel_pos(v.size());
+            for (idx i = 0; i < v.size(); ++i) {
+                if (subsys[v[i]] == static_cast<idx>(-1))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::compile()");
+                rel_pos[i] = subsys[v[i]];
+            }
+            return rel_pos;
+        };
+        auto set_measured = [&](idx i) {
+            idx pos = subsys[i];
+            subsys[i] = static_cast<idx>(-1);
+            for (idx m = 0; m < nq_; ++m)
+                if (subsys[m] != static_cast<idx>(-1) && subsys[m] > pos)
+                    --subsys[m];
+        };
+        // the qudits v[i] and v[k - 1 - i] exchange their positions
+        auto reverse = [&](const std::vector<idx>& v) {
+            for (idx i = 0; i < v.size() / 2; ++i)
+                std::swap(subsys[v[i]], subsys[v[v.size() - 1 - i]]);
+        };
+
+        // matrices owned by the program, referred by the instructions once
+        // all of them are computed
+        std::vector<std::pair<idx, idx>> mats_refs; // (instruction, matrix)
+        auto add_instruction = [&](Instruction instr) {
+            result.instructions_.emplace_back(std::move(instr));
+        };
+
+        // diagonal gates awaiting to be fused: control and target relative
+        // positions, control shifts and diagonal of the gate on the target
+        struct DiagonalGate {
+            std::vector<idx> ctrl, target, shift;
+            cmat diag;
+            idx ip;
+        };
+        std::vector<DiagonalGate> diag_gates;
+        const idx max_diag_D = 4096;
+        auto flush_diagonal = [&]() {
+            for (idx first = 0, last = 0; first < diag_gates.size();
+                 first = last) {
+                // the longest run of gates starting at first whose support
+                // fits, with at least one gate
+                std::vector<idx> support;
+                idx D = 1;
+                for (; last < diag_gates.size(); ++last) {
+                    std::vector<idx> new_support = support;
+                    idx new_D = D;
+                    for (auto&& v : {diag_gates[last].ctrl,
+                                     diag_gates[last].target})
+                        for (auto&& i : v)
+                            if (std::find(std::begin(new_support),
+                                          std::end(new_support),
+                                          i) == std::end(new_support)) {
+                                new_support.emplace_back(i);
+                                new_D *= d_;
+                            }
+                    if (last > first && new_D > max_diag_D)
+                        break;
+                    support = std::move(new_support);
+                    D = new_D;
+                }
+
+                // strides of the support qudits in the fused diagonal
+                std::vector<idx> strides(support.size());
+                for (idx k = support.size(), stride = 1; k-- > 0;
+                     stride *= d_)
+                    strides[k] = stride;
+                auto get_strides = [&](const std::vector<idx>& v) {
+                    std::vector<idx> result_strides;
+                    for (auto&& i : v)
+                        result_strides.emplace_back(
+                            strides[std::find(std::begin(support),
+                                              std::end(support), i) -
+                                    std::begin(support)]);
+                    return result_strides;
+                };
+
+                // the fused diagonal is the product of the diagonals of the
+                // gates, each controlled gate U being raised to the common
+                // value of its shifted control digits
+                cmat diag = cmat::Ones(D, 1);
+                for (idx g = first; g < last; ++g) {
+                    const DiagonalGate& gate = diag_gates[g];
+                    std::vector<idx> ctrl_strides = get_strides(gate.ctrl);
+                    std::vector<idx> target_strides = get_strides(gate.target);
+                    for (idx m = 0; m < D; ++m) {
+                        idx power = 1;
+                        for (idx k = 0; k < ctrl_strides.size(); ++k) {
+                            idx dit = (m / ctrl_strides[k]) % d_;
+                            if (!gate.shift.empty())
+                                dit = (dit + gate.shift[k]) % d_;
+                            if (k == 0)
+                                power = dit;
+                            else if (dit != power) {
+                                power = 0;
+                                break;
+                            }
+                        }
+                        idx t = 0;
+                        for (auto&& stride : target_strides)
+                            t = t * d_ + (m / stride) % d_;
+                        for (idx p = 0; p < power; ++p)
+                            diag(m) *= gate.diag(t);
+                    }
+                }
+
+                Instruction instr;
+                instr.kernel_ = KernelType::DIAGONAL;
+                instr.ip_ = diag_gates[last - 1].ip;
+                instr.target_ = std::move(support);
+                mats_refs.emplace_back(result.instructions_.size(),
+                                       result.mats_.size());
+                result.mats_.emplace_back(std::move(diag));
+                add_instruction(std::move(instr));
+            }
+            diag_gates.clear();
+        };
+
+        // permutation gates, computed once per gate and dimension: indexes of
+        // the permutation and of the phases (-1 if all of them are 1) owned
+        // by the program, the former being -1 if not a permutation gate
+        std::map<std::pair<std::size_t, idx>, std::pair<idx, idx>> perm_tbl;
+        std::vector<std::pair<idx, idx>> perms_refs; // (instruction, perm)
+        // lowers instr to a permutation instruction if mat is a permutation,
+        // right before the instruction is added
+        auto lower_permutation = [&](Instruction& instr, const GateStep& gate,
+                                     const cmat& mat) {
+            auto key =
+                std::make_pair(gate.gate_hash_, static_cast<idx>(mat.rows()));
+            auto it = perm_tbl.find(key);
+            if (it == perm_tbl.end()) {
+                std::pair<idx, idx> value{static_cast<idx>(-1),
+                                          static_cast<idx>(-1)};
+                std::vector<idx> perm;
+                cmat phases;
+                if (get_permutation_(mat, perm, phases)) {
+                    value.first = result.perms_.size();
+                    result.perms_.emplace_back(std::move(perm));
+                    if (phases != cmat::Ones(mat.rows(), 1)) {
+                        value.second = result.mats_.size();
+                        result.mats_.emplace_back(std::move(phases));
+                    }
+                }
+                it = perm_tbl.emplace(key, value).first;
+            }
+            if (it->second.first == static_cast<idx>(-1))
+                return false;
+
+            instr.kernel_ = KernelType::PERMUTATION;
+            instr.mat_ = nullptr;
+            perms_refs.emplace_back(result.instructions_.size(),
+                                    it->second.first);
+            if (it->second.second != static_cast<idx>(-1))
+                mats_refs.emplace_back(result.instructions_.size(),
+                                       it->second.second);
+            return true;
+        };
+
+        for (auto&& elem : *this) {
+            bool diagonal = elem.type_ == StepType::GATE &&
+                            elem.gates_ip_->diagonal_ &&
+                            !is_cCTRL(*elem.gates_ip_);
+            if (!diagonal)
+                flush_diagonal();
+            result.step_begin_.emplace_back(result.instructions_.size());
+            Instruction instr;
+            instr.ip_ = elem.ip_;
+
+            // diagonal gate step, fused with the next ones if possible
+            if (diagonal) {
+                const GateStep& gate = *elem.gates_ip_;
+                std::vector<idx> target = get_relative_pos(gate.target_);
+                if (gate.gate_type_ == GateType::FAN) {
+                    cmat diag = cmat_hash_tbl_.at(gate.gate_hash_).diagonal();
+                    for (auto&& i : target)
+                        diag_gates.push_back({{}, {i}, {}, diag, elem.ip_});
+                } else if (is_CTRL(gate))
+                    diag_gates.push_back({get_relative_pos(gate.ctrl_),
+                                          std::move(target), gate.shift_,
+                                          get_target_mat_(gate).diagonal(),
+                                          elem.ip_});
+                else
+                    diag_gates.push_back({{},
+                                          std::move(target),
+                                          {},
+                                          get_target_mat_(gate).diagonal(),
+                                          elem.ip_});
+                if (!fuse_diagonal)
+                    flush_diagonal();
+                continue;
+            }
+
+            // gate step
+            if (elem.type_ == StepType::GATE) {
+                const GateStep& gate = *elem.gates_ip_;
+                const cmat& U = cmat_hash_tbl_.at(gate.gate_hash_);
+                instr.target_ = get_relative_pos(gate.target_);
+
+                if (gate.gate_type_ == GateType::FAN) {
+                    instr.kernel_ = KernelType::APPLY;
+                    instr.mat_ = &U;
+                    std::vector<idx> target = instr.target_;
+                    for (auto&& i : target) {
+                        instr.target_ = {i};
+                        lower_permutation(instr, gate, U);
+                        add_instruction(instr);
+                    }
+                    continue;
+                } else if (gate.gate_type_ == GateType::QFT) {
+                    instr.kernel_ = KernelType::QFT;
+                    reverse(gate.target_);
+                    add_instruction(std::move(instr));
+                    continue;
+                } else if (gate.gate_type_ == GateType::TFQ) {
+                    instr.kernel_ = KernelType::TFQ;
+                    reverse(gate.target_);
+                    instr.target_ = get_relative_pos(gate.target_);
+                    add_instruction(std::move(instr));
+                    continue;
+                } else if (is_swap_(gate)) {
+                    instr.kernel_ = KernelType::RELABEL;
+                    reverse(gate.target_);
+                    add_instruction(std::move(instr));
+                    continue;
+                } else if (is_CTRL(gate)) {
+                    instr.kernel_ = KernelType::APPLY_CTRL;
+                    instr.ctrl_ = get_relative_pos(gate.ctrl_);
+                    instr.shift_ = gate.shift_;
+                } else if (is_cCTRL(gate) && nc_ != 0) {
+                    instr.kernel_ = KernelType::APPLY_cCTRL;
+                    instr.ctrl_ = gate.ctrl_;
+                    instr.shift_ = gate.shift_;
+                } else if (gate.gate_type_ != GateType::NONE) {
+                    // regular gates, and classically-controlled gates without
+                    // classical dits, which are always applied
+                    instr.kernel_ = KernelType::APPLY;
+                }
+
+                cmat target_mat = get_target_mat_(gate);
+                if (instr.kernel_ == KernelType::APPLY_cCTRL) {
+                    // the first d powers of the matrix
+                    mats_refs.emplace_back(result.instructions_.size(),
+                                           result.mats_.size());
+                    cmat power = cmat::Identity(target_mat.rows(),
+                                                target_mat.cols());
+                    for (idx m = 0; m < d_; ++m) {
+                        result.mats_.emplace_back(power);
+                        power = power * target_mat;
+                    }
+                } else if (instr.kernel_ != KernelType::NOP &&
+                           lower_permutation(instr, gate, target_mat)) {
+                    // the amplitudes are moved by index
+                } else if (target_mat.rows() != U.rows()) {
+                    // CTRL-U-U-...-U, U expanded to all the targets
+                    mats_refs.emplace_back(result.instructions_.size(),
+                                           result.mats_.size());
+                    result.mats_.emplace_back(std::move(target_mat));
+                } else
+                    instr.mat_ = &U;
+            }
+            // measurement step
+            else if (elem.type_ == StepType::MEASUREMENT) {
+                const MeasureStep& measurement = *elem.measurements_ip_;
+                instr.target_ = get_relative_pos(measurement.target_);
+                instr.c_reg_ = measurement.c_reg_;
+
+                switch (measurement.measurement_type_) {
+                    case MeasureType::NONE:
+                        break;
+                    case MeasureType::MEASURE_Z:
+                    case MeasureType::MEASURE_Z_MANY:
+                    case MeasureType::MEASURE_Z_ND:
+                    case MeasureType::MEASURE_Z_MANY_ND:
+                        instr.kernel_ = KernelType::MEASURE_Z;
+                        break;
+                    case MeasureType::MEASURE_V:
+                    case MeasureType::MEASURE_V_MANY:
+                    case MeasureType::MEASURE_V_ND:
+                    case MeasureType::MEASURE_V_MANY_ND:
+                        instr.kernel_ = KernelType::MEASURE_V;
+                        instr.mat_ =
+                            &cmat_hash_tbl_.at(measurement.mats_hash_[0]);
+                        break;
+                    case MeasureType::RESET:
+                    case MeasureType::RESET_MANY:
+                        instr.kernel_ = KernelType::RESET;
+                        break;
+                    case MeasureType::DISCARD:
+                    case MeasureType::DISCARD_MANY:
+                        instr.kernel_ = KernelType::DISCARD;
+                        break;
+                }
+
+                switch (measurement.measurement_type_) {
+                    case MeasureType::MEASURE_Z:
+                    case MeasureType::MEASURE_Z_MANY:
+                    case MeasureType::MEASURE_V:
+                    case MeasureType::MEASURE_V_MANY:
+                    case MeasureType::DISCARD:
+                    case MeasureType::DISCARD_MANY:
+                        instr.measured_ = measurement.target_;
+                        for (auto&& i : measurement.target_)
+                            set_measured(i);
+                        break;
+                    default:
+                        instr.destructive_ = false;
+                        break;
+                }
+            }
+            add_instruction(std::move(instr));
+        }
+        flush_diagonal();
+        result.step_begin_.emplace_back(result.instructions_.size());
+
+        // now the matrices owned by the program do not move anymore
+        for (auto&& ref : mats_refs)
+            result.instructions_[ref.first].mat_ = &result.mats_[ref.second];
+        for (auto&& ref : perms_refs)
+            result.instructions_[ref.first].perm_ = &result.perms_[ref.second];
+
+        return result;
+    }
+
     /**
      * \brief Equality operator
      * \note Ignores names (e.g. circuit names, gate names etc.) and does
@@ -3845,6 +4631,17 @@ class QCircuit : public IDisplay, public IJSON {
         return qc1.add_circuit(qc2, pos_qudit, pos_dit);
     }
 
+    /**
+     * \brief Fuses adjacent gates acting on overlapping qudits into joint
+     * gates acting on at most \a k qudits
+     * \see qpp::QCircuit::fuse()
+     *
+     * \param qc Quantum circuit description
+     * \param k Maximum number of qudits a fused gate acts on
+     * \return Fused quantum circuit description
+     */
+    friend QCircuit fuse(QCircuit qc, idx k = 2) { return qc.fuse(k); }
+
   private:
     /**
      * \brief qpp::IDisplay::display() override
@@ -34,11 +34,26 @@
 
 namespace qpp {
 /**
- * \class qpp::QEngine
+ * \class qpp::QEngineT
  * \brief Quantum circuit engine, executes qpp::QCircuit
- * \see qpp::QCircuit
+ * \see qpp::QEngine, qpp::QCircuit
+ *
+ * \note The state vector is stored with the scalar type \a Scalar, e.g.
+ * std::complex<float> halves the memory footprint of the state vector with
+ * respect to qpp::QEngine. The gate matrices of the quantum circuit description
+ * are converted to \a Scalar once per run of the circuit, see
+ * qpp::QEngineT::compile_(). The measurement probabilities are computed in
+ * double precision from the amplitudes.
+ *
+ * \note Swaps of two qudits, including the swaps of the quantum Fourier
+ * transform, are not applied on the state vector. Instead, the two qudits
+ * exchange their positions in the state vector, and the later steps act on
+ * the new positions. The state vector is permuted back to the order of the
+ * qudits only when it is read, see qpp::QEngine::get_psi(), or before the
+ * circuit is compiled, see qpp::QEngine::execute(idx, bool).
  */
-class QEngine : public IDisplay, public IJSON {
+template <typename Scalar>
+class QEngineT : public IDisplay, public IJSON {
   protected:
     const QCircuit* qc_; ///< pointer to constant quantum circuit description
 
@@ -49,11 +64,12 @@ class QEngine : public IDisplay, public IJSON {
     struct state_ {
         const QCircuit* qc_; ///< non-owning pointer to the parent
         ///< const quantum circuit description
-        ket psi_{};                   ///< state vector
+        dyn_col_vect<Scalar> psi_{};  ///< state vector
         std::vector<double> probs_{}; ///< measurement probabilities
         std::vector<idx> dits_{};     ///< classical dits, little-endian order
-        std::vector<idx> subsys_{}; ///< keeps track of the measured subsystems,
-        ///< re-label them after measurements
+        std::vector<idx> subsys_{}; ///< position of every qudit in the state
+        ///< vector, -1 for measured qudits; relabeled after measurements and
+        ///< swaps
 
         /**
          * \brief Constructor
@@ -88,15 +104,78 @@ class QEngine : public IDisplay, public IJSON {
          * \brief Resets the engine state
          */
         void reset() {
-            psi_ = States::get_instance().zero(qc_->get_nq(), qc_->get_d());
+            idx D = static_cast<idx>(
+                std::llround(std::pow(qc_->get_d(), qc_->get_nq())));
+            psi_ = dyn_col_vect<Scalar>::Zero(D);
+            psi_(0) = 1;
             probs_ = std::vector<double>(qc_->get_nc(), 0);
             dits_ = std::vector<idx>(qc_->get_nc(), 0);
             subsys_ = std::vector<idx>(qc_->get_nq(), 0);
             std::iota(std::begin(subsys_), std::end(subsys_), 0);
         }
     } st_; ///< current state of the engine
+    std::vector<idx> stats_dims_; ///< mixed radix in which the classical
+    ///< dits are packed, empty if the packed dits do not fit in an idx
+    std::unordered_map<idx, idx>
+        stats_; ///< measurement statistics for multiple runs, packed dits
     std::map<std::string, idx, internal::EqualSameSizeStringDits>
-        stats_; ///< measurement statistics for multiple runs
+        stats_unpacked_; ///< measurement statistics for multiple runs, dits
+    ///< that cannot be packed in the mixed radix qpp::QEngine::stats_dims_
+    std::shared_ptr<const QCircuit::Program>
+        program_; ///< compiled quantum circuit description, set only while
+    ///< qpp::QEngine::execute(idx, bool) runs, see qpp::QEngine::compile_()
+    std::unordered_map<const cmat*, dyn_mat<Scalar>>
+        mats_; ///< matrices of the compiled quantum circuit description
+    ///< converted to the scalar type of the state vector, empty for
+    ///< std::complex<double>
+
+    /**
+     * \brief Mixed radix in which the classical dits of the quantum circuit
+     * description \a qc are packed
+     *
+     * \note The radix of a classical dit is the largest number of outcomes
+     * of the measurements stored in it, and at least the qudit dimension
+     *
+     * \param qc Quantum circuit description
+     * \return Mixed radix, or an empty vector if the packed dits do not fit
+     * in an idx
+     */
+    static std::vector<idx> compute_stats_dims_(const QCircuit& qc) {
+        idx d = qc.get_d();
+        std::vector<idx> dims(qc.get_nc(), d);
+        const auto& h_tbl = qc.get_cmat_hash_tbl_();
+        for (auto&& m : qc.get_measurements_()) {
+            idx outcomes = 0;
+            switch (m.measurement_type_) {
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                    outcomes = static_cast<idx>(
+                        std::llround(std::pow(d, m.target_.size())));
+                    break;
+                case QCircuit::MeasureType::MEASURE_V:
+                case QCircuit::MeasureType::MEASURE_V_MANY:
+                case QCircuit::MeasureType::MEASURE_V_ND:
+                case QCircuit::MeasureType::MEASURE_V_MANY_ND:
+                    outcomes =
+                        static_cast<idx>(h_tbl.at(m.mats_hash_[0]).cols());
+                    break;
+                default:
+                    break;
+            }
+            if (outcomes > dims[m.c_reg_])
+                dims[m.c_reg_] = outcomes;
+        }
+
+        // the packed dits must fit in an idx
+        idx max = std::numeric_limits<idx>::max();
+        for (auto&& dim : dims) {
+            if (max < dim)
+                return {};
+            max /= dim;
+        }
+
+        return dims;
+    }
 
     /**
      * \brief Marks qudit \a i as measured then re-label accordingly the
@@ -110,14 +189,78 @@ class QEngine : public IDisplay, public IJSON {
             throw exception::QuditAlreadyMeasured(
                 "qpp::QEngine::set_measured_()");
         // END EXCEPTION CHECKS
+        idx pos = st_.subsys_[i];
         st_.subsys_[i] = static_cast<idx>(-1); // set qudit i to measured state
-        for (idx m = i; m < qc_->get_nq(); ++m) {
-            if (!get_measured(m)) {
+        for (idx m = 0; m < qc_->get_nq(); ++m) {
+            if (!get_measured(m) && st_.subsys_[m] > pos) {
                 --st_.subsys_[m];
             }
         }
     }
 
+    /**
+     * \brief Swaps the qudits at the relative positions \a pos[i] and
+     * \a pos[k - 1 - i], where \a k is the size of \a pos, by exchanging
+     * their positions, i.e. with no amplitude moved
+     *
+     * \param pos Vector of relative positions
+     */
+    void reverse_positions_(const std::vector<idx>& pos) {
+        idx k = pos.size();
+        std::vector<idx> qudit(qc_->get_nq()); // qudit at every position
+        for (idx m = 0; m < qc_->get_nq(); ++m)
+            if (!get_measured(m))
+                qudit[st_.subsys_[m]] = m;
+        for (idx i = 0; i < k / 2; ++i)
+            std::swap(st_.subsys_[qudit[pos[i]]],
+                      st_.subsys_[qudit[pos[k - 1 - i]]]);
+    }
+
+    /**
+     * \brief Positions of the non-measured qudits in the state vector
+     *
+     * \return Vector with the position of every non-measured qudit, in
+     * increasing order of the qudit indexes
+     */
+    std::vector<idx> get_positions_() const {
+        std::vector<idx> result;
+        for (idx m = 0; m < qc_->get_nq(); ++m)
+            if (!get_measured(m))
+                result.emplace_back(st_.subsys_[m]);
+
+        return result;
+    }
+
+    /**
+     * \brief Checks whether the positions of the non-measured qudits in the
+     * state vector are in increasing order, i.e. no qudits are swapped
+     *
+     * \return True if the positions are in increasing order, false otherwise
+     */
+    bool is_ordered_() const {
+        std::vector<idx> pos = get_positions_();
+        for (idx i = 0; i < pos.size(); ++i)
+            if (pos[i] != i)
+                return false;
+
+        return true;
+    }
+
+    /**
+     * \brief Permutes the state vector so that the positions of the
+     * non-measured qudits are in increasing order
+     * \see qpp::QEngine::get_psi()
+     */
+    void restore_order_() {
+        if (is_ordered_())
+            return;
+        st_.psi_ = get_psi();
+        idx pos = 0;
+        for (idx m = 0; m < qc_->get_nq(); ++m)
+            if (!get_measured(m))
+                st_.subsys_[m] = pos++;
+    }
+
     // giving a vector of non-measured qudits, get their relative position wrt
     // the measured qudits
     /**
@@ -140,6 +283,468 @@ class QEngine : public IDisplay, public IJSON {
         return v;
     }
 
+    /**
+     * \brief Records the classical dits \a dits in the measurement
+     * statistics, provided the circuit has at least one measurement
+     *
+     * \param dits Classical dits
+     * \param reps Number of repetitions that produced \a dits
+     */
+    void update_stats_(const std::vector<idx>& dits, idx reps = 1) {
+        // we measured at least one qudit
+        if (qc_->get_measurement_count() == 0)
+            return;
+
+        if (stats_dims_.size() == dits.size()) {
+            idx packed = 0;
+            bool fits = true;
+            for (idx i = 0; i < dits.size(); ++i) {
+                if (dits[i] >= stats_dims_[i]) {
+                    fits = false;
+                    break;
+                }
+                packed = packed * stats_dims_[i] + dits[i];
+            }
+            if (fits) {
+                stats_[packed] += reps;
+                return;
+            }
+        }
+
+        // e.g. dits set by qpp::QEngine::set_dit() beyond their radix
+        std::stringstream ss;
+        ss << disp(dits, " ", "", "");
+        stats_unpacked_[ss.str()] += reps;
+    }
+
+    /**
+     * \brief Samples the outcomes of \a reps repetitions of the steps
+     * starting from \a first up to the end of the quantum circuit
+     * description directly from the engine state \a entry, and collects
+     * the measurement statistics, provided all those steps are no-ops or
+     * terminal measurements in the computational basis
+     *
+     * \note Measurements in the computational basis commute, hence the
+     * joint distribution of their outcomes follows from the probability
+     * distribution of the computational basis states of \a entry, computed
+     * once. The basis states are drawn by bisecting its cumulative
+     * distribution with the PRNG of the calling thread, and the classical
+     * dits are computed once per distinct basis state.
+     *
+     * \param entry Engine state at the beginning of every repetition
+     * \param first Iterator to the first step of every repetition
+     * \param reps Number of repetitions
+     * \return True if the outcomes were sampled, false if the steps are not
+     * all terminal measurements, in which case nothing is done
+     */
+    bool sample_terminal_(const state_& entry, const QCircuit::iterator& first,
+                          idx reps) {
+        // derived engines may execute the measurement steps differently
+        if (typeid(*this) != typeid(QEngineT))
+            return false;
+
+        const auto& measurements = qc_->get_measurements_();
+        std::vector<idx> m_ips; // measurement steps, in circuit order
+        for (auto it = first; it != qc_->end(); ++it) {
+            auto elem = *it;
+            if (elem.type_ == QCircuit::StepType::NOP)
+                continue;
+            if (elem.type_ != QCircuit::StepType::MEASUREMENT)
+                return false;
+            idx m_ip = std::distance(std::begin(measurements),
+                                     elem.measurements_ip_);
+            switch (measurements[m_ip].measurement_type_) {
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    break;
+                default:
+                    return false;
+            }
+            // already measured qudits are reported by the regular execution
+            for (auto&& target : measurements[m_ip].target_)
+                if (entry.subsys_[target] == static_cast<idx>(-1))
+                    return false;
+            m_ips.emplace_back(m_ip);
+        }
+        // no measurements, all repetitions are identical
+        if (m_ips.empty())
+            return true;
+
+        // cumulative distribution of the computational basis states
+        idx D = static_cast<idx>(entry.psi_.size());
+        std::vector<double> cdf(D);
+        double sum = 0;
+        for (idx i = 0; i < D; ++i) {
+            sum += std::norm(entry.psi_(i));
+            cdf[i] = sum;
+        }
+
+        std::uniform_real_distribution<> ud(0, sum);
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+        std::map<idx, idx> counts;
+        for (idx i = 0; i < reps; ++i) {
+            auto pos = std::upper_bound(std::begin(cdf), std::end(cdf),
+                                        ud(gen)) -
+                       std::begin(cdf);
+            ++counts[std::min(static_cast<idx>(pos), D - 1)];
+        }
+
+        // classical dits of every sampled basis state
+        idx d = qc_->get_d();
+        idx n = static_cast<idx>(std::count_if(
+            std::begin(entry.subsys_), std::end(entry.subsys_),
+            [](idx pos) { return pos != static_cast<idx>(-1); }));
+        std::vector<idx> dims(n, d);
+        for (auto&& count : counts) {
+            std::vector<idx> midx = n2multiidx(count.first, dims);
+            std::vector<idx> dits = entry.dits_;
+            for (auto&& m_ip : m_ips) {
+                const auto& m = measurements[m_ip];
+                std::vector<idx> res;
+                for (auto&& target : m.target_)
+                    res.emplace_back(midx[entry.subsys_[target]]);
+                switch (m.measurement_type_) {
+                    case QCircuit::MeasureType::MEASURE_Z:
+                    case QCircuit::MeasureType::MEASURE_Z_ND:
+                        dits[m.c_reg_] = res[0];
+                        break;
+                    case QCircuit::MeasureType::MEASURE_Z_MANY:
+                    case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                        dits[m.c_reg_] = multiidx2n(
+                            res, std::vector<idx>(res.size(), d));
+                        break;
+                    default:
+                        break;
+                }
+            }
+            update_stats_(dits, count.second);
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Executes the steps starting from \a first up to the end of the
+     * quantum circuit description \a reps times, every time starting from
+     * the engine state \a entry, and collects the measurement statistics
+     *
+     * \note When OpenMP is available, the repetitions are split in
+     * contiguous chunks across the threads. Every thread runs its own copy of
+     * the engine and draws randomness from its thread-local PRNG, seeded from
+     * the PRNG of the calling thread, hence the statistics are deterministic
+     * for a given seed and number of threads. The calling thread's PRNG is
+     * advanced by one draw per thread. Engines of a type further derived from
+     * \a Engine, which cannot be copied without slicing, run serially.
+     *
+     * \note The engine is left in the state of the last repetition
+     *
+     * \tparam Engine Type of the current instance
+     * \param entry Engine state at the beginning of every repetition
+     * \param first Iterator to the first step of every repetition
+     * \param reps Number of repetitions
+     */
+    template <typename Engine>
+    void execute_reps_(const state_& entry, const QCircuit::iterator& first,
+                       idx reps) {
+        Engine& engine = static_cast<Engine&>(*this);
+        idx num_threads = 1;
+#if defined(HAS_OPENMP) && !defined(NO_THREAD_LOCAL_)
+        if (typeid(engine) == typeid(Engine) && !omp_in_parallel())
+            num_threads =
+                std::min(reps, static_cast<idx>(omp_get_max_threads()));
+#endif // HAS_OPENMP && !NO_THREAD_LOCAL_
+
+        if (num_threads <= 1) {
+            for (idx i = 0; i < reps; ++i) {
+                // sets the state of the engine to the entry state
+                st_ = entry;
+                for (auto it = first; it != qc_->end(); ++it)
+                    (void) engine.execute(it);
+                update_stats_(st_.dits_);
+            }
+            return;
+        }
+
+#if defined(HAS_OPENMP) && !defined(NO_THREAD_LOCAL_)
+        // seeds the per-thread PRNGs from the calling thread's PRNG
+        auto& gen = RandomDevices::get_thread_local_instance().get_prng();
+        std::vector<std::mt19937::result_type> seeds(num_threads);
+        for (auto& seed : seeds)
+            seed = gen();
+        auto gen_state = gen; // the calling thread re-seeds it as well
+
+        std::vector<Engine> engines(num_threads, engine);
+        for (auto& elem : engines)
+            elem.clear_results_();
+
+        std::exception_ptr eptr = nullptr;
+#pragma omp parallel num_threads(static_cast<int>(num_threads))
+        {
+            auto t = static_cast<idx>(omp_get_thread_num());
+            auto nt = static_cast<idx>(omp_get_num_threads());
+            Engine& local = engines[t];
+            try {
+                RandomDevices::get_thread_local_instance().get_prng().seed(
+                    seeds[t]);
+                for (idx i = reps * t / nt; i < reps * (t + 1) / nt; ++i) {
+                    local.st_ = entry;
+                    for (auto it = first; it != qc_->end(); ++it)
+                        (void) local.execute(it);
+                    local.update_stats_(local.st_.dits_);
+                    if (i + 1 == reps)
+                        st_ = local.st_;
+                }
+            } catch (...) {
+#pragma omp critical
+                eptr = std::current_exception();
+            }
+        }
+        gen = gen_state;
+        if (eptr)
+            std::rethrow_exception(eptr);
+
+        // merges the per-thread results, in the order of the repetitions
+        for (auto& elem : engines)
+            engine.merge_results_(elem);
+#endif // HAS_OPENMP && !NO_THREAD_LOCAL_
+    }
+
+    /**
+     * \brief Clears the results collected by the engine, invoked on the
+     * per-thread copies of the engine by qpp::QEngine::execute_reps_()
+     *
+     * \note Derived engines that collect additional results hide it
+     */
+    void clear_results_() { reset_stats(); }
+
+    /**
+     * \brief Adds the results collected by the engine \a other to the current
+     * instance, invoked by qpp::QEngine::execute_reps_()
+     *
+     * \note Derived engines that collect additional results hide it
+     *
+     * \param other Engine that ran some of the repetitions
+     */
+    void merge_results_(const QEngineT& other) {
+        for (auto& outcome : other.stats_)
+            stats_[outcome.first] += outcome.second;
+        for (auto& outcome : other.stats_unpacked_)
+            stats_unpacked_[outcome.first] += outcome.second;
+    }
+
+    /**
+     * \brief Compiles the quantum circuit description, invoked by
+     * qpp::QEngine::execute(idx, bool) before running the circuit
+     * \see qpp::QCircuit::compile()
+     *
+     * \note The relative positions of the compiled instructions assume the
+     * steps are executed in order, starting with no measured qudit. Hence the
+     * circuit is not compiled when some qudits are already measured, or when
+     * it measures a qudit twice; its steps are then executed directly from
+     * the quantum circuit description. Otherwise the state vector is first
+     * permuted back to the order of the qudits, see
+     * qpp::QEngine::restore_order_(). The matrices of the instructions are
+     * then converted to the scalar type of the state vector, see
+     * qpp::QEngineT::convert_mats_().
+     *
+     * \param fuse_diagonal Fuses consecutive diagonal gate steps, see
+     * qpp::QCircuit::compile()
+     */
+    void compile_(bool fuse_diagonal = true) {
+        program_ = nullptr;
+        mats_.clear();
+        if (!get_measured().empty())
+            return;
+        restore_order_();
+        try {
+            program_ = std::make_shared<const QCircuit::Program>(
+                qc_->compile(fuse_diagonal));
+        } catch (const exception::QuditAlreadyMeasured&) {
+            return;
+        }
+        convert_mats_(std::is_same<Scalar, cplx>{});
+    }
+
+    /**
+     * \brief Converts the matrices applied by the instructions of the
+     * compiled quantum circuit description, no-op for std::complex<double>
+     * \see qpp::QEngineT::get_mat_()
+     */
+    void convert_mats_(std::true_type) {}
+
+    /**
+     * \brief Converts the matrices applied by the instructions of the
+     * compiled quantum circuit description to the scalar type of the state
+     * vector, every matrix once
+     * \see qpp::QEngineT::get_mat_()
+     *
+     * \note The measurement matrices are not converted, as qpp::measure()
+     * converts them itself
+     */
+    void convert_mats_(std::false_type) {
+        for (auto&& instr : program_->get_instructions()) {
+            if (!instr.mat_ || instr.kernel_ == QCircuit::KernelType::MEASURE_V)
+                continue;
+            // the first d powers for classically-controlled gates
+            idx count = instr.kernel_ == QCircuit::KernelType::APPLY_cCTRL
+                            ? qc_->get_d()
+                            : 1;
+            for (idx m = 0; m < count; ++m)
+                if (mats_.find(instr.mat_ + m) == mats_.end())
+                    mats_.emplace(instr.mat_ + m,
+                                  instr.mat_[m].template cast<Scalar>());
+        }
+    }
+
+    /**
+     * \brief Matrix applied by an instruction of the compiled quantum circuit
+     * description, std::complex<double> case
+     *
+     * \param mat Pointer to the matrix of the instruction
+     * \return The matrix itself
+     */
+    const dyn_mat<Scalar>& get_mat_(const cmat* mat, std::true_type) const {
+        return *mat;
+    }
+
+    /**
+     * \brief Matrix applied by an instruction of the compiled quantum circuit
+     * description, converted by qpp::QEngineT::convert_mats_()
+     *
+     * \param mat Pointer to the matrix of the instruction
+     * \return The matrix converted to the scalar type of the state vector
+     */
+    const dyn_mat<Scalar>& get_mat_(const cmat* mat, std::false_type) const {
+        return mats_.at(mat);
+    }
+
+    /**
+     * \brief Matrix applied by an instruction of the compiled quantum circuit
+     * description, in the scalar type of the state vector
+     *
+     * \param mat Pointer to the matrix of the instruction
+     * \return Matrix in the scalar type of the state vector
+     */
+    const dyn_mat<Scalar>& get_mat_(const cmat* mat) const {
+        return get_mat_(mat, std::is_same<Scalar, cplx>{});
+    }
+
+    /**
+     * \brief Executes an instruction of the compiled quantum circuit
+     * description
+     *
+     * \param instr Instruction
+     */
+    void execute_instruction_(const QCircuit::Instruction& instr) {
+        idx d = qc_->get_d();
+
+        switch (instr.kernel_) {
+            case QCircuit::KernelType::NOP:
+                break;
+            case QCircuit::KernelType::APPLY:
+                apply_inplace(st_.psi_, get_mat_(instr.mat_), instr.target_,
+                              d);
+                break;
+            case QCircuit::KernelType::APPLY_CTRL:
+                applyCTRL_inplace(st_.psi_, get_mat_(instr.mat_), instr.ctrl_,
+                                  instr.target_, d, instr.shift_);
+                break;
+            case QCircuit::KernelType::QFT:
+                applyQFT_inplace(st_.psi_, instr.target_, d, false);
+                reverse_positions_(instr.target_);
+                break;
+            case QCircuit::KernelType::TFQ:
+                applyTFQ_inplace(st_.psi_, instr.target_, d, false);
+                reverse_positions_(instr.target_);
+                break;
+            case QCircuit::KernelType::APPLY_cCTRL: {
+                // all shifted control dits must be equal
+                auto dit = [&](idx m) {
+                    idx result = st_.dits_[instr.ctrl_[m]];
+                    if (!instr.shift_.empty())
+                        result = (result + instr.shift_[m]) % d;
+                    return result;
+                };
+                idx first_dit = dit(0);
+                for (idx m = 1; m < instr.ctrl_.size(); ++m)
+                    if (dit(m) != first_dit)
+                        return;
+                if (first_dit < d)
+                    apply_inplace(st_.psi_, get_mat_(instr.mat_ + first_dit),
+                                  instr.target_, d);
+                else
+                    apply_inplace(st_.psi_,
+                                  powm(get_mat_(instr.mat_ + 1), first_dit),
+                                  instr.target_, d);
+                break;
+            }
+            case QCircuit::KernelType::MEASURE_Z: {
+                std::vector<idx> resZ;
+                double probZ;
+                std::tie(resZ, probZ, st_.psi_) = measure_seq(
+                    st_.psi_, instr.target_, d, instr.destructive_);
+                idx result = 0;
+                for (auto&& r : resZ)
+                    result = result * d + r;
+                st_.dits_[instr.c_reg_] = result;
+                st_.probs_[instr.c_reg_] = probZ;
+                break;
+            }
+            case QCircuit::KernelType::MEASURE_V: {
+                idx mres = 0;
+                std::vector<double> probs;
+                std::vector<dyn_mat<Scalar>> states;
+                std::tie(mres, probs, states) =
+                    measure(st_.psi_, *instr.mat_, instr.target_, d,
+                            instr.destructive_);
+                st_.psi_ = std::move(states[mres]);
+                st_.dits_[instr.c_reg_] = mres;
+                st_.probs_[instr.c_reg_] = probs[mres];
+                break;
+            }
+            case QCircuit::KernelType::RESET:
+                st_.psi_ = qpp::reset(st_.psi_, instr.target_, d);
+                break;
+            case QCircuit::KernelType::DISCARD:
+                std::tie(std::ignore, std::ignore, st_.psi_) =
+                    measure_seq(st_.psi_, instr.target_, d);
+                break;
+            case QCircuit::KernelType::PERMUTATION: {
+                idx D = static_cast<idx>(st_.psi_.rows());
+                std::vector<idx> dims(internal::get_num_subsys(D, d), d);
+                std::vector<idx> shift = instr.shift_;
+                shift.resize(instr.ctrl_.size(), 0);
+                internal::apply_permutation_inplace(
+                    st_.psi_.data(), *instr.perm_,
+                    instr.mat_ ? get_mat_(instr.mat_).data() : nullptr,
+                    instr.ctrl_, instr.target_, dims, shift);
+                break;
+            }
+            case QCircuit::KernelType::DIAGONAL: {
+                idx D = static_cast<idx>(st_.psi_.rows());
+                std::vector<idx> dims(internal::get_num_subsys(D, d), d);
+                internal::apply_diagonal_inplace(st_.psi_.data(), D,
+                                                 get_mat_(instr.mat_).data(),
+                                                 instr.target_, dims);
+                break;
+            }
+            case QCircuit::KernelType::RELABEL:
+                reverse_positions_(instr.target_);
+                break;
+        }
+        for (auto&& i : instr.measured_)
+            set_measured_(i);
+    }
+
   public:
     /**
      * \brief Constructs a quantum engine out of a quantum circuit description
@@ -152,14 +757,16 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \param qc Quantum circuit description
      */
-    explicit QEngine(const QCircuit& qc)
-        : qc_{std::addressof(qc)}, st_{qc_}, stats_{} {}
+    explicit QEngineT(const QCircuit& qc)
+        : qc_{std::addressof(qc)}, st_{qc_},
+          stats_dims_{compute_stats_dims_(qc)}, stats_{}, stats_unpacked_{},
+          program_{}, mats_{} {}
 
     // silence -Weffc++ class has pointer data members
     /**
      * \brief Default copy constructor
      */
-    QEngine(const QEngine&) = default;
+    QEngineT(const QEngineT&) = default;
 
     // silence -Weffc++ class has pointer data members
     /**
@@ -167,25 +774,39 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \return Reference to the current instance
      */
-    QEngine& operator=(const QEngine&) = default;
+    QEngineT& operator=(const QEngineT&) = default;
 
     /**
      * \brief Disables rvalue QCircuit
      */
-    QEngine(QCircuit&&) = delete;
+    QEngineT(QCircuit&&) = delete;
 
     /**
      * \brief Default virtual destructor
      */
-    ~QEngine() override = default;
+    ~QEngineT() override = default;
 
     // getters
     /**
      * \brief Underlying quantum state
      *
+     * \note The order is lexicographical with respect to the remaining
+     * non-measured qudits. If some qudits were swapped, the state vector is
+     * permuted accordingly.
+     *
      * \return Underlying quantum state
      */
-    ket get_psi() const { return st_.psi_; }
+    dyn_col_vect<Scalar> get_psi() const {
+        if (is_ordered_())
+            return st_.psi_;
+
+        std::vector<idx> perm = get_positions_();
+        dyn_col_vect<Scalar> result(st_.psi_.rows());
+        std::vector<idx> dims(perm.size(), qc_->get_d());
+        internal::permute_subsys(st_.psi_.data(), result.data(), dims, perm);
+
+        return result;
+    }
 
     /**
      * \brief Vector with the values of the underlying classical dits
@@ -303,8 +924,56 @@ class QEngine : public IDisplay, public IJSON {
      */
     std::map<std::string, idx, internal::EqualSameSizeStringDits>
     get_stats() const {
+        std::map<std::string, idx, internal::EqualSameSizeStringDits> result =
+            stats_unpacked_;
+        std::vector<idx> dits(stats_dims_.size());
+        for (auto&& elem : stats_) {
+            // unpacks the classical dits
+            idx packed = elem.first;
+            for (idx i = dits.size(); i-- > 0;) {
+                dits[i] = packed % stats_dims_[i];
+                packed /= stats_dims_[i];
+            }
+            std::stringstream ss;
+            ss << disp(dits, " ", "", "");
+            result[ss.str()] += elem.second;
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Measurement statistics for multiple runs, with the classical
+     * dits packed into integers
+     * \see qpp::QEngine::get_stats_dims(), qpp::QEngine::get_stats()
+     *
+     * \note The classical dits are packed in the mixed radix returned by
+     * qpp::QEngine::get_stats_dims(), with the most significant dit located
+     * at index 0, i.e. the key of the vector of measurement results \a dits
+     * is qpp::multiidx2n(dits, get_stats_dims()). Results that do not fit in
+     * this mixed radix, e.g. classical dits set by qpp::QEngine::set_dit(),
+     * are only reported by qpp::QEngine::get_stats().
+     *
+     * \return Hash table with collected measurement statistics for multiple
+     * runs, with hash key being the packed vector of measurement results and
+     * value being the number of occurrences
+     */
+    const std::unordered_map<idx, idx>& get_stats_packed() const {
         return stats_;
     }
+
+    /**
+     * \brief Mixed radix in which the classical dits are packed
+     * \see qpp::QEngine::get_stats_packed()
+     *
+     * \note The radix of a classical dit is the largest number of outcomes
+     * of the measurements stored in it, and at least the qudit dimension
+     *
+     * \return Mixed radix, or an empty vector if the packed classical dits
+     * do not fit in an idx, in which case all results are only reported by
+     * qpp::QEngine::get_stats()
+     */
+    std::vector<idx> get_stats_dims() const { return stats_dims_; }
     // end getters
 
     // setters
@@ -319,7 +988,7 @@ class QEngine : public IDisplay, public IJSON {
      * \param value Classical dit value
      * \return Reference to the current instance
      */
-    QEngine& set_dit(idx i, idx value) {
+    QEngineT& set_dit(idx i, idx value) {
         // EXCEPTION CHECKS
 
         if (i >= qc_->get_nc())
@@ -341,7 +1010,7 @@ class QEngine : public IDisplay, public IJSON {
      * internal vector of classical dits returned by qpp::QEngine::get_dits()
      * \return Reference to the current instance
      */
-    QEngine& set_dits(std::vector<idx> dits) {
+    QEngineT& set_dits(std::vector<idx> dits) {
         // EXCEPTION CHECKS
 
         if (dits.size() != st_.dits_.size())
@@ -361,7 +1030,7 @@ class QEngine : public IDisplay, public IJSON {
      * \param psi State vector
      * \return Reference to the current instance
      */
-    QEngine& set_psi(const ket& psi) {
+    QEngineT& set_psi(const dyn_col_vect<Scalar>& psi) {
         // EXCEPTION CHECKS
 
         idx n = get_non_measured().size();
@@ -371,6 +1040,10 @@ class QEngine : public IDisplay, public IJSON {
         // END EXCEPTION CHECKS
 
         st_.psi_ = psi;
+        idx pos = 0;
+        for (idx m = 0; m < qc_->get_nq(); ++m)
+            if (!get_measured(m))
+                st_.subsys_[m] = pos++;
 
         return *this;
     }
@@ -381,8 +1054,9 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \return Reference to the current instance
      */
-    QEngine& reset_stats() {
+    QEngineT& reset_stats() {
         stats_ = {};
+        stats_unpacked_ = {};
 
         return *this;
     }
@@ -398,7 +1072,7 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \return Reference to the current instance
      */
-    QEngine& reset(bool reset_stats = true) {
+    QEngineT& reset(bool reset_stats = true) {
         st_.reset();
         if (reset_stats)
             this->reset_stats();
@@ -415,7 +1089,7 @@ class QEngine : public IDisplay, public IJSON {
      * \param elem Step to be executed
      * \return Reference to the current instance
      */
-    virtual QEngine& execute(const QCircuit::iterator::value_type& elem) {
+    virtual QEngineT& execute(const QCircuit::iterator::value_type& elem) {
         // EXCEPTION CHECKS
 
         // iterator must point to the same quantum circuit description
@@ -424,12 +1098,21 @@ class QEngine : public IDisplay, public IJSON {
         // the rest of exceptions are caught by the iterator::operator*()
         // END EXCEPTION CHECKS
 
-        auto h_tbl = qc_->get_cmat_hash_tbl_();
+        // compiled quantum circuit description
+        if (program_) {
+            const auto& instructions = program_->get_instructions();
+            idx last = program_->get_step_begin(elem.ip_ + 1);
+            for (idx i = program_->get_step_begin(elem.ip_); i < last; ++i)
+                execute_instruction_(instructions[i]);
+            return *this;
+        }
+
+        const auto& h_tbl = qc_->get_cmat_hash_tbl_();
         idx d = qc_->get_d();
 
         // gate step
         if (elem.type_ == QCircuit::StepType::GATE) {
-            auto gates = qc_->get_gates_();
+            const auto& gates = qc_->get_gates_();
 
             idx q_ip =
                 std::distance(std::begin(qc_->get_gates_()), elem.gates_ip_);
@@ -446,14 +1129,30 @@ class QEngine : public IDisplay, public IJSON {
                 case QCircuit::GateType::TWO:
                 case QCircuit::GateType::THREE:
                 case QCircuit::GateType::JOINT:
-                    st_.psi_ = apply(st_.psi_, h_tbl[gates[q_ip].gate_hash_],
-                                     target_rel_pos, d);
+                    if (qc_->is_swap_(gates[q_ip]))
+                        reverse_positions_(target_rel_pos);
+                    else
+                        apply_inplace(st_.psi_,
+                                      h_tbl.at(gates[q_ip].gate_hash_)
+                                          .template cast<Scalar>(),
+                                      target_rel_pos, d);
                     break;
                 case QCircuit::GateType::FAN:
                     for (idx m = 0; m < gates[q_ip].target_.size(); ++m)
-                        st_.psi_ =
-                            apply(st_.psi_, h_tbl[gates[q_ip].gate_hash_],
-                                  {target_rel_pos[m]}, d);
+                        apply_inplace(st_.psi_,
+                                      h_tbl.at(gates[q_ip].gate_hash_)
+                                          .template cast<Scalar>(),
+                                      {target_rel_pos[m]}, d);
+                    break;
+                case QCircuit::GateType::QFT:
+                    applyQFT_inplace(st_.psi_, target_rel_pos, d, false);
+                    reverse_positions_(target_rel_pos);
+                    break;
+                case QCircuit::GateType::TFQ:
+                    // the qudits are relabeled first
+                    reverse_positions_(target_rel_pos);
+                    target_rel_pos = get_relative_pos_(gates[q_ip].target_);
+                    applyTFQ_inplace(st_.psi_, target_rel_pos, d, false);
                     break;
                 default:
                     break;
@@ -462,16 +1161,20 @@ class QEngine : public IDisplay, public IJSON {
             // controlled gate
             if (QCircuit::is_CTRL(gates[q_ip])) {
                 ctrl_rel_pos = get_relative_pos_(gates[q_ip].ctrl_);
-                st_.psi_ = applyCTRL(st_.psi_, h_tbl[gates[q_ip].gate_hash_],
-                                     ctrl_rel_pos, target_rel_pos, d,
-                                     gates[q_ip].shift_);
+                applyCTRL_inplace(st_.psi_,
+                                  qc_->get_target_mat_(gates[q_ip])
+                                      .template cast<Scalar>(),
+                                  ctrl_rel_pos, target_rel_pos, d,
+                                  gates[q_ip].shift_);
             }
 
             // classically-controlled gate
             if (QCircuit::is_cCTRL(gates[q_ip])) {
                 if (st_.dits_.empty()) {
-                    st_.psi_ = apply(st_.psi_, h_tbl[gates[q_ip].gate_hash_],
-                                     target_rel_pos, d);
+                    apply_inplace(st_.psi_,
+                                  qc_->get_target_mat_(gates[q_ip])
+                                      .template cast<Scalar>(),
+                                  target_rel_pos, d);
                 } else {
                     bool should_apply = true;
                     idx first_dit;
@@ -502,9 +1205,10 @@ class QEngine : public IDisplay, public IJSON {
                         }
                     }
                     if (should_apply) {
-                        st_.psi_ = apply(
+                        apply_inplace(
                             st_.psi_,
-                            powm(h_tbl[gates[q_ip].gate_hash_], first_dit),
+                            powm(qc_->get_target_mat_(gates[q_ip]), first_dit)
+                                .template cast<Scalar>(),
                             target_rel_pos, d);
                     }
                 }
@@ -513,7 +1217,7 @@ class QEngine : public IDisplay, public IJSON {
 
         // measurement step
         else if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
-            auto measurements = qc_->get_measurements_();
+            const auto& measurements = qc_->get_measurements_();
             idx m_ip = std::distance(std::begin(qc_->get_measurements_()),
                                      elem.measurements_ip_);
 
@@ -525,7 +1229,7 @@ class QEngine : public IDisplay, public IJSON {
 
             idx mres = 0;
             std::vector<double> probs;
-            std::vector<cmat> states;
+            std::vector<dyn_mat<Scalar>> states;
 
             switch (measurements[m_ip].measurement_type_) {
                 case QCircuit::MeasureType::NONE:
@@ -548,7 +1252,7 @@ class QEngine : public IDisplay, public IJSON {
                     break;
                 case QCircuit::MeasureType::MEASURE_V:
                     std::tie(mres, probs, states) = measure(
-                        st_.psi_, h_tbl[measurements[m_ip].mats_hash_[0]],
+                        st_.psi_, h_tbl.at(measurements[m_ip].mats_hash_[0]),
                         target_rel_pos, d);
                     st_.psi_ = states[mres];
                     st_.dits_[measurements[m_ip].c_reg_] = mres;
@@ -557,7 +1261,7 @@ class QEngine : public IDisplay, public IJSON {
                     break;
                 case QCircuit::MeasureType::MEASURE_V_MANY:
                     std::tie(mres, probs, states) = measure(
-                        st_.psi_, h_tbl[measurements[m_ip].mats_hash_[0]],
+                        st_.psi_, h_tbl.at(measurements[m_ip].mats_hash_[0]),
                         target_rel_pos, d);
                     st_.psi_ = states[mres];
                     st_.dits_[measurements[m_ip].c_reg_] = mres;
@@ -581,7 +1285,7 @@ class QEngine : public IDisplay, public IJSON {
                 case QCircuit::MeasureType::MEASURE_V_ND:
                 case QCircuit::MeasureType::MEASURE_V_MANY_ND:
                     std::tie(mres, probs, states) = measure(
-                        st_.psi_, h_tbl[measurements[m_ip].mats_hash_[0]],
+                        st_.psi_, h_tbl.at(measurements[m_ip].mats_hash_[0]),
                         target_rel_pos, d, false);
                     st_.psi_ = states[mres];
                     st_.dits_[measurements[m_ip].c_reg_] = mres;
@@ -622,19 +1326,24 @@ class QEngine : public IDisplay, public IJSON {
      * \param it Iterator to the step to be executed
      * \return Reference to the current instance
      */
-    QEngine& execute(const QCircuit::iterator& it) { return execute(*it); }
+    QEngineT& execute(const QCircuit::iterator& it) { return execute(*it); }
 
     /**
      * \brief Executes the entire quantum circuit description
      *
+     * \note The steps before the first measurement are executed only once.
+     * When the remaining steps are all terminal measurements in the
+     * computational basis, their outcomes are sampled from the resulting
+     * state, see qpp::QEngine::sample_terminal_(). Otherwise they are
+     * repeated \a reps times, in parallel when OpenMP is available, see
+     * qpp::QEngine::execute_reps_()
+     *
      * \param reps Number of repetitions
      * \param clear_stats Resets the collected measurement statistics hash
      * table before the run
      * \return Reference to the current instance
      */
-    virtual QEngine& execute(idx reps = 1, bool clear_stats = true) {
-        auto initial_engine_state = st_; // saves the engine entry state
-
+    virtual QEngineT& execute(idx reps = 1, bool clear_stats = true) {
         if (clear_stats)
             reset_stats();
 
@@ -646,26 +1355,25 @@ class QEngine : public IDisplay, public IJSON {
                 break;
             ++first_measurement_it;
         }
-        for (auto it = qc_->begin(); it != first_measurement_it; ++it)
-            execute(it);
-        initial_engine_state.psi_ = get_psi();
-
-        for (idx i = 0; i < reps; ++i) {
-            // sets the state of the engine to the entry state
-            st_ = initial_engine_state;
 
-            for (auto it = first_measurement_it; it != qc_->end(); ++it)
+        compile_();
+        try {
+            for (auto it = qc_->begin(); it != first_measurement_it; ++it)
                 execute(it);
+            auto initial_engine_state = st_; // entry state of every repetition
 
-            // we measured at least one qudit
-            if (qc_->get_measurement_count() > 0) {
-                std::vector<idx> m_res = get_dits();
-
-                std::stringstream ss;
-                ss << disp(m_res, " ", "", "");
-                ++stats_[ss.str()];
-            }
+            // when all measurements are terminal, samples all but the last
+            // repetition, which leaves the engine in a measured state as usual
+            if (reps > 1 && sample_terminal_(initial_engine_state,
+                                             first_measurement_it, reps - 1))
+                reps = 1;
+            execute_reps_<QEngineT>(initial_engine_state,
+                                    first_measurement_it, reps);
+        } catch (...) {
+            program_ = nullptr;
+            throw;
         }
+        program_ = nullptr;
 
         return *this;
     }
@@ -711,17 +1419,17 @@ class QEngine : public IDisplay, public IJSON {
         ss.clear();
 
         // compute the statistics
-        if (!stats_.empty()) {
+        auto stats = get_stats();
+        if (!stats.empty()) {
             result += ", \"stats\": {";
             idx reps = 0;
-            for (auto&& elem : get_stats())
+            for (auto&& elem : stats)
                 reps += elem.second;
             result += "\"reps\": " + std::to_string(reps) + ", ";
-            result += "\"outcomes\": " + std::to_string(stats_.size()) + ", ";
+            result += "\"outcomes\": " + std::to_string(stats.size()) + ", ";
 
-            std::vector<idx> dits_dims(qc_->get_nc(), qc_->get_d());
             std::string sep;
-            for (auto&& elem : get_stats()) {
+            for (auto&& elem : stats) {
                 ss << sep << "\""
                    << "[" << elem.first << "]"
                    << "\" : " << elem.second;
@@ -759,16 +1467,16 @@ class QEngine : public IDisplay, public IJSON {
         os << "last dits: " << disp(get_dits(), ", ");
 
         // compute the statistics
-        if (!stats_.empty()) {
+        auto stats = get_stats();
+        if (!stats.empty()) {
             idx reps = 0;
-            for (auto&& elem : get_stats())
+            for (auto&& elem : stats)
                 reps += elem.second;
             os << "\nstats:\n";
             os << '\t' << "reps: " << reps << '\n';
-            os << '\t' << "outcomes: " << stats_.size() << '\n';
-            std::vector<idx> dits_dims(qc_->get_nc(), qc_->get_d());
+            os << '\t' << "outcomes: " << stats.size() << '\n';
             std::string sep;
-            for (auto&& elem : get_stats()) {
+            for (auto&& elem : stats) {
                 os << sep << '\t' << "[" << elem.first << "]"
                    << ": " << elem.second;
                 sep = '\n';
@@ -777,7 +1485,13 @@ class QEngine : public IDisplay, public IJSON {
 
         return os;
     }
-}; /* class QEngine */
+}; /* class QEngineT */
+
+/**
+ * \brief Quantum circuit engine in double precision, executes qpp::QCircuit
+ * \see qpp::QEngineT
+ */
+using QEngine = QEngineT<cplx>;
 
 /**
  * \class qpp::QNoisyEngine
@@ -793,8 +1507,35 @@ class QEngine : public IDisplay, public IJSON {
  */
 template <typename NoiseModel>
 class QNoisyEngine : public QEngine {
+    friend class QEngineT<cplx>;
+
     NoiseModel noise_;                            ///< quantum noise model
     std::vector<std::vector<idx>> noise_results_; ///< noise results
+
+    /**
+     * \brief Clears the results collected by the engine, including the noise
+     * results
+     */
+    void clear_results_() {
+        QEngine::clear_results_();
+        for (auto& elem : noise_results_)
+            elem.clear();
+    }
+
+    /**
+     * \brief Adds the results collected by the engine \a other to the current
+     * instance, appending its noise results
+     *
+     * \param other Engine that ran some of the repetitions
+     */
+    void merge_results_(const QNoisyEngine& other) {
+        QEngine::merge_results_(other);
+        for (idx i = 0; i < noise_results_.size(); ++i)
+            noise_results_[i].insert(std::end(noise_results_[i]),
+                                     std::begin(other.noise_results_[i]),
+                                     std::end(other.noise_results_[i]));
+    }
+
   public:
     /**
      * \brief Constructs a noisy quantum engine out of a quantum circuit
@@ -826,7 +1567,7 @@ class QNoisyEngine : public QEngine {
         if (elem.type_ != QCircuit::StepType::MEASUREMENT) {
             // apply the noise
             for (auto&& i : target_rel_pos) {
-                st_.psi_ = noise_(st_.psi_, i);
+                noise_.apply_inplace(st_.psi_, i);
                 // record the Kraus operator that occurred
                 noise_results_[elem.ip_].emplace_back(noise_.get_last_idx());
             }
@@ -840,33 +1581,32 @@ class QNoisyEngine : public QEngine {
     /**
      * \brief Executes the entire quantum circuit description
      *
+     * \note Every repetition is an independent quantum trajectory, the
+     * repetitions run in parallel when OpenMP is available, see
+     * qpp::QEngine::execute_reps_(). The noise results of all repetitions are
+     * appended in order to the noise results.
+     *
      * \param reps Number of repetitions
      * \param clear_stats Resets the collected measurement statistics hash
      * table before the run
      * \return Reference to the current instance
      */
     QNoisyEngine& execute(idx reps = 1, bool clear_stats = true) override {
-        auto initial_engine_state = st_; // saves the engine entry state
-
         if (clear_stats)
             reset_stats();
 
-        for (idx i = 0; i < reps; ++i) {
-            // sets the state of the engine to the entry state
-            st_ = initial_engine_state;
-
-            for (auto&& elem : *qc_)
-                (void) execute(elem);
-
-            // we measured at least one qudit
-            if (qc_->get_measurement_count() > 0) {
-                std::vector<idx> m_res = get_dits();
-
-                std::stringstream ss;
-                ss << disp(m_res, " ", "", "");
-                ++stats_[ss.str()];
-            }
+        // the noise is applied before every step, hence the steps cannot be
+        // fused
+        compile_(false);
+        auto initial_engine_state = st_; // saves the engine entry state
+        try {
+            execute_reps_<QNoisyEngine>(initial_engine_state, qc_->begin(),
+                                        reps);
+        } catch (...) {
+            program_ = nullptr;
+            throw;
         }
+        program_ = nullptr;
 
         return *this;
     }
@@ -891,6 +1631,3187 @@ class QNoisyEngine : public QEngine {
     // end getters
 }; /* class QNoisyEngine */
 
+/**
+ * \class qpp::QDensityEngine
+ * \brief Density matrix quantum circuit engine, executes qpp::QCircuit
+ * exactly, optionally in the presence of noise
+ * \see qpp::QEngine, qpp::QNoisyEngine, qpp::QCircuit, qpp::NoiseBase
+ *
+ * Evolves the density matrix of the non-measured qudits. Measurements do not
+ * sample a result; instead, the engine keeps an unnormalized density matrix
+ * for every distinct value of the classical dits, with trace equal to the
+ * probability of that value. A single run hence yields the exact probability
+ * distribution of the measurement results, see
+ * qpp::QDensityEngine::get_stats().
+ *
+ * The optional noise follows the model of qpp::QNoisyEngine, i.e. it is
+ * applied to each non-measured qudit before every non-measurement step, but
+ * exactly, as the quantum channel specified by the Kraus operators of the
+ * noise model.
+ *
+ * \note Gates and noise are applied in-place, see qpp::applyCTRL_inplace()
+ * and qpp::apply_inplace(), so the memory footprint is that of the density
+ * matrices, e.g. 4 GB for 14 qubits before any measurement
+ */
+class QDensityEngine : public IDisplay, public IJSON {
+  protected:
+    const QCircuit* qc_;   ///< pointer to constant quantum circuit description
+    std::vector<cmat> Ks_; ///< Kraus operators of the noise, empty if noiseless
+    std::map<std::vector<idx>, cmat>
+        branches_; ///< unnormalized density matrices of the non-measured
+    ///< qudits, indexed by the classical dits
+    std::vector<idx> subsys_; ///< keeps track of the measured subsystems,
+    ///< re-label them after measurements
+
+    /**
+     * \brief Marks qudit \a i as measured then re-label accordingly the
+     * remaining non-measured qudits
+     * \param i Qudit index
+     */
+    void set_measured_(idx i) {
+        // EXCEPTION CHECKS
+
+        if (get_measured(i))
+            throw exception::QuditAlreadyMeasured(
+                "qpp::QDensityEngine::set_measured_()");
+        // END EXCEPTION CHECKS
+        subsys_[i] = static_cast<idx>(-1); // set qudit i to measured state
+        for (idx m = i; m < qc_->get_nq(); ++m) {
+            if (!get_measured(m)) {
+                --subsys_[m];
+            }
+        }
+    }
+
+    /**
+     * \brief Giving a vector \a v of non-measured qudits, gets their relative
+     * position with respect to the measured qudits
+     *
+     * \param v Vector of non-measured qudit indexes
+     * \return Vector of qudit indexes
+     */
+    std::vector<idx> get_relative_pos_(std::vector<idx> v) const {
+        idx vsize = v.size();
+        for (idx i = 0; i < vsize; ++i) {
+            // EXCEPTION CHECKS
+            if (get_measured(v[i]))
+                throw exception::QuditAlreadyMeasured(
+                    "qpp::QDensityEngine::get_relative_pos_()");
+            // END EXCEPTION CHECKS
+            v[i] = subsys_[v[i]];
+        }
+        return v;
+    }
+
+    /**
+     * \brief Projects the density matrix \a rho onto the computational basis
+     * states of the qudits \a target
+     *
+     * \param rho Density matrix
+     * \param target Qudit indexes, relative to \a rho
+     * \param d Qudit dimension
+     * \param destructive Traces out the qudits \a target from the resulting
+     * density matrices
+     * \return Unnormalized post-measurement density matrices, indexed by the
+     * measurement result, the first qudit in \a target being the most
+     * significant
+     */
+    static std::vector<cmat> project_Z_(const cmat& rho,
+                                        const std::vector<idx>& target, idx d,
+                                        bool destructive) {
+        idx D = static_cast<idx>(rho.rows());
+        idx n = internal::get_num_subsys(D, d);
+
+        // strides of the qudits in rho
+        std::vector<idx> strides(n, 1);
+        for (idx i = n - 1; i > 0; --i)
+            strides[i - 1] = strides[i] * d;
+        std::vector<idx> rest = complement(target, n);
+
+        // offsets in rho of the basis states of a subset of the qudits
+        auto offsets = [&](const std::vector<idx>& subsys) {
+            idx size =
+                static_cast<idx>(std::llround(std::pow(d, subsys.size())));
+            std::vector<idx> result(size, 0);
+            for (idx i = 0; i < size; ++i) {
+                idx rem = i;
+                for (idx k = subsys.size(); k-- > 0;) {
+                    result[i] += (rem % d) * strides[subsys[k]];
+                    rem /= d;
+                }
+            }
+            return result;
+        };
+        std::vector<idx> offsets_target = offsets(target);
+        std::vector<idx> offsets_rest = offsets(rest);
+        idx Dt = offsets_target.size();
+        idx Dr = offsets_rest.size();
+
+        std::vector<cmat> result(Dt);
+        for (idx m = 0; m < Dt; ++m) {
+            idx om = offsets_target[m];
+            cmat& rho_m = result[m];
+            if (destructive)
+                rho_m.resize(Dr, Dr);
+            else
+                rho_m = cmat::Zero(D, D);
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+            // column major order for speed
+            for (idx j = 0; j < Dr; ++j) {
+                idx col = offsets_rest[j] + om;
+                for (idx i = 0; i < Dr; ++i) {
+                    idx row = offsets_rest[i] + om;
+                    if (destructive)
+                        rho_m(i, j) = rho(row, col);
+                    else
+                        rho_m(row, col) = rho(row, col);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Replaces every branch by its post-measurement branches
+     *
+     * \param c_reg Classical register where the measurement results are
+     * stored
+     * \param project Function that returns the unnormalized post-measurement
+     * density matrices of a branch, indexed by the measurement result
+     */
+    void branch_(idx c_reg,
+                 const std::function<std::vector<cmat>(const cmat&)>& project) {
+        std::map<std::vector<idx>, cmat> branches;
+        for (auto& branch : branches_) {
+            std::vector<cmat> rhos = project(branch.second);
+            branch.second.resize(0, 0); // releases the memory early
+            for (idx m = 0; m < rhos.size(); ++m) {
+                // drops the results that (numerically) cannot occur
+                if (std::abs(trace(rhos[m])) < chop)
+                    continue;
+                std::vector<idx> dits = branch.first;
+                dits[c_reg] = m;
+                auto it = branches.find(dits);
+                if (it == std::end(branches))
+                    branches.emplace(std::move(dits), std::move(rhos[m]));
+                else
+                    it->second += rhos[m];
+            }
+        }
+        branches_ = std::move(branches);
+    }
+
+    /**
+     * \brief Kraus operators of the quantum channel corresponding to the
+     * noise model \a noise
+     *
+     * \note The noise operators of a state-independent noise model occur
+     * with fixed probabilities, which are absorbed into the Kraus operators
+     *
+     * \tparam NoiseModel Quantum noise model, should be derived from
+     * qpp::NoiseBase
+     * \param noise Quantum noise model
+     * \return Kraus operators
+     */
+    template <typename NoiseModel>
+    static std::vector<cmat> get_channel_Ks_(const NoiseModel& noise) {
+        std::vector<cmat> Ks = noise.get_Ks();
+        if (std::is_same<NoiseType::StateIndependent,
+                         typename NoiseModel::noise_type>::value) {
+            std::vector<double> probs = noise.get_probs();
+            for (idx i = 0; i < Ks.size(); ++i)
+                Ks[i] *= std::sqrt(probs[i]);
+        }
+
+        return Ks;
+    }
+
+    /**
+     * \brief Applies the noise channel to every non-measured qudit of every
+     * branch
+     */
+    void apply_noise_() {
+        if (Ks_.empty())
+            return;
+        std::vector<idx> target_rel_pos = get_relative_pos_(get_non_measured());
+        idx d = qc_->get_d();
+        for (auto& branch : branches_)
+            for (auto&& i : target_rel_pos)
+                apply_inplace(branch.second, Ks_, {i}, d);
+    }
+
+  public:
+    /**
+     * \brief Constructs a noiseless density matrix quantum engine out of a
+     * quantum circuit description
+     *
+     * \note The quantum circuit description must be an lvalue
+     * \see qpp::QDensityEngine(QCircuit&&)
+     *
+     * \note The initial underlying quantum state is set to
+     * \f$|0\rangle\langle 0|^{\otimes n}\f$
+     *
+     * \param qc Quantum circuit description
+     */
+    explicit QDensityEngine(const QCircuit& qc)
+        : qc_{std::addressof(qc)}, Ks_{}, branches_{}, subsys_{} {
+        // EXCEPTION CHECKS
+
+        if (qc.get_nq() == 0)
+            throw exception::ZeroSize("qpp::QDensityEngine::QDensityEngine()");
+        // END EXCEPTION CHECKS
+        reset();
+    }
+
+    /**
+     * \brief Constructs a noisy density matrix quantum engine out of a
+     * quantum circuit description
+     *
+     * \note The quantum circuit description must be an lvalue
+     *
+     * \tparam NoiseModel Quantum noise model, should be derived from
+     * qpp::NoiseBase
+     * \param qc Quantum circuit description
+     * \param noise Quantum noise model
+     */
+    template <typename NoiseModel>
+    explicit QDensityEngine(const QCircuit& qc, const NoiseModel& noise)
+        : qc_{std::addressof(qc)}, Ks_{get_channel_Ks_(noise)}, branches_{},
+          subsys_{} {
+        // EXCEPTION CHECKS
+
+        if (qc.get_nq() == 0)
+            throw exception::ZeroSize("qpp::QDensityEngine::QDensityEngine()");
+        // check noise has the correct dimensionality
+        if (qc.get_d() != noise.get_d())
+            throw exception::DimsNotEqual(
+                "qpp::QDensityEngine::QDensityEngine()");
+        // END EXCEPTION CHECKS
+        reset();
+    }
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy constructor
+     */
+    QDensityEngine(const QDensityEngine&) = default;
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy assignment operator
+     *
+     * \return Reference to the current instance
+     */
+    QDensityEngine& operator=(const QDensityEngine&) = default;
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QDensityEngine(QCircuit&&) = delete;
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    template <typename NoiseModel>
+    QDensityEngine(QCircuit&&, const NoiseModel&) = delete;
+
+    /**
+     * \brief Default virtual destructor
+     */
+    ~QDensityEngine() override = default;
+
+    // getters
+    /**
+     * \brief Underlying density matrix, averaged over the measurement results
+     *
+     * \note The order is lexicographical with respect to the remaining
+     * non-measured qudits
+     *
+     * \return Density matrix of the non-measured qudits
+     */
+    cmat get_rho() const {
+        auto it = std::begin(branches_);
+        cmat result = it->second;
+        for (++it; it != std::end(branches_); ++it)
+            result += it->second;
+
+        return result;
+    }
+
+    /**
+     * \brief Check whether qudit \a i was already measured (destructively)
+     *
+     * \param i Qudit index
+     * \return True if qudit \a i was already measured, false otherwise
+     */
+    bool get_measured(idx i) const {
+        return subsys_[i] == static_cast<idx>(-1);
+    }
+
+    /**
+     * \brief Vector of already measured qudit indexes
+     *
+     * \return Vector of already measured qudit indexes
+     */
+    std::vector<idx> get_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Vector of non-measured qudit indexes
+     *
+     * \return Vector of non-measured qudit indexes
+     */
+    std::vector<idx> get_non_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (!get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Quantum circuit description, lvalue ref qualifier
+     *
+     * \return Const reference to the underlying quantum circuit description
+     */
+    const QCircuit& get_circuit() const& noexcept { return *qc_; }
+
+    /**
+     * \brief Quantum circuit description, rvalue ref qualifier
+     *
+     * \return Copy of the underlying quantum circuit description
+     */
+    QCircuit get_circuit() const&& noexcept { return *qc_; }
+
+    /**
+     * \brief Probability distribution of the measurement results
+     *
+     * \return Hash table with the probabilities of the measurement results,
+     * with hash key being the string representation of the vector of
+     * measurement results, with the most significant bit located at index 0
+     * (i.e. top/left), as in qpp::QEngine::get_stats(). Empty if the quantum
+     * circuit description has no measurements.
+     */
+    std::map<std::string, double, internal::EqualSameSizeStringDits>
+    get_stats() const {
+        std::map<std::string, double, internal::EqualSameSizeStringDits>
+            result;
+        if (qc_->get_measurement_count() == 0)
+            return result;
+
+        for (auto&& branch : branches_) {
+            std::stringstream ss;
+            ss << disp(branch.first, " ", "", "");
+            result[ss.str()] += std::real(trace(branch.second));
+        }
+
+        return result;
+    }
+    // end getters
+
+    /**
+     * \brief Resets the engine
+     *
+     * Re-initializes everything to zero and sets the initial state to
+     * \f$|0\rangle\langle 0|^{\otimes n}\f$
+     *
+     * \return Reference to the current instance
+     */
+    QDensityEngine& reset() {
+        idx D = static_cast<idx>(
+            std::llround(std::pow(qc_->get_d(), qc_->get_nq())));
+        cmat rho = cmat::Zero(D, D);
+        rho(0, 0) = 1;
+        branches_.clear();
+        branches_.emplace(std::vector<idx>(qc_->get_nc(), 0), std::move(rho));
+        subsys_ = std::vector<idx>(qc_->get_nq(), 0);
+        std::iota(std::begin(subsys_), std::end(subsys_), 0);
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param elem Step to be executed
+     * \return Reference to the current instance
+     */
+    QDensityEngine& execute(const QCircuit::iterator::value_type& elem) {
+        // EXCEPTION CHECKS
+
+        // iterator must point to the same quantum circuit description
+        if (elem.value_type_qc_ != qc_)
+            throw exception::InvalidIterator("qpp::QDensityEngine::execute()");
+        // the rest of exceptions are caught by the iterator::operator*()
+        // END EXCEPTION CHECKS
+
+        const auto& h_tbl = qc_->get_cmat_hash_tbl_();
+        idx d = qc_->get_d();
+
+        if (elem.type_ != QCircuit::StepType::MEASUREMENT)
+            apply_noise_();
+
+        // gate step
+        if (elem.type_ == QCircuit::StepType::GATE) {
+            const auto& gate = *elem.gates_ip_;
+            std::vector<idx> target_rel_pos = get_relative_pos_(gate.target_);
+
+            for (auto& branch : branches_) {
+                cmat& rho = branch.second;
+                switch (gate.gate_type_) {
+                    case QCircuit::GateType::SINGLE:
+                    case QCircuit::GateType::TWO:
+                    case QCircuit::GateType::THREE:
+                    case QCircuit::GateType::JOINT:
+                        apply_inplace(rho, h_tbl.at(gate.gate_hash_),
+                                      target_rel_pos, d);
+                        break;
+                    case QCircuit::GateType::FAN:
+                        for (auto&& i : target_rel_pos)
+                            apply_inplace(rho, h_tbl.at(gate.gate_hash_), {i},
+                                          d);
+                        break;
+                    case QCircuit::GateType::QFT:
+                        applyQFT_inplace(rho, target_rel_pos, d);
+                        break;
+                    case QCircuit::GateType::TFQ:
+                        applyTFQ_inplace(rho, target_rel_pos, d);
+                        break;
+                    default:
+                        break;
+                }
+
+                // controlled gate
+                if (QCircuit::is_CTRL(gate))
+                    applyCTRL_inplace(rho, qc_->get_target_mat_(gate),
+                                      get_relative_pos_(gate.ctrl_),
+                                      target_rel_pos, d, gate.shift_);
+
+                // classically-controlled gate, conditioned on the dits of
+                // the branch
+                if (QCircuit::is_cCTRL(gate)) {
+                    const std::vector<idx>& dits = branch.first;
+                    if (dits.empty()) {
+                        apply_inplace(rho, qc_->get_target_mat_(gate),
+                                      target_rel_pos, d);
+                        continue;
+                    }
+                    std::vector<idx> shift = gate.shift_;
+                    if (shift.empty())
+                        shift = std::vector<idx>(gate.ctrl_.size(), 0);
+                    idx first_dit = (dits[gate.ctrl_[0]] + shift[0]) % d;
+                    bool should_apply = true;
+                    for (idx m = 1; m < gate.ctrl_.size(); ++m) {
+                        if ((dits[gate.ctrl_[m]] + shift[m]) % d !=
+                            first_dit) {
+                            should_apply = false;
+                            break;
+                        }
+                    }
+                    if (should_apply)
+                        apply_inplace(
+                            rho, powm(qc_->get_target_mat_(gate), first_dit),
+                            target_rel_pos, d);
+                }
+            }
+        } // end if gate step
+
+        // measurement step
+        else if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
+            const auto& measurement = *elem.measurements_ip_;
+            std::vector<idx> target_rel_pos =
+                get_relative_pos_(measurement.target_);
+            idx c_reg = measurement.c_reg_;
+
+            // measurement in the computational basis
+            auto measure_Z = [&](bool destructive) {
+                branch_(c_reg, [&](const cmat& rho) {
+                    return project_Z_(rho, target_rel_pos, d, destructive);
+                });
+            };
+            // measurement in the basis specified by the columns of V
+            auto measure_V = [&](bool destructive) {
+                const cmat& V = h_tbl.at(measurement.mats_hash_[0]);
+                branch_(c_reg, [&](const cmat& rho) {
+                    std::vector<double> probs;
+                    std::vector<cmat> rhos;
+                    std::tie(std::ignore, probs, rhos) =
+                        measure(rho, V, target_rel_pos, d, destructive);
+                    for (idx m = 0; m < rhos.size(); ++m)
+                        rhos[m] *= probs[m];
+                    return rhos;
+                });
+            };
+
+            switch (measurement.measurement_type_) {
+                case QCircuit::MeasureType::NONE:
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                    measure_Z(true);
+                    for (auto&& target : measurement.target_)
+                        set_measured_(target);
+                    break;
+                case QCircuit::MeasureType::MEASURE_V:
+                case QCircuit::MeasureType::MEASURE_V_MANY:
+                    measure_V(true);
+                    for (auto&& target : measurement.target_)
+                        set_measured_(target);
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                    measure_Z(false);
+                    break;
+                case QCircuit::MeasureType::MEASURE_V_ND:
+                case QCircuit::MeasureType::MEASURE_V_MANY_ND:
+                    measure_V(false);
+                    break;
+                case QCircuit::MeasureType::RESET:
+                case QCircuit::MeasureType::RESET_MANY: {
+                    // maps every basis state of a qudit to |0>
+                    std::vector<cmat> Ks(d, cmat::Zero(d, d));
+                    for (idx m = 0; m < d; ++m)
+                        Ks[m](0, m) = 1;
+                    for (auto& branch : branches_)
+                        for (auto&& i : target_rel_pos)
+                            apply_inplace(branch.second, Ks, {i}, d);
+                    break;
+                }
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    for (auto& branch : branches_) {
+                        std::vector<cmat> rhos = project_Z_(
+                            branch.second, target_rel_pos, d, true);
+                        branch.second = std::move(rhos[0]);
+                        for (idx m = 1; m < rhos.size(); ++m)
+                            branch.second += rhos[m];
+                    }
+                    for (auto&& target : measurement.target_)
+                        set_measured_(target);
+                    break;
+            } // end switch on measurement type
+        }     // end else if measurement step
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param it Iterator to the step to be executed
+     * \return Reference to the current instance
+     */
+    QDensityEngine& execute(const QCircuit::iterator& it) {
+        return execute(*it);
+    }
+
+    /**
+     * \brief Executes the entire quantum circuit description, starting from
+     * the current state of the engine
+     *
+     * \return Reference to the current instance
+     */
+    QDensityEngine& execute() {
+        for (auto&& elem : *qc_)
+            (void) execute(elem);
+
+        return *this;
+    }
+
+    /**
+     * \brief qpp::IJSON::to_JSON() override
+     *
+     * Displays the state of the engine in JSON format
+     *
+     * \param enclosed_in_curly_brackets If true, encloses the result in
+     * curly brackets
+     * \return String containing the JSON representation of the state of the
+     * engine
+     */
+    std::string to_JSON(bool enclosed_in_curly_brackets = true) const override {
+        std::string result;
+
+        if (enclosed_in_curly_brackets)
+            result += "{";
+
+        std::ostringstream ss;
+        ss << disp(get_measured(), ", ");
+        result += "\"measured/discarded (destructive)\" : " + ss.str() + ", ";
+
+        ss.str("");
+        ss.clear();
+        ss << disp(get_non_measured(), ", ");
+        result += "\"non-measured/non-discarded\" : " + ss.str();
+
+        ss.str("");
+        ss.clear();
+
+        // the probability distribution of the measurement results
+        auto stats = get_stats();
+        if (!stats.empty()) {
+            result += ", \"stats\": {";
+            result += "\"outcomes\": " + std::to_string(stats.size()) + ", ";
+
+            std::string sep;
+            for (auto&& elem : stats) {
+                ss << sep << "\""
+                   << "[" << elem.first << "]"
+                   << "\" : " << elem.second;
+                sep = ", ";
+            }
+            ss << '}';
+            result += ss.str();
+        }
+
+        if (enclosed_in_curly_brackets)
+            result += "}";
+
+        return result;
+    }
+
+  private:
+    /**
+     * \brief qpp::IDisplay::display() override
+     *
+     * Writes to the output stream a textual representation of the state of
+     * the engine
+     *
+     * \param os Output stream passed by reference
+     * \return Reference to the output stream
+     */
+    std::ostream& display(std::ostream& os) const override {
+        os << "measured/discarded (destructive): " << disp(get_measured(), ", ")
+           << '\n';
+        os << "non-measured/non-discarded: " << disp(get_non_measured(), ", ");
+
+        // the probability distribution of the measurement results
+        auto stats = get_stats();
+        if (!stats.empty()) {
+            os << "\nstats:\n";
+            os << '\t' << "outcomes: " << stats.size() << '\n';
+            std::string sep;
+            for (auto&& elem : stats) {
+                os << sep << '\t' << "[" << elem.first << "]"
+                   << ": " << elem.second;
+                sep = '\n';
+            }
+        }
+
+        return os;
+    }
+}; /* class QDensityEngine */
+
+/**
+ * \class qpp::QMPSEngine
+ * \brief Matrix product state quantum circuit engine, executes qpp::QCircuit
+ * \see qpp::QEngine, qpp::QCircuit
+ *
+ * Stores the state of the non-measured qudits as a matrix product state (MPS)
+ * in mixed canonical form, i.e. as a chain of site tensors \f$A(a, s, b)\f$,
+ * one per qudit, with the physical index \f$s\f$ and the left and right bond
+ * indexes \f$a\f$ and \f$b\f$. The memory footprint grows with the
+ * entanglement of the state across the bonds of the chain, and not with the
+ * number of qudits, so circuits on many qudits that create little
+ * entanglement, e.g. shallow circuits, can be executed with the same interface
+ * as qpp::QEngine.
+ *
+ * A gate acting on more than one qudit is applied to the contraction of the
+ * sites of its qudits, which are first made adjacent by a network of swaps of
+ * neighbouring sites. The contraction is then split back into sites by
+ * successive singular value decompositions, each one truncated to at most
+ * qpp::QMPSEngine::get_max_bond_dim() singular values, and dropping the
+ * smallest singular values as long as the sum of their squares does not
+ * exceed qpp::QMPSEngine::get_max_trunc_err(), relative to the squared norm of
+ * the state. The state is renormalized after every truncation, and the
+ * discarded weights are accumulated in qpp::QMPSEngine::get_trunc_err().
+ *
+ * \note The swaps are not undone, i.e. the qudits move along the chain as
+ * the circuit executes. The quantum Fourier transform steps are decomposed
+ * into single qudit Fourier transforms and controlled phases, and the
+ * reversal of their target qudits only relabels the sites.
+ *
+ * \note Measurements in the computational basis act on a single site and need
+ * no swaps. Destructive measurements remove the measured sites from the chain.
+ */
+class QMPSEngine : public IDisplay, public IJSON {
+  protected:
+    /**
+     * \brief Row-major complex matrix, the layout of the site tensors
+     */
+    using rmat =
+        Eigen::Matrix<cplx, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    const QCircuit* qc_; ///< pointer to constant quantum circuit description
+    idx max_bond_dim_;   ///< maximum bond dimension
+    double max_trunc_err_; ///< maximum relative truncation error of a single
+    ///< singular value decomposition
+
+    /**
+     * \class qpp::QMPSEngine::state_
+     * \brief Current state of the engine
+     */
+    struct state_ {
+        std::vector<rmat> sites_{}; ///< site tensors of the non-measured
+        ///< qudits, A(a, s, b) stored as (left bond * d) x (right bond) matrix
+        std::vector<idx> qudits_{}; ///< qudit held by every site
+        std::vector<idx> pos_{}; ///< site of every qudit, -1 if measured
+        idx center_{0}; ///< orthogonality center, the sites on its left
+        ///< (right) are left (right) orthonormal
+        double trunc_err_{0};         ///< accumulated truncation error
+        std::vector<double> probs_{}; ///< measurement probabilities
+        std::vector<idx> dits_{};     ///< classical dits, little-endian order
+    } st_;                            ///< current state of the engine
+    std::map<std::string, idx, internal::EqualSameSizeStringDits>
+        stats_; ///< measurement statistics for multiple runs
+
+    /**
+     * \brief Pseudo-random number generator of the calling thread
+     *
+     * \return Reference to the pseudo-random number generator
+     */
+    static std::mt19937& get_prng_() {
+        return
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+    }
+
+    /**
+     * \brief Site of the non-measured qudit \a i
+     *
+     * \param i Qudit index
+     * \return Site index
+     */
+    idx get_site_(idx i) const {
+        // EXCEPTION CHECKS
+
+        if (i >= qc_->get_nq())
+            throw exception::OutOfRange("qpp::QMPSEngine::get_site_()");
+        if (get_measured(i))
+            throw exception::QuditAlreadyMeasured(
+                "qpp::QMPSEngine::get_site_()");
+        // END EXCEPTION CHECKS
+
+        return st_.pos_[i];
+    }
+
+    /**
+     * \brief Moves the orthogonality center to the site \a p, by QR
+     * decompositions of the sites in between
+     *
+     * \param p Site index
+     */
+    void move_center_(idx p) {
+        idx d = qc_->get_d();
+        auto& sites = st_.sites_;
+
+        while (st_.center_ < p) {
+            idx c = st_.center_;
+            idx rows = static_cast<idx>(sites[c].rows());
+            idx cols = static_cast<idx>(sites[c].cols());
+            idx r = std::min(rows, cols);
+            Eigen::HouseholderQR<cmat> qr(sites[c]);
+            cmat R = qr.matrixQR().topRows(r).triangularView<Eigen::Upper>();
+            sites[c] = qr.householderQ() * cmat::Identity(rows, r);
+            // absorbs R in the next site, viewed as a (bond) x (d * bond)
+            // matrix
+            const rmat& B = sites[c + 1];
+            idx chi_r = static_cast<idx>(B.cols());
+            rmat next = R * Eigen::Map<const rmat>(B.data(), cols, d * chi_r);
+            sites[c + 1] = Eigen::Map<rmat>(next.data(), r * d, chi_r);
+            ++st_.center_;
+        }
+
+        while (st_.center_ > p) {
+            idx c = st_.center_;
+            idx chi_l = static_cast<idx>(sites[c].rows()) / d;
+            idx chi_r = static_cast<idx>(sites[c].cols());
+            idx r = std::min(chi_l, d * chi_r);
+            // LQ decomposition from the QR decomposition of the adjoint
+            Eigen::HouseholderQR<cmat> qr(
+                Eigen::Map<const rmat>(sites[c].data(), chi_l, d * chi_r)
+                    .adjoint());
+            cmat R = qr.matrixQR().topRows(r).triangularView<Eigen::Upper>();
+            rmat Q = (qr.householderQ() * cmat::Identity(d * chi_r, r))
+                         .adjoint();
+            sites[c] = Eigen::Map<rmat>(Q.data(), r * d, chi_r);
+            sites[c - 1] = (sites[c - 1] * R.adjoint()).eval();
+            --st_.center_;
+        }
+    }
+
+    /**
+     * \brief Contracts \a count consecutive sites, starting at the site
+     * \a first
+     *
+     * \param first Site index
+     * \param count Number of sites
+     * \return Contracted tensor, stored as (left bond * d^count) x
+     * (right bond) matrix
+     */
+    rmat contract_(idx first, idx count) const {
+        idx d = qc_->get_d();
+        rmat result = st_.sites_[first];
+        for (idx p = first + 1; p < first + count; ++p) {
+            const rmat& A = st_.sites_[p];
+            idx chi = static_cast<idx>(A.rows()) / d;
+            idx chi_r = static_cast<idx>(A.cols());
+            rmat next =
+                result * Eigen::Map<const rmat>(A.data(), chi, d * chi_r);
+            result = Eigen::Map<rmat>(next.data(), next.rows() * d, chi_r);
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Number of singular values kept by a truncated singular value
+     * decomposition, accumulates the truncation error
+     *
+     * \param svals Singular values, in decreasing order
+     * \return Number of kept singular values
+     */
+    idx truncate_(const dyn_col_vect<double>& svals) {
+        double total = svals.squaredNorm();
+        double discarded = 0;
+        idx r = static_cast<idx>(svals.size());
+        while (r > 1) {
+            double w = svals(r - 1) * svals(r - 1);
+            if (r <= max_bond_dim_ && discarded + w > max_trunc_err_ * total)
+                break;
+            discarded += w;
+            --r;
+        }
+        if (total > 0)
+            st_.trunc_err_ += discarded / total;
+
+        return r;
+    }
+
+    /**
+     * \brief Replaces \a count_old consecutive sites, starting at the site
+     * \a first, by the sites of the qudits \a qudits obtained by splitting the
+     * tensor \a psi
+     *
+     * \note The orthogonality center must be one of the replaced sites, and
+     * is left on the last new site. If \a qudits is empty, \a psi is
+     * absorbed in a neighbouring site, which becomes the orthogonality center.
+     *
+     * \param psi Tensor with left bond \a chi_l, the physical indexes of the
+     * qudits \a qudits and right bond \a chi_r, row-major
+     * \param first Site index
+     * \param count_old Number of replaced sites
+     * \param qudits Qudits held by the new sites
+     * \param chi_l Left bond dimension
+     * \param chi_r Right bond dimension
+     */
+    void split_(const ket& psi, idx first, idx count_old,
+                const std::vector<idx>& qudits, idx chi_l, idx chi_r) {
+        idx d = qc_->get_d();
+        idx count = qudits.size();
+        auto& sites = st_.sites_;
+
+        std::vector<rmat> new_sites;
+        rmat rest = Eigen::Map<const rmat>(psi.data(), chi_l,
+                                           static_cast<idx>(psi.size()) /
+                                               chi_l);
+        for (idx i = 0; i + 1 < count; ++i) {
+            idx chi = static_cast<idx>(rest.rows());
+            idx cols = static_cast<idx>(rest.cols()) / d;
+            Eigen::BDCSVD<cmat> svd(
+                Eigen::Map<const rmat>(rest.data(), chi * d, cols),
+                Eigen::ComputeThinU | Eigen::ComputeThinV);
+            dyn_col_vect<double> svals = svd.singularValues();
+            idx r = truncate_(svals);
+            // renormalizes the kept singular values
+            dyn_col_vect<double> kept = svals.head(r);
+            kept *= svals.norm() / kept.norm();
+            new_sites.emplace_back(svd.matrixU().leftCols(r));
+            rest = kept.asDiagonal() * svd.matrixV().leftCols(r).adjoint();
+        }
+        if (count > 0) {
+            idx chi = static_cast<idx>(rest.rows());
+            new_sites.emplace_back(
+                Eigen::Map<const rmat>(rest.data(), chi * d, chi_r));
+        }
+
+        // replaces the sites
+        sites.erase(std::next(std::begin(sites), first),
+                    std::next(std::begin(sites), first + count_old));
+        sites.insert(std::next(std::begin(sites), first),
+                     std::make_move_iterator(std::begin(new_sites)),
+                     std::make_move_iterator(std::end(new_sites)));
+        for (idx p = first; p < first + count_old; ++p)
+            st_.pos_[st_.qudits_[p]] = static_cast<idx>(-1);
+        st_.qudits_.erase(std::next(std::begin(st_.qudits_), first),
+                          std::next(std::begin(st_.qudits_), first + count_old));
+        st_.qudits_.insert(std::next(std::begin(st_.qudits_), first),
+                           std::begin(qudits), std::end(qudits));
+        for (idx p = first; p < st_.qudits_.size(); ++p)
+            st_.pos_[st_.qudits_[p]] = p;
+
+        if (count > 0) {
+            st_.center_ = first + count - 1;
+            return;
+        }
+
+        // no site left, absorbs the (left bond) x (right bond) matrix in a
+        // neighbouring site, if any
+        if (first > 0) {
+            sites[first - 1] = (sites[first - 1] * rest).eval();
+            st_.center_ = first - 1;
+        } else if (!sites.empty()) {
+            rmat& B = sites[first];
+            idx chi_rr = static_cast<idx>(B.cols());
+            rmat next =
+                rest * Eigen::Map<const rmat>(B.data(), chi_r, d * chi_rr);
+            B = Eigen::Map<rmat>(next.data(), chi_l * d, chi_rr);
+            st_.center_ = first;
+        } else
+            st_.center_ = 0;
+    }
+
+    /**
+     * \brief Swaps the qudits held by the sites \a p and \a p + 1
+     *
+     * \param p Site index
+     */
+    void swap_sites_(idx p) {
+        idx d = qc_->get_d();
+        move_center_(p);
+        idx chi_l = static_cast<idx>(st_.sites_[p].rows()) / d;
+        idx chi_r = static_cast<idx>(st_.sites_[p + 1].cols());
+        rmat theta = contract_(p, 2);
+
+        ket psi(theta.size());
+        for (idx a = 0; a < chi_l; ++a)
+            for (idx s1 = 0; s1 < d; ++s1)
+                for (idx s2 = 0; s2 < d; ++s2)
+                    psi.segment(((a * d + s2) * d + s1) * chi_r, chi_r) =
+                        theta.row((a * d + s1) * d + s2).transpose();
+        split_(psi, p, 2, {st_.qudits_[p + 1], st_.qudits_[p]}, chi_l, chi_r);
+    }
+
+    /**
+     * \brief Moves the non-measured qudits \a qudits to consecutive sites, by
+     * swaps of neighbouring sites towards the median site of the qudits
+     *
+     * \note The qudits keep their relative order along the chain
+     *
+     * \param qudits Qudit indexes
+     * \return First site of the qudits
+     */
+    idx gather_(const std::vector<idx>& qudits) {
+        std::vector<idx> sites;
+        for (auto&& i : qudits)
+            sites.emplace_back(get_site_(i));
+        std::sort(std::begin(sites), std::end(sites));
+        idx m = sites.size();
+        idx median = m / 2;
+        idx anchor = sites[median];
+
+        // the qudits held by the sites on the left of the median move right
+        for (idx j = median; j-- > 0;) {
+            idx i = st_.qudits_[sites[j]];
+            while (st_.pos_[i] < anchor - (median - j))
+                swap_sites_(st_.pos_[i]);
+        }
+        // the qudits held by the sites on the right of the median move left
+        for (idx j = median + 1; j < m; ++j) {
+            idx i = st_.qudits_[sites[j]];
+            while (st_.pos_[i] > anchor + (j - median))
+                swap_sites_(st_.pos_[i] - 1);
+        }
+
+        return anchor - median;
+    }
+
+    /**
+     * \brief Applies the function \a f to the state of the qudits \a qudits,
+     * on the contraction of their sites
+     *
+     * \param qudits Non-measured qudit indexes
+     * \param f Function that modifies a tensor, as a state vector of the
+     * multi-partite system whose first and last subsystems are the left and
+     * right bonds, and whose other subsystems are the sites. It takes the
+     * state vector, the dimensions of the subsystems and the first site.
+     */
+    void apply_on_(const std::vector<idx>& qudits,
+                   const std::function<void(ket&, const std::vector<idx>&,
+                                            idx)>& f) {
+        idx d = qc_->get_d();
+        idx first = gather_(qudits);
+        idx count = qudits.size();
+        move_center_(first);
+        idx chi_l = static_cast<idx>(st_.sites_[first].rows()) / d;
+        idx chi_r = static_cast<idx>(st_.sites_[first + count - 1].cols());
+
+        rmat theta = contract_(first, count);
+        ket psi = Eigen::Map<const ket>(theta.data(), theta.size());
+        std::vector<idx> dims(count + 2, d);
+        dims.front() = chi_l;
+        dims.back() = chi_r;
+        f(psi, dims, first);
+
+        std::vector<idx> window(
+            std::next(std::begin(st_.qudits_), first),
+            std::next(std::begin(st_.qudits_), first + count));
+        split_(psi, first, count, window, chi_l, chi_r);
+    }
+
+    /**
+     * \brief Positions of the qudits \a qudits in the tensor of
+     * qpp::QMPSEngine::apply_on_()
+     *
+     * \param qudits Qudit indexes
+     * \param first First site of the tensor
+     * \return Subsystem indexes
+     */
+    std::vector<idx> get_window_pos_(std::vector<idx> qudits,
+                                     idx first) const {
+        for (auto& i : qudits)
+            i = st_.pos_[i] - first + 1;
+        return qudits;
+    }
+
+    /**
+     * \brief Applies the gate \a U to the non-measured qudits \a target
+     *
+     * \param U Gate
+     * \param target Qudit indexes
+     */
+    void apply_gate_(const cmat& U, const std::vector<idx>& target) {
+        idx d = qc_->get_d();
+
+        // single qudit gates act on the physical index of their site
+        if (target.size() == 1) {
+            rmat& A = st_.sites_[get_site_(target[0])];
+            idx chi_l = static_cast<idx>(A.rows()) / d;
+            idx chi_r = static_cast<idx>(A.cols());
+            for (idx a = 0; a < chi_l; ++a) {
+                Eigen::Map<rmat> block(A.data() + a * d * chi_r, d, chi_r);
+                block = (U * block).eval();
+            }
+            return;
+        }
+
+        apply_on_(target, [&](ket& psi, const std::vector<idx>& dims,
+                              idx first) {
+            apply_inplace(psi, U, get_window_pos_(target, first), dims);
+        });
+    }
+
+    /**
+     * \brief Applies the gate \a U to the non-measured qudits \a target,
+     * controlled by the non-measured qudits \a ctrl
+     *
+     * \param U Gate
+     * \param ctrl Control qudit indexes
+     * \param target Target qudit indexes
+     * \param shift Shifts of the control qudits, see qpp::applyCTRL()
+     */
+    void apply_ctrl_(const cmat& U, const std::vector<idx>& ctrl,
+                     const std::vector<idx>& target,
+                     const std::vector<idx>& shift) {
+        std::vector<idx> qudits = ctrl;
+        qudits.insert(std::end(qudits), std::begin(target), std::end(target));
+        apply_on_(qudits, [&](ket& psi, const std::vector<idx>& dims,
+                              idx first) {
+            applyCTRL_inplace(psi, U, get_window_pos_(ctrl, first),
+                              get_window_pos_(target, first), dims, shift);
+        });
+    }
+
+    /**
+     * \brief Applies the quantum Fourier transform, or its inverse, to the
+     * non-measured qudits \a target, with the final swaps
+     * \see qpp::applyQFT()
+     *
+     * \note Decomposed into single qudit Fourier transforms and controlled
+     * phases. The phases that do not differ from 1 in double precision are
+     * skipped, and the reversal of the qudits only relabels their sites.
+     *
+     * \param target Qudit indexes, the first one being the most significant
+     * \param inverse Applies the inverse quantum Fourier transform
+     */
+    void apply_QFT_(const std::vector<idx>& target, bool inverse) {
+        idx d = qc_->get_d();
+        idx k = target.size();
+        cmat F = Gates::get_instance().Fd(d);
+        if (inverse)
+            F.adjointInPlace();
+
+        // phase between the digits of the qudits i and j > i
+        auto phase = [&](idx i, idx j, cmat& R) {
+            double angle = 2 * pi / std::pow(d, j - i + 1);
+            if (angle * static_cast<double>((d - 1) * (d - 1)) <
+                std::numeric_limits<double>::epsilon())
+                return false;
+            R = cmat::Identity(d * d, d * d);
+            for (idx x = 1; x < d; ++x)
+                for (idx y = 1; y < d; ++y)
+                    R(x * d + y, x * d + y) = std::polar(
+                        1.0, (inverse ? -angle : angle) * static_cast<double>(
+                                                              x * y));
+            return true;
+        };
+        // reverses the order of the qudits by relabelling their sites
+        auto reverse = [&] {
+            for (idx i = 0; i < k / 2; ++i) {
+                idx a = target[i], b = target[k - 1 - i];
+                std::swap(st_.pos_[a], st_.pos_[b]);
+                st_.qudits_[st_.pos_[a]] = a;
+                st_.qudits_[st_.pos_[b]] = b;
+            }
+        };
+
+        cmat R;
+        if (!inverse) {
+            for (idx i = 0; i < k; ++i) {
+                apply_gate_(F, {target[i]});
+                for (idx j = i + 1; j < k; ++j)
+                    if (phase(i, j, R))
+                        apply_gate_(R, {target[i], target[j]});
+            }
+            reverse();
+        } else {
+            reverse();
+            for (idx i = k; i-- > 0;) {
+                for (idx j = k; j-- > i + 1;)
+                    if (phase(i, j, R))
+                        apply_gate_(R, {target[i], target[j]});
+                apply_gate_(F, {target[i]});
+            }
+        }
+    }
+
+    /**
+     * \brief Measures the non-measured qudit \a i in the computational basis
+     *
+     * \param i Qudit index
+     * \param destructive Removes the site of the qudit from the chain
+     * \return Pair of the measurement result and its probability
+     */
+    std::pair<idx, double> measure_Z_(idx i, bool destructive) {
+        idx d = qc_->get_d();
+        idx p = get_site_(i);
+        move_center_(p);
+        rmat& A = st_.sites_[p];
+        idx chi_l = static_cast<idx>(A.rows()) / d;
+        idx chi_r = static_cast<idx>(A.cols());
+
+        std::vector<double> probs(d, 0);
+        for (idx a = 0; a < chi_l; ++a)
+            for (idx s = 0; s < d; ++s)
+                probs[s] += A.row(a * d + s).squaredNorm();
+        std::discrete_distribution<idx> dd(std::begin(probs), std::end(probs));
+        idx m = dd(get_prng_());
+        double scale = 1 / std::sqrt(probs[m]);
+
+        if (destructive) {
+            ket psi(chi_l * chi_r);
+            for (idx a = 0; a < chi_l; ++a)
+                psi.segment(a * chi_r, chi_r) =
+                    scale * A.row(a * d + m).transpose();
+            split_(psi, p, 1, {}, chi_l, chi_r);
+        } else {
+            for (idx a = 0; a < chi_l; ++a)
+                for (idx s = 0; s < d; ++s) {
+                    if (s == m)
+                        A.row(a * d + s) *= scale;
+                    else
+                        A.row(a * d + s).setZero();
+                }
+        }
+
+        return {m, probs[m]};
+    }
+
+    /**
+     * \brief Measures the non-measured qudits \a target in the orthonormal
+     * basis or rank-1 projectors specified by the columns of \a V
+     * \see qpp::measure()
+     *
+     * \param V Matrix whose columns represent the measurement basis vectors
+     * or the ket parts of the rank-1 projectors
+     * \param target Qudit indexes
+     * \param destructive Removes the sites of the qudits from the chain
+     * \return Pair of the measurement result and its probability
+     */
+    std::pair<idx, double> measure_V_(const cmat& V,
+                                      const std::vector<idx>& target,
+                                      bool destructive) {
+        idx d = qc_->get_d();
+        idx first = gather_(target);
+        idx count = target.size();
+        move_center_(first);
+        idx chi_l = static_cast<idx>(st_.sites_[first].rows()) / d;
+        idx chi_r = static_cast<idx>(st_.sites_[first + count - 1].cols());
+
+        rmat theta = contract_(first, count);
+        ket psi = Eigen::Map<const ket>(theta.data(), theta.size());
+        std::vector<idx> dims(count + 2, d);
+        dims.front() = chi_l;
+        dims.back() = chi_r;
+
+        idx m = 0;
+        std::vector<double> probs;
+        std::vector<cmat> states;
+        std::tie(m, probs, states) = measure(
+            psi, V, get_window_pos_(target, first), dims, destructive);
+
+        // the gathered sites hold exactly the target qudits
+        std::vector<idx> window;
+        if (!destructive)
+            window.assign(std::next(std::begin(st_.qudits_), first),
+                          std::next(std::begin(st_.qudits_), first + count));
+        split_(states[m], first, count, window, chi_l, chi_r);
+
+        return {m, probs[m]};
+    }
+
+    /**
+     * \brief Samples the outcomes of \a reps repetitions of the steps
+     * starting from \a first up to the end of the quantum circuit
+     * description directly from the engine state \a entry, and collects the
+     * measurement statistics, provided all those steps are no-ops or
+     * terminal measurements in the computational basis
+     * \see qpp::QEngine::sample_terminal_()
+     *
+     * \note Every repetition draws the computational basis states of the
+     * sites one after the other, from their conditional probabilities, which
+     * are computed from the right orthonormal sites with a cost linear in the
+     * number of qudits
+     *
+     * \param entry Engine state at the beginning of every repetition
+     * \param first Iterator to the first step of every repetition
+     * \param reps Number of repetitions
+     * \return True if the outcomes were sampled, false if the steps are not
+     * all terminal measurements, in which case nothing is done
+     */
+    bool sample_terminal_(const state_& entry, const QCircuit::iterator& first,
+                          idx reps) {
+        const auto& measurements = qc_->get_measurements_();
+        std::vector<idx> m_ips; // measurement steps, in circuit order
+        for (auto it = first; it != qc_->end(); ++it) {
+            auto elem = *it;
+            if (elem.type_ == QCircuit::StepType::NOP)
+                continue;
+            if (elem.type_ != QCircuit::StepType::MEASUREMENT)
+                return false;
+            idx m_ip = std::distance(std::begin(measurements),
+                                     elem.measurements_ip_);
+            switch (measurements[m_ip].measurement_type_) {
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    break;
+                default:
+                    return false;
+            }
+            // already measured qudits are reported by the regular execution
+            for (auto&& target : measurements[m_ip].target_)
+                if (entry.pos_[target] == static_cast<idx>(-1))
+                    return false;
+            m_ips.emplace_back(m_ip);
+        }
+        // no measurements, all repetitions are identical
+        if (m_ips.empty())
+            return true;
+
+        // right orthonormal sites
+        st_ = entry;
+        move_center_(0);
+        const auto& sites = st_.sites_;
+
+        idx d = qc_->get_d();
+        auto& gen = get_prng_();
+        std::vector<idx> outcomes(qc_->get_nq(), 0);
+        std::vector<double> probs(d);
+        for (idx rep = 0; rep < reps; ++rep) {
+            dyn_row_vect<cplx> v = dyn_row_vect<cplx>::Ones(1);
+            for (idx p = 0; p < sites.size(); ++p) {
+                const rmat& A = sites[p];
+                idx chi_r = static_cast<idx>(A.cols());
+                // the rows of the site with physical index s
+                auto block = [&](idx s) {
+                    return Eigen::Map<const rmat, 0, Eigen::OuterStride<>>(
+                        A.data() + s * chi_r, v.size(), chi_r,
+                        Eigen::OuterStride<>(d * chi_r));
+                };
+                for (idx s = 0; s < d; ++s)
+                    probs[s] = (v * block(s)).squaredNorm();
+                std::discrete_distribution<idx> dd(std::begin(probs),
+                                                   std::end(probs));
+                idx s = dd(gen);
+                outcomes[st_.qudits_[p]] = s;
+                v = (v * block(s)) / std::sqrt(probs[s]);
+            }
+
+            std::vector<idx> dits = entry.dits_;
+            for (auto&& m_ip : m_ips) {
+                const auto& m = measurements[m_ip];
+                std::vector<idx> res;
+                for (auto&& target : m.target_)
+                    res.emplace_back(outcomes[target]);
+                switch (m.measurement_type_) {
+                    case QCircuit::MeasureType::MEASURE_Z:
+                    case QCircuit::MeasureType::MEASURE_Z_ND:
+                        dits[m.c_reg_] = res[0];
+                        break;
+                    case QCircuit::MeasureType::MEASURE_Z_MANY:
+                    case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                        dits[m.c_reg_] = multiidx2n(
+                            res, std::vector<idx>(res.size(), d));
+                        break;
+                    default:
+                        break;
+                }
+            }
+            update_stats_(dits);
+        }
+        st_ = entry;
+
+        return true;
+    }
+
+    /**
+     * \brief Records the classical dits \a dits in the measurement
+     * statistics, provided the circuit has at least one measurement
+     *
+     * \param dits Classical dits
+     */
+    void update_stats_(const std::vector<idx>& dits) {
+        if (qc_->get_measurement_count() == 0)
+            return;
+        std::stringstream ss;
+        ss << disp(dits, " ", "", "");
+        ++stats_[ss.str()];
+    }
+
+  public:
+    /**
+     * \brief Constructs a matrix product state quantum engine out of a
+     * quantum circuit description
+     *
+     * \note The quantum circuit description must be an lvalue
+     * \see qpp::QMPSEngine(QCircuit&&)
+     *
+     * \note The initial underlying quantum state is set to
+     * \f$|0\rangle^{\otimes n}\f$, with all bond dimensions equal to 1
+     *
+     * \param qc Quantum circuit description
+     * \param max_bond_dim Maximum bond dimension, must be positive
+     * \param max_trunc_err Maximum relative truncation error of every
+     * singular value decomposition, i.e. the sum of the squares of the
+     * discarded singular values divided by the sum of the squares of all the
+     * singular values, must be non-negative
+     */
+    explicit QMPSEngine(const QCircuit& qc, idx max_bond_dim = 256,
+                        double max_trunc_err = 1e-12)
+        : qc_{std::addressof(qc)}, max_bond_dim_{max_bond_dim},
+          max_trunc_err_{max_trunc_err}, st_{}, stats_{} {
+        // EXCEPTION CHECKS
+
+        if (qc.get_nq() == 0)
+            throw exception::ZeroSize("qpp::QMPSEngine::QMPSEngine()");
+        if (max_bond_dim == 0 || max_trunc_err < 0)
+            throw exception::OutOfRange("qpp::QMPSEngine::QMPSEngine()");
+        // END EXCEPTION CHECKS
+        reset();
+    }
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy constructor
+     */
+    QMPSEngine(const QMPSEngine&) = default;
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy assignment operator
+     *
+     * \return Reference to the current instance
+     */
+    QMPSEngine& operator=(const QMPSEngine&) = default;
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QMPSEngine(QCircuit&&, idx = 0, double = 0) = delete;
+
+    /**
+     * \brief Default virtual destructor
+     */
+    ~QMPSEngine() override = default;
+
+    // getters
+    /**
+     * \brief Underlying quantum state, contracted into a state vector
+     *
+     * \note The order is lexicographical with respect to the remaining
+     * non-measured qudits, as in qpp::QEngine::get_psi(). The size of the
+     * result is exponential in the number of non-measured qudits.
+     *
+     * \return Underlying quantum state
+     */
+    ket get_psi() const {
+        idx n = st_.sites_.size();
+        if (n == 0)
+            return ket::Ones(1);
+
+        idx d = qc_->get_d();
+        rmat theta = contract_(0, n);
+        ket psi = Eigen::Map<const ket>(theta.data(), theta.size());
+
+        // from the order of the chain to the order of the qudits
+        std::vector<idx> sorted = st_.qudits_;
+        std::sort(std::begin(sorted), std::end(sorted));
+        std::vector<idx> perm(n);
+        for (idx j = 0; j < n; ++j)
+            perm[j] = static_cast<idx>(
+                std::distance(std::begin(st_.qudits_),
+                              std::find(std::begin(st_.qudits_),
+                                        std::end(st_.qudits_), sorted[j])));
+
+        return syspermute(psi, perm, std::vector<idx>(n, d));
+    }
+
+    /**
+     * \brief Vector with the values of the underlying classical dits
+     * \see qpp::QMPSEngine::set_dits()
+     *
+     * \return Vector of underlying classical dits
+     */
+    std::vector<idx> get_dits() const { return st_.dits_; }
+
+    /**
+     * \brief Value of the classical dit at position \a i
+     * \see qpp::QMPSEngine::set_dit()
+     *
+     * \param i Classical dit index
+     * \return Value of the classical dit at position \a i
+     */
+    idx get_dit(idx i) const {
+        // EXCEPTION CHECKS
+
+        if (i >= qc_->get_nc())
+            throw exception::OutOfRange("qpp::QMPSEngine::get_dit()");
+        // END EXCEPTION CHECKS
+
+        return st_.dits_[i];
+    }
+
+    /**
+     * \brief Vector of underlying measurement outcome probabilities
+     * \see qpp::QEngine::get_probs()
+     *
+     * \return Vector of underlying measurement outcome probabilities
+     */
+    std::vector<double> get_probs() const { return st_.probs_; }
+
+    /**
+     * \brief Check whether qudit \a i was already measured (destructively)
+     *
+     * \param i Qudit index
+     * \return True if qudit \a i was already measured, false otherwise
+     */
+    bool get_measured(idx i) const {
+        return st_.pos_[i] == static_cast<idx>(-1);
+    }
+
+    /**
+     * \brief Vector of already measured qudit indexes
+     *
+     * \return Vector of already measured qudit indexes
+     */
+    std::vector<idx> get_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Vector of non-measured qudit indexes
+     *
+     * \return Vector of non-measured qudit indexes
+     */
+    std::vector<idx> get_non_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (!get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Quantum circuit description, lvalue ref qualifier
+     *
+     * \return Const reference to the underlying quantum circuit description
+     */
+    const QCircuit& get_circuit() const& noexcept { return *qc_; }
+
+    /**
+     * \brief Quantum circuit description, rvalue ref qualifier
+     *
+     * \return Copy of the underlying quantum circuit description
+     */
+    QCircuit get_circuit() const&& noexcept { return *qc_; }
+
+    /**
+     * \brief Measurement statistics for multiple runs
+     * \see qpp::QEngine::get_stats()
+     *
+     * \return Hash table with collected measurement statistics for multiple
+     * runs, with hash key being the string representation of the vector of
+     * measurement results and value being the number of occurrences (of the
+     * vector of measurement results), with the most significant bit located at
+     * index 0 (i.e. top/left).
+     */
+    std::map<std::string, idx, internal::EqualSameSizeStringDits>
+    get_stats() const {
+        return stats_;
+    }
+
+    /**
+     * \brief Maximum bond dimension
+     *
+     * \return Maximum bond dimension
+     */
+    idx get_max_bond_dim() const noexcept { return max_bond_dim_; }
+
+    /**
+     * \brief Maximum relative truncation error of a single singular value
+     * decomposition
+     *
+     * \return Maximum relative truncation error
+     */
+    double get_max_trunc_err() const noexcept { return max_trunc_err_; }
+
+    /**
+     * \brief Accumulated truncation error, i.e. the sum of the relative
+     * weights of the singular values discarded since the last reset
+     *
+     * \note The fidelity of the underlying state with the exact state is
+     * at least one minus the accumulated truncation error, approximately
+     *
+     * \return Accumulated truncation error
+     */
+    double get_trunc_err() const noexcept { return st_.trunc_err_; }
+
+    /**
+     * \brief Bond dimensions of the matrix product state
+     *
+     * \return Vector of bond dimensions between consecutive sites, in the
+     * order of the chain
+     */
+    std::vector<idx> get_bond_dims() const {
+        std::vector<idx> result;
+        for (idx p = 0; p + 1 < st_.sites_.size(); ++p)
+            result.emplace_back(static_cast<idx>(st_.sites_[p].cols()));
+
+        return result;
+    }
+
+    /**
+     * \brief Order of the non-measured qudits along the chain of sites
+     *
+     * \return Vector of qudit indexes, one per site
+     */
+    std::vector<idx> get_chain() const { return st_.qudits_; }
+    // end getters
+
+    // setters
+    /**
+     * \brief Sets the classical dit at position \a i
+     * \see qpp::QMPSEngine::get_dit()
+     *
+     * \param i Classical dit index
+     * \param value Classical dit value
+     * \return Reference to the current instance
+     */
+    QMPSEngine& set_dit(idx i, idx value) {
+        // EXCEPTION CHECKS
+
+        if (i >= qc_->get_nc())
+            throw exception::OutOfRange("qpp::QMPSEngine::set_dit()");
+        // END EXCEPTION CHECKS
+        st_.dits_[i] = value;
+
+        return *this;
+    }
+
+    /**
+     * \brief Set the classical dits to \a dits
+     * \see qpp::QMPSEngine::get_dits()
+     *
+     * \param dits Vector of classical dits, must have the same size as the
+     * internal vector of classical dits returned by
+     * qpp::QMPSEngine::get_dits()
+     * \return Reference to the current instance
+     */
+    QMPSEngine& set_dits(std::vector<idx> dits) {
+        // EXCEPTION CHECKS
+
+        if (dits.size() != st_.dits_.size())
+            throw exception::SizeMismatch("qpp::QMPSEngine::set_dits()");
+        // END EXCEPTION CHECKS
+        st_.dits_ = std::move(dits);
+
+        return *this;
+    }
+    // end setters
+
+    /**
+     * \brief Resets the collected measurement statistics hash table
+     *
+     * \return Reference to the current instance
+     */
+    QMPSEngine& reset_stats() {
+        stats_ = {};
+
+        return *this;
+    }
+
+    /**
+     * \brief Resets the engine
+     *
+     * Re-initializes everything to zero and sets the initial state to
+     * \f$|0\rangle^{\otimes n}\f$
+     *
+     * \param reset_stats Optional (true by default), resets the collected
+     * measurement statistics hash table
+     *
+     * \return Reference to the current instance
+     */
+    QMPSEngine& reset(bool reset_stats = true) {
+        idx n = qc_->get_nq();
+        idx d = qc_->get_d();
+        rmat zero = rmat::Zero(d, 1);
+        zero(0, 0) = 1;
+        st_.sites_ = std::vector<rmat>(n, zero);
+        st_.qudits_ = std::vector<idx>(n, 0);
+        std::iota(std::begin(st_.qudits_), std::end(st_.qudits_), 0);
+        st_.pos_ = st_.qudits_;
+        st_.center_ = 0;
+        st_.trunc_err_ = 0;
+        st_.probs_ = std::vector<double>(qc_->get_nc(), 0);
+        st_.dits_ = std::vector<idx>(qc_->get_nc(), 0);
+        if (reset_stats)
+            this->reset_stats();
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param elem Step to be executed
+     * \return Reference to the current instance
+     */
+    QMPSEngine& execute(const QCircuit::iterator::value_type& elem) {
+        // EXCEPTION CHECKS
+
+        // iterator must point to the same quantum circuit description
+        if (elem.value_type_qc_ != qc_)
+            throw exception::InvalidIterator("qpp::QMPSEngine::execute()");
+        // the rest of exceptions are caught by the iterator::operator*()
+        // END EXCEPTION CHECKS
+
+        const auto& h_tbl = qc_->get_cmat_hash_tbl_();
+        idx d = qc_->get_d();
+
+        // gate step
+        if (elem.type_ == QCircuit::StepType::GATE) {
+            const auto& gate = *elem.gates_ip_;
+
+            switch (gate.gate_type_) {
+                case QCircuit::GateType::SINGLE:
+                case QCircuit::GateType::TWO:
+                case QCircuit::GateType::THREE:
+                case QCircuit::GateType::JOINT:
+                    apply_gate_(h_tbl.at(gate.gate_hash_), gate.target_);
+                    break;
+                case QCircuit::GateType::FAN:
+                    for (auto&& i : gate.target_)
+                        apply_gate_(h_tbl.at(gate.gate_hash_), {i});
+                    break;
+                case QCircuit::GateType::QFT:
+                    apply_QFT_(gate.target_, false);
+                    break;
+                case QCircuit::GateType::TFQ:
+                    apply_QFT_(gate.target_, true);
+                    break;
+                default:
+                    break;
+            }
+
+            // controlled gate
+            if (QCircuit::is_CTRL(gate))
+                apply_ctrl_(qc_->get_target_mat_(gate), gate.ctrl_,
+                            gate.target_, gate.shift_);
+
+            // classically-controlled gate, the single qudit gates of the
+            // multiple target ones act on every target independently
+            if (QCircuit::is_cCTRL(gate)) {
+                bool should_apply = true;
+                idx first_dit = 1;
+                if (!st_.dits_.empty()) {
+                    auto dit = [&](idx m) {
+                        idx result = st_.dits_[gate.ctrl_[m]];
+                        if (!gate.shift_.empty())
+                            result = (result + gate.shift_[m]) % d;
+                        return result;
+                    };
+                    first_dit = dit(0);
+                    for (idx m = 1; m < gate.ctrl_.size(); ++m)
+                        if (dit(m) != first_dit)
+                            should_apply = false;
+                }
+                if (should_apply) {
+                    cmat V = powm(h_tbl.at(gate.gate_hash_), first_dit);
+                    if (gate.gate_type_ == QCircuit::GateType::JOINT_cCTRL)
+                        apply_gate_(V, gate.target_);
+                    else
+                        for (auto&& i : gate.target_)
+                            apply_gate_(V, {i});
+                }
+            }
+        } // end if gate step
+
+        // measurement step
+        else if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
+            const auto& measurement = *elem.measurements_ip_;
+            const auto& target = measurement.target_;
+            idx c_reg = measurement.c_reg_;
+
+            // computational basis, the first target is the most significant
+            auto measure_Z = [&](bool destructive) {
+                idx result = 0;
+                double prob = 1;
+                for (auto&& i : target) {
+                    auto res = measure_Z_(i, destructive);
+                    result = result * d + res.first;
+                    prob *= res.second;
+                }
+                st_.dits_[c_reg] = result;
+                st_.probs_[c_reg] = prob;
+            };
+            auto measure_V = [&](bool destructive) {
+                auto res = measure_V_(h_tbl.at(measurement.mats_hash_[0]),
+                                      target, destructive);
+                st_.dits_[c_reg] = res.first;
+                st_.probs_[c_reg] = res.second;
+            };
+
+            switch (measurement.measurement_type_) {
+                case QCircuit::MeasureType::NONE:
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                    measure_Z(true);
+                    break;
+                case QCircuit::MeasureType::MEASURE_V:
+                case QCircuit::MeasureType::MEASURE_V_MANY:
+                    measure_V(true);
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                    measure_Z(false);
+                    break;
+                case QCircuit::MeasureType::MEASURE_V_ND:
+                case QCircuit::MeasureType::MEASURE_V_MANY_ND:
+                    measure_V(false);
+                    break;
+                case QCircuit::MeasureType::RESET:
+                case QCircuit::MeasureType::RESET_MANY: {
+                    cmat X = Gates::get_instance().Xd(d);
+                    for (auto&& i : target) {
+                        idx m = measure_Z_(i, false).first;
+                        if (m != 0)
+                            apply_gate_(powm(X, d - m), {i});
+                    }
+                    break;
+                }
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    for (auto&& i : target)
+                        measure_Z_(i, true);
+                    break;
+            } // end switch on measurement type
+        }     // end else if measurement step
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param it Iterator to the step to be executed
+     * \return Reference to the current instance
+     */
+    QMPSEngine& execute(const QCircuit::iterator& it) { return execute(*it); }
+
+    /**
+     * \brief Executes the entire quantum circuit description
+     * \see qpp::QEngine::execute(idx, bool)
+     *
+     * \note The steps before the first measurement are executed only once.
+     * When the remaining steps are all terminal measurements in the
+     * computational basis, their outcomes are sampled from the resulting
+     * matrix product state, see qpp::QMPSEngine::sample_terminal_().
+     * Otherwise they are repeated \a reps times.
+     *
+     * \param reps Number of repetitions
+     * \param clear_stats Resets the collected measurement statistics hash
+     * table before the run
+     * \return Reference to the current instance
+     */
+    QMPSEngine& execute(idx reps = 1, bool clear_stats = true) {
+        if (clear_stats)
+            reset_stats();
+
+        // find the position of the first measurement step
+        auto first_measurement_it = qc_->begin();
+        while (first_measurement_it != qc_->end()) {
+            if ((*first_measurement_it).type_ ==
+                QCircuit::StepType::MEASUREMENT)
+                break;
+            ++first_measurement_it;
+        }
+
+        for (auto it = qc_->begin(); it != first_measurement_it; ++it)
+            execute(it);
+        state_ entry = st_;
+
+        // when all measurements are terminal, samples all but the last
+        // repetition, which leaves the engine in a measured state as usual
+        if (reps > 1 &&
+            sample_terminal_(entry, first_measurement_it, reps - 1))
+            reps = 1;
+        for (idx i = 0; i < reps; ++i) {
+            st_ = entry;
+            for (auto it = first_measurement_it; it != qc_->end(); ++it)
+                execute(it);
+            update_stats_(st_.dits_);
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief qpp::IJSON::to_JSON() override
+     *
+     * Displays the state of the engine in JSON format
+     *
+     * \param enclosed_in_curly_brackets If true, encloses the result in
+     * curly brackets
+     * \return String containing the JSON representation of the state of the
+     * engine
+     */
+    std::string to_JSON(bool enclosed_in_curly_brackets = true) const override {
+        std::string result;
+
+        if (enclosed_in_curly_brackets)
+            result += "{";
+
+        std::ostringstream ss;
+        ss << disp(get_measured(), ", ");
+        result += "\"measured/discarded (destructive)\" : " + ss.str() + ", ";
+
+        ss.str("");
+        ss.clear();
+        ss << disp(get_non_measured(), ", ");
+        result += "\"non-measured/non-discarded\" : " + ss.str();
+
+        ss.str("");
+        ss.clear();
+        ss << disp(get_bond_dims(), ", ");
+        result += ", \"bond dims\": " + ss.str();
+
+        ss.str("");
+        ss.clear();
+        ss << get_trunc_err();
+        result += ", \"trunc err\": " + ss.str();
+
+        ss.str("");
+        ss.clear();
+        result += ", \"last probs\": ";
+        ss << disp(get_probs(), ", ");
+        result += ss.str();
+
+        ss.str("");
+        ss.clear();
+        result += ", \"last dits\": ";
+        ss << disp(get_dits(), ", ");
+        result += ss.str();
+
+        ss.str("");
+        ss.clear();
+
+        // compute the statistics
+        if (!stats_.empty()) {
+            result += ", \"stats\": {";
+            idx reps = 0;
+            for (auto&& elem : stats_)
+                reps += elem.second;
+            result += "\"reps\": " + std::to_string(reps) + ", ";
+            result += "\"outcomes\": " + std::to_string(stats_.size()) + ", ";
+
+            std::string sep;
+            for (auto&& elem : stats_) {
+                ss << sep << "\""
+                   << "[" << elem.first << "]"
+                   << "\" : " << elem.second;
+                sep = ", ";
+            }
+            ss << '}';
+            result += ss.str();
+        }
+
+        if (enclosed_in_curly_brackets)
+            result += "}";
+
+        return result;
+    }
+
+  private:
+    /**
+     * \brief qpp::IDisplay::display() override
+     *
+     * Writes to the output stream a textual representation of the state of
+     * the engine
+     *
+     * \param os Output stream passed by reference
+     * \return Reference to the output stream
+     */
+    std::ostream& display(std::ostream& os) const override {
+        os << "bond dims: " << disp(get_bond_dims(), ", ") << '\n';
+        os << "trunc err: " << get_trunc_err() << '\n';
+        os << "last probs: " << disp(get_probs(), ", ") << '\n';
+        os << "last dits: " << disp(get_dits(), ", ");
+
+        // compute the statistics
+        if (!stats_.empty()) {
+            idx reps = 0;
+            for (auto&& elem : stats_)
+                reps += elem.second;
+            os << "\nstats:\n";
+            os << '\t' << "reps: " << reps << '\n';
+            os << '\t' << "outcomes: " << stats_.size() << '\n';
+            std::string sep;
+            for (auto&& elem : stats_) {
+                os << sep << '\t' << "[" << elem.first << "]"
+                   << ": " << elem.second;
+                sep = '\n';
+            }
+        }
+
+        return os;
+    }
+}; /* class QMPSEngine */
+
+/**
+ * \class qpp::QStabilizerEngine
+ * \brief Stabilizer quantum circuit engine, executes Clifford qpp::QCircuit
+ * \see qpp::QEngine, qpp::QCircuit
+ *
+ * Stores the state of the \f$n\f$ qubits as a stabilizer tableau, see
+ * S. Aaronson and D. Gottesman, Phys. Rev. A 70, 052328 (2004), i.e. as
+ * \f$n\f$ destabilizer and \f$n\f$ stabilizer generators, each one a Pauli
+ * string with its X and Z parts packed into 64-bit words, together with a
+ * sign bit. A gate costs \f$O(n)\f$ bit operations and a measurement
+ * \f$O(n^2/64)\f$ word operations, so circuits on thousands of qubits can be
+ * executed with the same interface as qpp::QEngine.
+ *
+ * The gates are recognized by the hashes of their matrices in the quantum
+ * circuit description, and must be qpp::Gates::Id2, qpp::Gates::H,
+ * qpp::Gates::S and its adjoint, qpp::Gates::X, qpp::Gates::Y,
+ * qpp::Gates::Z, qpp::Gates::CNOT, qpp::Gates::CZ or qpp::Gates::SWAP. The
+ * Pauli gates may be controlled by a single (possibly shifted) qubit, and all
+ * of them may be classically-controlled. The quantum Fourier transform of a
+ * single qubit is its Hadamard gate. The measurements must be in the
+ * computational basis, resets or discards.
+ *
+ * \note The quantum circuit description must have qubits (\f$d = 2\f$), and
+ * all its steps must be Clifford operations as above, otherwise the
+ * constructor throws qpp::exception::NotClifford
+ */
+class QStabilizerEngine : public IDisplay, public IJSON {
+  protected:
+    /**
+     * \brief Clifford gates recognized by the engine
+     */
+    enum class CliffordType {
+        I,    ///< identity
+        H,    ///< Hadamard gate
+        S,    ///< S gate
+        SDG,  ///< adjoint of the S gate
+        X,    ///< Pauli X gate
+        Y,    ///< Pauli Y gate
+        Z,    ///< Pauli Z gate
+        CNOT, ///< controlled-NOT gate, the first qubit is the control
+        CZ,   ///< controlled-Z gate
+        SWAP, ///< SWAP gate
+    };
+
+    /**
+     * \class qpp::QStabilizerEngine::op_
+     * \brief Clifford gate acting on the qubit \a a_, or on the qubits \a a_
+     * and \a b_ for two qubit gates
+     */
+    struct op_ {
+        CliffordType type_; ///< gate type
+        idx a_;             ///< first qubit
+        idx b_;             ///< second qubit, equal to a_ for 1 qubit gates
+    };
+
+    const QCircuit* qc_; ///< pointer to constant quantum circuit description
+
+    /**
+     * \class qpp::QStabilizerEngine::state_
+     * \brief Current state of the engine
+     *
+     * \note The tableau has \f$2n + 1\f$ rows, the destabilizers
+     * \f$0, \ldots, n - 1\f$, the stabilizers \f$n, \ldots, 2n - 1\f$ and a
+     * scratch row \f$2n\f$
+     */
+    struct state_ {
+        idx n_{0};                       ///< number of qubits
+        idx w_{0};                       ///< number of 64-bit words per row
+        std::vector<std::uint64_t> x_{}; ///< X bits of the rows
+        std::vector<std::uint64_t> z_{}; ///< Z bits of the rows
+        std::vector<unsigned char> r_{}; ///< sign bits of the rows
+        idx sw_{0}; ///< number of 64-bit words per row of symbolic signs
+        std::vector<std::uint64_t> s_{}; ///< symbolic signs of the rows, i.e.
+        ///< the random measurement outcomes the signs depend on (if sw_ > 0)
+        std::vector<bool> measured_{};   ///< measured (destructively) qubits
+        std::vector<double> probs_{};    ///< measurement probabilities
+        std::vector<idx> dits_{};        ///< classical dits
+    } st_;                               ///< current state of the engine
+    std::map<std::string, idx, internal::EqualSameSizeStringDits>
+        stats_; ///< measurement statistics for multiple runs
+
+    /**
+     * \brief Pseudo-random number generator of the calling thread
+     *
+     * \return Reference to the pseudo-random number generator
+     */
+    static std::mt19937& get_prng_() {
+        return
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+    }
+
+    /**
+     * \brief Hash table of the Clifford gates recognized by the engine
+     *
+     * \return Hash table with [Key = hash of the gate matrix, Value = pair of
+     * the gate type and matrix]
+     */
+    static const std::unordered_map<std::size_t,
+                                    std::pair<CliffordType, cmat>>&
+    get_clifford_tbl_() {
+        static const std::unordered_map<std::size_t,
+                                        std::pair<CliffordType, cmat>>
+            tbl = [] {
+                const auto& gt = Gates::get_instance();
+                std::vector<std::pair<CliffordType, cmat>> gates{
+                    {CliffordType::I, gt.Id2},
+                    {CliffordType::H, gt.H},
+                    {CliffordType::S, gt.S},
+                    {CliffordType::SDG, adjoint(gt.S)},
+                    {CliffordType::X, gt.X},
+                    {CliffordType::Y, gt.Y},
+                    {CliffordType::Z, gt.Z},
+                    {CliffordType::CNOT, gt.CNOT},
+                    {CliffordType::CZ, gt.CZ},
+                    {CliffordType::SWAP, gt.SWAP}};
+                std::unordered_map<std::size_t, std::pair<CliffordType, cmat>>
+                    result;
+                for (auto&& elem : gates)
+                    result.insert({hash_eigen(elem.second), elem});
+                return result;
+            }();
+
+        return tbl;
+    }
+
+    /**
+     * \brief Clifford gate type of the matrix with hash \a hashU in the
+     * quantum circuit description
+     *
+     * \param hashU Hash of the gate matrix
+     * \return Clifford gate type
+     */
+    CliffordType get_clifford_(std::size_t hashU) const {
+        const auto& tbl = get_clifford_tbl_();
+        auto it = tbl.find(hashU);
+        static internal::EqualEigen equal_eigen;
+
+        // EXCEPTION CHECKS
+
+        if (it == tbl.end() || !equal_eigen(it->second.second,
+                                            qc_->get_cmat_hash_tbl_().at(hashU)))
+            throw exception::NotClifford(
+                "qpp::QStabilizerEngine::get_clifford_()");
+        // END EXCEPTION CHECKS
+
+        return it->second.first;
+    }
+
+    /**
+     * \brief Clifford gates applied by a gate step
+     *
+     * \note For classically-controlled gate steps, returns the gates applied
+     * when the classical control dits are all equal to one
+     *
+     * \param gate Gate step
+     * \return Vector of Clifford gates, in the order of their application
+     */
+    std::vector<op_> get_ops_(const QCircuit::GateStep& gate) const {
+        std::vector<op_> result;
+        const auto& target = gate.target_;
+
+        // a 1 qubit gate on every target, or a 2 qubit gate on both targets
+        auto add = [&](CliffordType type) {
+            if (type == CliffordType::CNOT || type == CliffordType::CZ ||
+                type == CliffordType::SWAP) {
+                if (target.size() != 2)
+                    throw exception::NotClifford(
+                        "qpp::QStabilizerEngine::get_ops_()");
+                result.push_back({type, target[0], target[1]});
+            } else
+                for (auto&& i : target)
+                    result.push_back({type, i, i});
+        };
+
+        switch (gate.gate_type_) {
+            case QCircuit::GateType::NONE:
+                break;
+            case QCircuit::GateType::SINGLE:
+            case QCircuit::GateType::TWO:
+            case QCircuit::GateType::THREE:
+            case QCircuit::GateType::JOINT:
+            case QCircuit::GateType::FAN:
+            case QCircuit::GateType::SINGLE_cCTRL_SINGLE_TARGET:
+            case QCircuit::GateType::SINGLE_cCTRL_MULTIPLE_TARGET:
+            case QCircuit::GateType::MULTIPLE_cCTRL_SINGLE_TARGET:
+            case QCircuit::GateType::MULTIPLE_cCTRL_MULTIPLE_TARGET:
+            case QCircuit::GateType::JOINT_cCTRL:
+                add(get_clifford_(gate.gate_hash_));
+                break;
+            case QCircuit::GateType::QFT:
+            case QCircuit::GateType::TFQ:
+                if (target.size() != 1)
+                    throw exception::NotClifford(
+                        "qpp::QStabilizerEngine::get_ops_()");
+                add(CliffordType::H);
+                break;
+            case QCircuit::GateType::SINGLE_CTRL_SINGLE_TARGET:
+            case QCircuit::GateType::SINGLE_CTRL_MULTIPLE_TARGET: {
+                CliffordType type = get_clifford_(gate.gate_hash_);
+                idx c = gate.ctrl_[0];
+                // the shifted control is conjugated by X
+                bool flip = !gate.shift_.empty() && gate.shift_[0] % 2 != 0;
+                if (flip)
+                    result.push_back({CliffordType::X, c, c});
+                for (auto&& i : target) {
+                    switch (type) {
+                        case CliffordType::I:
+                            break;
+                        case CliffordType::X:
+                            result.push_back({CliffordType::CNOT, c, i});
+                            break;
+                        case CliffordType::Y:
+                            result.push_back({CliffordType::SDG, i, i});
+                            result.push_back({CliffordType::CNOT, c, i});
+                            result.push_back({CliffordType::S, i, i});
+                            break;
+                        case CliffordType::Z:
+                            result.push_back({CliffordType::CZ, c, i});
+                            break;
+                        default:
+                            throw exception::NotClifford(
+                                "qpp::QStabilizerEngine::get_ops_()");
+                    }
+                }
+                if (flip)
+                    result.push_back({CliffordType::X, c, c});
+                break;
+            }
+            default:
+                throw exception::NotClifford(
+                    "qpp::QStabilizerEngine::get_ops_()");
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Applies the Clifford gate \a op to the tableau of \a st, by
+     * updating the columns of its qubits in all the rows
+     *
+     * \param st Engine state
+     * \param op Clifford gate
+     */
+    static void apply_(state_& st, const op_& op) {
+        idx rows = 2 * st.n_;
+        idx w = st.w_;
+        idx ia = op.a_ / 64, ib = op.b_ / 64;
+        unsigned sa = op.a_ % 64, sb = op.b_ % 64;
+        std::uint64_t* x = st.x_.data();
+        std::uint64_t* z = st.z_.data();
+        unsigned char* r = st.r_.data();
+
+        switch (op.type_) {
+            case CliffordType::I:
+                break;
+            case CliffordType::H:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    r[h] ^= xa & za;
+                    x[h * w + ia] ^= (xa ^ za) << sa;
+                    z[h * w + ia] ^= (xa ^ za) << sa;
+                }
+                break;
+            case CliffordType::S:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    r[h] ^= xa & za;
+                    z[h * w + ia] ^= xa << sa;
+                }
+                break;
+            case CliffordType::SDG:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    r[h] ^= xa & (za ^ 1);
+                    z[h * w + ia] ^= xa << sa;
+                }
+                break;
+            case CliffordType::X:
+                for (idx h = 0; h < rows; ++h)
+                    r[h] ^= (z[h * w + ia] >> sa) & 1;
+                break;
+            case CliffordType::Y:
+                for (idx h = 0; h < rows; ++h)
+                    r[h] ^= ((x[h * w + ia] ^ z[h * w + ia]) >> sa) & 1;
+                break;
+            case CliffordType::Z:
+                for (idx h = 0; h < rows; ++h)
+                    r[h] ^= (x[h * w + ia] >> sa) & 1;
+                break;
+            case CliffordType::CNOT:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    std::uint64_t xb = (x[h * w + ib] >> sb) & 1;
+                    std::uint64_t zb = (z[h * w + ib] >> sb) & 1;
+                    r[h] ^= xa & zb & (xb ^ za ^ 1);
+                    x[h * w + ib] ^= xa << sb;
+                    z[h * w + ia] ^= zb << sa;
+                }
+                break;
+            case CliffordType::CZ:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    std::uint64_t xb = (x[h * w + ib] >> sb) & 1;
+                    std::uint64_t zb = (z[h * w + ib] >> sb) & 1;
+                    r[h] ^= xa & xb & (za ^ zb);
+                    z[h * w + ia] ^= xb << sa;
+                    z[h * w + ib] ^= xa << sb;
+                }
+                break;
+            case CliffordType::SWAP:
+                for (idx h = 0; h < rows; ++h) {
+                    std::uint64_t xa = (x[h * w + ia] >> sa) & 1;
+                    std::uint64_t za = (z[h * w + ia] >> sa) & 1;
+                    std::uint64_t xb = (x[h * w + ib] >> sb) & 1;
+                    std::uint64_t zb = (z[h * w + ib] >> sb) & 1;
+                    x[h * w + ia] ^= (xa ^ xb) << sa;
+                    x[h * w + ib] ^= (xa ^ xb) << sb;
+                    z[h * w + ia] ^= (za ^ zb) << sa;
+                    z[h * w + ib] ^= (za ^ zb) << sb;
+                }
+                break;
+        }
+    }
+
+    /**
+     * \brief Left-multiplies the row \a h of the tableau of \a st by its row
+     * \a i, and updates the sign of the row \a h accordingly
+     *
+     * \note The phase of the product is computed word by word, by counting
+     * the qubits where the product of the single qubit Pauli operators
+     * contributes a factor of \f$i\f$ and \f$-i\f$, respectively
+     *
+     * \param st Engine state
+     * \param h Row index
+     * \param i Row index
+     */
+    static void rowsum_(state_& st, idx h, idx i) {
+        idx w = st.w_;
+        std::uint64_t* xh = st.x_.data() + h * w;
+        std::uint64_t* zh = st.z_.data() + h * w;
+        const std::uint64_t* xi = st.x_.data() + i * w;
+        const std::uint64_t* zi = st.z_.data() + i * w;
+
+        // exponent of i in the phase of the product, modulo 4
+        long long phase = 2 * (st.r_[h] + st.r_[i]);
+        for (idx k = 0; k < w; ++k) {
+            std::uint64_t x1 = xi[k], z1 = zi[k], x2 = xh[k], z2 = zh[k];
+            std::uint64_t plus = (x1 & z1 & ~x2 & z2) | (x1 & ~z1 & x2 & z2) |
+                                 (~x1 & z1 & x2 & ~z2);
+            std::uint64_t minus = (x1 & z1 & x2 & ~z2) |
+                                  (x1 & ~z1 & ~x2 & z2) | (~x1 & z1 & x2 & z2);
+            phase += static_cast<long long>(internal::popcount64(plus)) -
+                     static_cast<long long>(internal::popcount64(minus));
+            xh[k] ^= x1;
+            zh[k] ^= z1;
+        }
+        st.r_[h] = ((phase % 4 + 4) % 4) >= 2;
+
+        for (idx k = 0; k < st.sw_; ++k)
+            st.s_[h * st.sw_ + k] ^= st.s_[i * st.sw_ + k];
+    }
+
+    /**
+     * \brief Measures the qubit \a q of \a st in the computational basis
+     *
+     * \param st Engine state
+     * \param q Qubit index
+     * \param gen Pseudo-random number generator drawing the outcome when it
+     * is random, if null the random outcomes are 0
+     * \return Row of the tableau whose sign bit is the measurement outcome,
+     * \f$2n\f$ if the outcome is deterministic, otherwise the stabilizer
+     * \f$\pm Z_q\f$ that replaced the first stabilizer anticommuting with it
+     */
+    static idx measure_(state_& st, idx q, std::mt19937* gen) {
+        idx n = st.n_;
+        idx w = st.w_;
+        idx iq = q / 64;
+        std::uint64_t mq = static_cast<std::uint64_t>(1) << (q % 64);
+        auto xbit = [&](idx row) { return (st.x_[row * w + iq] & mq) != 0; };
+        auto copy_row = [&](idx dest, idx src) {
+            std::copy_n(st.x_.begin() + src * w, w, st.x_.begin() + dest * w);
+            std::copy_n(st.z_.begin() + src * w, w, st.z_.begin() + dest * w);
+            std::copy_n(st.s_.begin() + src * st.sw_, st.sw_,
+                        st.s_.begin() + dest * st.sw_);
+            st.r_[dest] = st.r_[src];
+        };
+        auto clear_row = [&](idx dest) {
+            std::fill_n(st.x_.begin() + dest * w, w, 0);
+            std::fill_n(st.z_.begin() + dest * w, w, 0);
+            std::fill_n(st.s_.begin() + dest * st.sw_, st.sw_, 0);
+            st.r_[dest] = 0;
+        };
+
+        // random outcome, a stabilizer anticommutes with Z_q
+        idx p = n;
+        while (p < 2 * n && !xbit(p))
+            ++p;
+        if (p < 2 * n) {
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+            for (idx i = 0; i < 2 * n; ++i)
+                if (i != p && xbit(i))
+                    rowsum_(st, i, p);
+            copy_row(p - n, p);
+            clear_row(p);
+            st.z_[p * w + iq] = mq;
+            if (gen)
+                st.r_[p] = std::bernoulli_distribution{}(*gen);
+
+            return p;
+        }
+
+        // deterministic outcome, Z_q is the product of the stabilizers
+        // paired with the destabilizers that anticommute with it
+        clear_row(2 * n);
+        for (idx i = 0; i < n; ++i)
+            if (xbit(i))
+                rowsum_(st, 2 * n, i + n);
+
+        return 2 * n;
+    }
+
+    /**
+     * \brief Measures the qubit \a q in the computational basis
+     *
+     * \param q Qubit index
+     * \return Pair of the measurement result and its probability
+     */
+    std::pair<idx, double> measure_Z_(idx q) {
+        idx row = measure_(st_, q, &get_prng_());
+        return {st_.r_[row], row == 2 * st_.n_ ? 1 : 0.5};
+    }
+
+    /**
+     * \brief Samples the outcomes of \a reps repetitions of the steps
+     * starting from \a first up to the end of the quantum circuit
+     * description directly from the engine state \a entry, and collects the
+     * measurement statistics, provided all those steps are no-ops or
+     * terminal measurements in the computational basis
+     * \see qpp::QEngine::sample_terminal_()
+     *
+     * \note The measurements are executed once on a tableau with symbolic
+     * signs, in which every random outcome is a new independent bit. The
+     * outcomes are then affine functions of these bits, which are drawn for
+     * 64 repetitions at a time, one per bit of a 64-bit word
+     *
+     * \param entry Engine state at the beginning of every repetition
+     * \param first Iterator to the first step of every repetition
+     * \param reps Number of repetitions
+     * \return True if the outcomes were sampled, false if the steps are not
+     * all terminal measurements, in which case nothing is done
+     */
+    bool sample_terminal_(const state_& entry, const QCircuit::iterator& first,
+                          idx reps) {
+        const auto& measurements = qc_->get_measurements_();
+        std::vector<idx> m_ips; // measurement steps, in circuit order
+        idx count = 0;          // number of measured qubits
+        for (auto it = first; it != qc_->end(); ++it) {
+            auto elem = *it;
+            if (elem.type_ == QCircuit::StepType::NOP)
+                continue;
+            if (elem.type_ != QCircuit::StepType::MEASUREMENT)
+                return false;
+            idx m_ip = std::distance(std::begin(measurements),
+                                     elem.measurements_ip_);
+            switch (measurements[m_ip].measurement_type_) {
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    break;
+                default:
+                    return false;
+            }
+            // already measured qubits are reported by the regular execution
+            for (auto&& target : measurements[m_ip].target_)
+                if (entry.measured_[target])
+                    return false;
+            m_ips.emplace_back(m_ip);
+            count += measurements[m_ip].target_.size();
+        }
+        // no measurements, all repetitions are identical
+        if (m_ips.empty())
+            return true;
+
+        // symbolic measurements, the outcome of every measured qubit is its
+        // constant bit plus the sum of the random bits in its list
+        st_ = entry;
+        idx n = st_.n_;
+        st_.sw_ = (count + 63) / 64;
+        st_.s_.assign((2 * n + 1) * st_.sw_, 0);
+        idx num_random = 0;
+        std::vector<std::uint64_t> constants;
+        std::vector<std::vector<idx>> terms;
+        for (auto&& m_ip : m_ips)
+            for (auto&& target : measurements[m_ip].target_) {
+                idx row = measure_(st_, target, nullptr);
+                if (row != 2 * n) {
+                    st_.s_[row * st_.sw_ + num_random / 64] |=
+                        static_cast<std::uint64_t>(1) << (num_random % 64);
+                    ++num_random;
+                }
+                constants.emplace_back(st_.r_[row] ? ~std::uint64_t{0} : 0);
+                terms.emplace_back();
+                for (idx j = 0; j < num_random; ++j)
+                    if ((st_.s_[row * st_.sw_ + j / 64] >> (j % 64)) & 1)
+                        terms.back().emplace_back(j);
+            }
+        st_ = entry;
+
+        // distinct classical dits and their counts, formatted at the end
+        std::map<std::vector<idx>, idx> counts;
+        auto& gen = get_prng_();
+        std::uniform_int_distribution<std::uint64_t> words;
+        std::vector<std::uint64_t> random(num_random);
+        std::vector<std::uint64_t> outcomes(count);
+        for (idx block = 0; block < reps; block += 64) {
+            for (auto& word : random)
+                word = words(gen);
+            for (idx k = 0; k < count; ++k) {
+                outcomes[k] = constants[k];
+                for (auto&& j : terms[k])
+                    outcomes[k] ^= random[j];
+            }
+
+            idx block_reps = std::min(static_cast<idx>(64), reps - block);
+            for (idx b = 0; b < block_reps; ++b) {
+                std::vector<idx> dits = entry.dits_;
+                idx k = 0;
+                for (auto&& m_ip : m_ips) {
+                    const auto& m = measurements[m_ip];
+                    idx result = 0;
+                    for (idx t = 0; t < m.target_.size(); ++t, ++k)
+                        result = 2 * result + ((outcomes[k] >> b) & 1);
+                    switch (m.measurement_type_) {
+                        case QCircuit::MeasureType::MEASURE_Z:
+                        case QCircuit::MeasureType::MEASURE_Z_MANY:
+                        case QCircuit::MeasureType::MEASURE_Z_ND:
+                        case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                            dits[m.c_reg_] = result;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                ++counts[dits];
+            }
+        }
+        for (auto&& elem : counts)
+            update_stats_(elem.first, elem.second);
+
+        return true;
+    }
+
+    /**
+     * \brief Records the classical dits \a dits in the measurement
+     * statistics, provided the circuit has at least one measurement
+     *
+     * \param dits Classical dits
+     * \param reps Number of occurrences
+     */
+    void update_stats_(const std::vector<idx>& dits, idx reps = 1) {
+        if (qc_->get_measurement_count() == 0)
+            return;
+        std::stringstream ss;
+        ss << disp(dits, " ", "", "");
+        stats_[ss.str()] += reps;
+    }
+
+  public:
+    /**
+     * \brief Constructs a stabilizer quantum engine out of a quantum circuit
+     * description
+     *
+     * \note The quantum circuit description must be an lvalue
+     * \see qpp::QStabilizerEngine(QCircuit&&)
+     *
+     * \note The initial underlying quantum state is set to
+     * \f$|0\rangle^{\otimes n}\f$
+     *
+     * \param qc Quantum circuit description, must be a Clifford circuit on
+     * qubits
+     */
+    explicit QStabilizerEngine(const QCircuit& qc)
+        : qc_{std::addressof(qc)}, st_{}, stats_{} {
+        // EXCEPTION CHECKS
+
+        if (qc.get_d() != 2)
+            throw exception::NotQubitSubsys(
+                "qpp::QStabilizerEngine::QStabilizerEngine()");
+        // every gate step must be Clifford, get_ops_() throws otherwise
+        for (auto&& gate : qc.get_gates_())
+            get_ops_(gate);
+        for (auto&& measurement : qc.get_measurements_()) {
+            switch (measurement.measurement_type_) {
+                case QCircuit::MeasureType::MEASURE_V:
+                case QCircuit::MeasureType::MEASURE_V_MANY:
+                case QCircuit::MeasureType::MEASURE_V_ND:
+                case QCircuit::MeasureType::MEASURE_V_MANY_ND:
+                    throw exception::NotClifford(
+                        "qpp::QStabilizerEngine::QStabilizerEngine()");
+                default:
+                    break;
+            }
+        }
+        // END EXCEPTION CHECKS
+        reset();
+    }
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy constructor
+     */
+    QStabilizerEngine(const QStabilizerEngine&) = default;
+
+    // silence -Weffc++ class has pointer data members
+    /**
+     * \brief Default copy assignment operator
+     *
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& operator=(const QStabilizerEngine&) = default;
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QStabilizerEngine(QCircuit&&) = delete;
+
+    /**
+     * \brief Default virtual destructor
+     */
+    ~QStabilizerEngine() override = default;
+
+    // getters
+    /**
+     * \brief Underlying quantum state, expanded into a state vector
+     *
+     * \note The order is lexicographical with respect to the remaining
+     * non-measured qubits, as in qpp::QEngine::get_psi(). The size of the
+     * result is exponential in the number of qubits.
+     *
+     * \note The stabilizer tableau determines the state up to a global
+     * phase, which is chosen so that one of its non-zero amplitudes is real
+     * and positive
+     *
+     * \return Underlying quantum state
+     */
+    ket get_psi() const {
+        idx n = st_.n_;
+
+        // a computational basis state in the support of the state
+        state_ st = st_;
+        idx b = 0;
+        for (idx q = 0; q < n; ++q)
+            b = 2 * b + st.r_[measure_(st, q, nullptr)];
+
+        // projects it onto the state, i.e. applies (I + g) / 2 for every
+        // stabilizer generator g
+        idx D = static_cast<idx>(1) << n;
+        ket psi = ket::Zero(D);
+        psi(b) = 1;
+        for (idx i = n; i < 2 * n; ++i) {
+            idx xm = 0, zm = 0;
+            for (idx q = 0; q < n; ++q) {
+                idx bit = static_cast<idx>(1) << (n - q - 1);
+                if ((st_.x_[i * st_.w_ + q / 64] >> (q % 64)) & 1)
+                    xm |= bit;
+                if ((st_.z_[i * st_.w_ + q / 64] >> (q % 64)) & 1)
+                    zm |= bit;
+            }
+            // the Y's contribute a factor of i each
+            const cplx i_pows[] = {1, cplx{0, 1}, -1, cplx{0, -1}};
+            cplx phase = i_pows[internal::popcount64(xm & zm) % 4];
+            if (st_.r_[i])
+                phase = -phase;
+            ket g_psi(D);
+            for (idx k = 0; k < D; ++k)
+                g_psi(k ^ xm) = (internal::popcount64(k & zm) % 2 ? -phase
+                                                                  : phase) *
+                                psi(k);
+            psi = (psi + g_psi) / 2;
+        }
+        psi.normalize();
+
+        // the measured qubits are in the computational basis state of b
+        std::vector<idx> non_measured = get_non_measured();
+        idx Dnm = static_cast<idx>(1) << non_measured.size();
+        ket result(Dnm);
+        for (idx j = 0; j < Dnm; ++j) {
+            idx k = b;
+            for (idx m = 0; m < non_measured.size(); ++m) {
+                idx bit = static_cast<idx>(1) << (n - non_measured[m] - 1);
+                if ((j >> (non_measured.size() - m - 1)) & 1)
+                    k |= bit;
+                else
+                    k &= ~bit;
+            }
+            result(j) = psi(k);
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Stabilizer generators of the underlying quantum state
+     *
+     * \return Vector of \f$n\f$ strings, each one a sign followed by the
+     * Pauli operators acting on every qubit, e.g. "+XZIY"
+     */
+    std::vector<std::string> get_stabilizers() const {
+        idx n = st_.n_;
+        std::vector<std::string> result;
+        for (idx i = n; i < 2 * n; ++i) {
+            std::string g = st_.r_[i] ? "-" : "+";
+            for (idx q = 0; q < n; ++q) {
+                bool xq = (st_.x_[i * st_.w_ + q / 64] >> (q % 64)) & 1;
+                bool zq = (st_.z_[i * st_.w_ + q / 64] >> (q % 64)) & 1;
+                g += xq ? (zq ? 'Y' : 'X') : (zq ? 'Z' : 'I');
+            }
+            result.emplace_back(std::move(g));
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Vector with the values of the underlying classical dits
+     * \see qpp::QStabilizerEngine::set_dits()
+     *
+     * \return Vector of underlying classical dits
+     */
+    std::vector<idx> get_dits() const { return st_.dits_; }
+
+    /**
+     * \brief Value of the classical dit at position \a i
+     * \see qpp::QStabilizerEngine::set_dit()
+     *
+     * \param i Classical dit index
+     * \return Value of the classical dit at position \a i
+     */
+    idx get_dit(idx i) const {
+        // EXCEPTION CHECKS
+
+        if (i >= qc_->get_nc())
+            throw exception::OutOfRange("qpp::QStabilizerEngine::get_dit()");
+        // END EXCEPTION CHECKS
+
+        return st_.dits_[i];
+    }
+
+    /**
+     * \brief Vector of underlying measurement outcome probabilities
+     * \see qpp::QEngine::get_probs()
+     *
+     * \return Vector of underlying measurement outcome probabilities
+     */
+    std::vector<double> get_probs() const { return st_.probs_; }
+
+    /**
+     * \brief Check whether qubit \a i was already measured (destructively)
+     *
+     * \param i Qubit index
+     * \return True if qubit \a i was already measured, false otherwise
+     */
+    bool get_measured(idx i) const { return st_.measured_[i]; }
+
+    /**
+     * \brief Vector of already measured qubit indexes
+     *
+     * \return Vector of already measured qubit indexes
+     */
+    std::vector<idx> get_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Vector of non-measured qubit indexes
+     *
+     * \return Vector of non-measured qubit indexes
+     */
+    std::vector<idx> get_non_measured() const {
+        std::vector<idx> result;
+        for (idx i = 0; i < qc_->get_nq(); ++i)
+            if (!get_measured(i))
+                result.emplace_back(i);
+
+        return result;
+    }
+
+    /**
+     * \brief Quantum circuit description, lvalue ref qualifier
+     *
+     * \return Const reference to the underlying quantum circuit description
+     */
+    const QCircuit& get_circuit() const& noexcept { return *qc_; }
+
+    /**
+     * \brief Quantum circuit description, rvalue ref qualifier
+     *
+     * \return Copy of the underlying quantum circuit description
+     */
+    QCircuit get_circuit() const&& noexcept { return *qc_; }
+
+    /**
+     * \brief Measurement statistics for multiple runs
+     * \see qpp::QEngine::get_stats()
+     *
+     * \return Hash table with collected measurement statistics for multiple
+     * runs, with hash key being the string representation of the vector of
+     * measurement results and value being the number of occurrences (of the
+     * vector of measurement results), with the most significant bit located at
+     * index 0 (i.e. top/left).
+     */
+    std::map<std::string, idx, internal::EqualSameSizeStringDits>
+    get_stats() const {
+        return stats_;
+    }
+    // end getters
+
+    // setters
+    /**
+     * \brief Sets the classical dit at position \a i
+     * \see qpp::QStabilizerEngine::get_dit()
+     *
+     * \param i Classical dit index
+     * \param value Classical dit value
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& set_dit(idx i, idx value) {
+        // EXCEPTION CHECKS
+
+        if (i >= qc_->get_nc())
+            throw exception::OutOfRange("qpp::QStabilizerEngine::set_dit()");
+        // END EXCEPTION CHECKS
+        st_.dits_[i] = value;
+
+        return *this;
+    }
+
+    /**
+     * \brief Set the classical dits to \a dits
+     * \see qpp::QStabilizerEngine::get_dits()
+     *
+     * \param dits Vector of classical dits, must have the same size as the
+     * internal vector of classical dits returned by
+     * qpp::QStabilizerEngine::get_dits()
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& set_dits(std::vector<idx> dits) {
+        // EXCEPTION CHECKS
+
+        if (dits.size() != st_.dits_.size())
+            throw exception::SizeMismatch(
+                "qpp::QStabilizerEngine::set_dits()");
+        // END EXCEPTION CHECKS
+        st_.dits_ = std::move(dits);
+
+        return *this;
+    }
+    // end setters
+
+    /**
+     * \brief Resets the collected measurement statistics hash table
+     *
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& reset_stats() {
+        stats_ = {};
+
+        return *this;
+    }
+
+    /**
+     * \brief Resets the engine
+     *
+     * Re-initializes everything to zero and sets the initial state to
+     * \f$|0\rangle^{\otimes n}\f$, i.e. the destabilizers to \f$X_q\f$ and
+     * the stabilizers to \f$Z_q\f$
+     *
+     * \param reset_stats Optional (true by default), resets the collected
+     * measurement statistics hash table
+     *
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& reset(bool reset_stats = true) {
+        idx n = qc_->get_nq();
+        idx w = (n + 63) / 64;
+        st_.n_ = n;
+        st_.w_ = w;
+        st_.x_.assign((2 * n + 1) * w, 0);
+        st_.z_.assign((2 * n + 1) * w, 0);
+        st_.r_.assign(2 * n + 1, 0);
+        for (idx q = 0; q < n; ++q) {
+            std::uint64_t mq = static_cast<std::uint64_t>(1) << (q % 64);
+            st_.x_[q * w + q / 64] = mq;
+            st_.z_[(q + n) * w + q / 64] = mq;
+        }
+        st_.sw_ = 0;
+        st_.s_.clear();
+        st_.measured_ = std::vector<bool>(n, false);
+        st_.probs_ = std::vector<double>(qc_->get_nc(), 0);
+        st_.dits_ = std::vector<idx>(qc_->get_nc(), 0);
+        if (reset_stats)
+            this->reset_stats();
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param elem Step to be executed
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& execute(const QCircuit::iterator::value_type& elem) {
+        // EXCEPTION CHECKS
+
+        // iterator must point to the same quantum circuit description
+        if (elem.value_type_qc_ != qc_)
+            throw exception::InvalidIterator(
+                "qpp::QStabilizerEngine::execute()");
+        // the rest of exceptions are caught by the iterator::operator*()
+        // END EXCEPTION CHECKS
+
+        // gate step
+        if (elem.type_ == QCircuit::StepType::GATE) {
+            const auto& gate = *elem.gates_ip_;
+            std::vector<op_> ops = get_ops_(gate);
+
+            // classically-controlled gate, applied as many times as the
+            // common value of the shifted control dits, modulo 4 (the order
+            // of all the recognized gates divides 4)
+            idx times = 1;
+            if (QCircuit::is_cCTRL(gate) && !st_.dits_.empty()) {
+                auto dit = [&](idx m) {
+                    idx result = st_.dits_[gate.ctrl_[m]];
+                    if (!gate.shift_.empty())
+                        result = (result + gate.shift_[m]) % 2;
+                    return result;
+                };
+                times = dit(0) % 4;
+                for (idx m = 1; m < gate.ctrl_.size(); ++m)
+                    if (dit(m) != dit(0))
+                        times = 0;
+            }
+            for (idx t = 0; t < times; ++t)
+                for (auto&& op : ops)
+                    apply_(st_, op);
+        } // end if gate step
+
+        // measurement step
+        else if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
+            const auto& measurement = *elem.measurements_ip_;
+            const auto& target = measurement.target_;
+            idx c_reg = measurement.c_reg_;
+
+            // computational basis, the first target is the most significant
+            auto measure_Z = [&](bool destructive) {
+                idx result = 0;
+                double prob = 1;
+                for (auto&& i : target) {
+                    auto res = measure_Z_(i);
+                    result = 2 * result + res.first;
+                    prob *= res.second;
+                    if (destructive)
+                        st_.measured_[i] = true;
+                }
+                st_.dits_[c_reg] = result;
+                st_.probs_[c_reg] = prob;
+            };
+
+            switch (measurement.measurement_type_) {
+                case QCircuit::MeasureType::NONE:
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z:
+                case QCircuit::MeasureType::MEASURE_Z_MANY:
+                    measure_Z(true);
+                    break;
+                case QCircuit::MeasureType::MEASURE_Z_ND:
+                case QCircuit::MeasureType::MEASURE_Z_MANY_ND:
+                    measure_Z(false);
+                    break;
+                case QCircuit::MeasureType::RESET:
+                case QCircuit::MeasureType::RESET_MANY:
+                    for (auto&& i : target)
+                        if (measure_Z_(i).first != 0)
+                            apply_(st_, {CliffordType::X, i, i});
+                    break;
+                case QCircuit::MeasureType::DISCARD:
+                case QCircuit::MeasureType::DISCARD_MANY:
+                    for (auto&& i : target) {
+                        measure_Z_(i);
+                        st_.measured_[i] = true;
+                    }
+                    break;
+                default:
+                    throw exception::NotClifford(
+                        "qpp::QStabilizerEngine::execute()");
+            } // end switch on measurement type
+        }     // end else if measurement step
+
+        return *this;
+    }
+
+    /**
+     * \brief Executes one step in the quantum circuit description
+     *
+     * \param it Iterator to the step to be executed
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& execute(const QCircuit::iterator& it) {
+        return execute(*it);
+    }
+
+    /**
+     * \brief Executes the entire quantum circuit description
+     * \see qpp::QEngine::execute(idx, bool)
+     *
+     * \note The steps before the first measurement are executed only once.
+     * When the remaining steps are all terminal measurements in the
+     * computational basis, their outcomes are sampled from the resulting
+     * tableau, see qpp::QStabilizerEngine::sample_terminal_(). Otherwise they
+     * are repeated \a reps times.
+     *
+     * \param reps Number of repetitions
+     * \param clear_stats Resets the collected measurement statistics hash
+     * table before the run
+     * \return Reference to the current instance
+     */
+    QStabilizerEngine& execute(idx reps = 1, bool clear_stats = true) {
+        if (clear_stats)
+            reset_stats();
+
+        // find the position of the first measurement step
+        auto first_measurement_it = qc_->begin();
+        while (first_measurement_it != qc_->end()) {
+            if ((*first_measurement_it).type_ ==
+                QCircuit::StepType::MEASUREMENT)
+                break;
+            ++first_measurement_it;
+        }
+
+        for (auto it = qc_->begin(); it != first_measurement_it; ++it)
+            execute(it);
+        state_ entry = st_;
+
+        // when all measurements are terminal, samples all but the last
+        // repetition, which leaves the engine in a measured state as usual
+        if (reps > 1 &&
+            sample_terminal_(entry, first_measurement_it, reps - 1))
+            reps = 1;
+        for (idx i = 0; i < reps; ++i) {
+            st_ = entry;
+            for (auto it = first_measurement_it; it != qc_->end(); ++it)
+                execute(it);
+            update_stats_(st_.dits_);
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief qpp::IJSON::to_JSON() override
+     *
+     * Displays the state of the engine in JSON format
+     *
+     * \param enclosed_in_curly_brackets If true, encloses the result in
+     * curly brackets
+     * \return String containing the JSON representation of the state of the
+     * engine
+     */
+    std::string to_JSON(bool enclosed_in_curly_brackets = true) const override {
+        std::string result;
+
+        if (enclosed_in_curly_brackets)
+            result += "{";
+
+        std::ostringstream ss;
+        ss << disp(get_measured(), ", ");
+        result += "\"measured/discarded (destructive)\" : " + ss.str() + ", ";
+
+        ss.str("");
+        ss.clear();
+        ss << disp(get_non_measured(), ", ");
+        result += "\"non-measured/non-discarded\" : " + ss.str();
+
+        ss.str("");
+        ss.clear();
+        result += ", \"last probs\": ";
+        ss << disp(get_probs(), ", ");
+        result += ss.str();
+
+        ss.str("");
+        ss.clear();
+        result += ", \"last dits\": ";
+        ss << disp(get_dits(), ", ");
+        result += ss.str();
+
+        ss.str("");
+        ss.clear();
+
+        // compute the statistics
+        if (!stats_.empty()) {
+            result += ", \"stats\": {";
+            idx reps = 0;
+            for (auto&& elem : stats_)
+                reps += elem.second;
+            result += "\"reps\": " + std::to_string(reps) + ", ";
+            result += "\"outcomes\": " + std::to_string(stats_.size()) + ", ";
+
+            std::string sep;
+            for (auto&& elem : stats_) {
+                ss << sep << "\""
+                   << "[" << elem.first << "]"
+                   << "\" : " << elem.second;
+                sep = ", ";
+            }
+            ss << '}';
+            result += ss.str();
+        }
+
+        if (enclosed_in_curly_brackets)
+            result += "}";
+
+        return result;
+    }
+
+  private:
+    /**
+     * \brief qpp::IDisplay::display() override
+     *
+     * Writes to the output stream a textual representation of the state of
+     * the engine
+     *
+     * \param os Output stream passed by reference
+     * \return Reference to the output stream
+     */
+    std::ostream& display(std::ostream& os) const override {
+        os << "measured/discarded (destructive): " << disp(get_measured(), ", ")
+           << '\n';
+        os << "last probs: " << disp(get_probs(), ", ") << '\n';
+        os << "last dits: " << disp(get_dits(), ", ");
+
+        // compute the statistics
+        if (!stats_.empty()) {
+            idx reps = 0;
+            for (auto&& elem : stats_)
+                reps += elem.second;
+            os << "\nstats:\n";
+            os << '\t' << "reps: " << reps << '\n';
+            os << '\t' << "outcomes: " << stats_.size() << '\n';
+            std::string sep;
+            for (auto&& elem : stats_) {
+                os << sep << '\t' << "[" << elem.first << "]"
+                   << ": " << elem.second;
+                sep = '\n';
+            }
+        }
+
+        return os;
+    }
+}; /* class QStabilizerEngine */
+
 } /* namespace qpp */
 
 #endif /* CLASSES_CIRCUITS_ENGINES_HPP_ */
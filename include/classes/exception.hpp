@@ -676,6 +676,22 @@ class Undeclared : public Exception {
     using Exception::Exception;
 };
 
+/**
+ * \class qpp::exception::NotClifford
+ * \brief Not a Clifford operation exception
+ *
+ * The quantum circuit step is not a Clifford operation (gate or measurement)
+ * recognized by the stabilizer engine
+ */
+class NotClifford : public Exception {
+  public:
+    std::string description() const override {
+        return "Not a Clifford operation";
+    }
+
+    using Exception::Exception;
+};
+
 } /* namespace exception */
 } /* namespace qpp */
 
@@ -269,43 +269,61 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
      * \return Modular multiplication gate
      */
     cmat MODMUL(idx a, idx N, idx n) const {
+        std::vector<idx> perm = MODMUL_perm(a, N, n);
+        idx D = perm.size();
+
+        cmat result = cmat::Zero(D, D);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+        for (idx j = 0; j < D; ++j)
+            result(perm[j], j) = 1;
+
+        return result;
+    }
+
+    /**
+     * \brief Permutation of the computational basis states implemented by the
+     * modular multiplication gate for qubits qpp::Gates::MODMUL()
+     * \see qpp::apply_permutation_inplace(),
+     * qpp::applyCTRL_permutation_inplace()
+     *
+     * \note Represents the gate implicitly, with \f$2^n\f$ indexes instead of
+     * a \f$2^n \times 2^n\f$ matrix
+     *
+     * \param a Positive integer less than \a N
+     * \param N Positive integer
+     * \param n Number of qubits required for implementing the gate
+     * \return Permutation \a perm such that the gate maps \f$|x\rangle\f$
+     * to \f$|\mathrm{perm}[x]\rangle\f$
+     */
+    std::vector<idx> MODMUL_perm(idx a, idx N, idx n) const {
         // check co-primality (unitarity) only in DEBUG version
         assert(gcd(a, N) == 1);
         // EXCEPTION CHECKS
 
         // check valid arguments
         if (N < 3 || a >= N) {
-            throw exception::OutOfRange("qpp::Gates::MODMUL()");
+            throw exception::OutOfRange("qpp::Gates::MODMUL_perm()");
         }
 
         // check enough qubits
         if (n < static_cast<idx>(std::ceil(std::log2(N)))) {
-            throw exception::OutOfRange("qpp::Gates::MODMUL()");
+            throw exception::OutOfRange("qpp::Gates::MODMUL_perm()");
         }
         // END EXCEPTION CHECKS
 
         // minimum number of qubits required to implement the gate
         idx D = static_cast<idx>(std::llround(std::pow(2, n)));
 
-        cmat result = cmat::Zero(D, D);
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for collapse(2)
-#endif // HAS_OPENMP
-       // column major order for speed
-        for (idx j = 0; j < N; ++j)
-            for (idx i = 0; i < N; ++i)
-                if (static_cast<idx>(modmul(j, a, N)) == i)
-                    result(i, j) = 1;
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-       // complete the matrix
-        for (idx i = N; i < D; ++i)
-            result(i, i) = 1;
+        std::vector<idx> result(D);
+        // a * x mod N, accumulated without overflow
+        for (idx x = 0, ax = 0; x < N; ++x, ax = (ax + a) % N)
+            result[x] = ax;
+        for (idx x = N; x < D; ++x)
+            result[x] = x;
 
         return result;
     }
@@ -330,7 +348,12 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
         if (D == 2)
             return X;
 
-        return Fd(D).inverse() * Zd(D) * Fd(D);
+        // exact permutation matrix, equal to Fd(D)^{-1} * Zd(D) * Fd(D)
+        cmat result = cmat::Zero(D, D);
+        for (idx j = 0; j < D; ++j)
+            result((j + 1) % D, j) = 1;
+
+        return result;
     }
 
     /**
@@ -77,11 +77,16 @@ class NoiseBase {
      * \brief Compute probability outcomes for StateDependent noise type,
      * otherwise returns without performing any operation (no-op)
      *
+     * \note The reduced state of the qudits \a target is computed once,
+     * then all probabilities are obtained from it
+     *
      * \param state State vector or density matrix
      * \param target Target qudit indexes where the noise is applied
      * \param callee Optional caller name
      */
-    void compute_probs_(const cmat& state, const std::vector<idx>& target,
+    template <typename Derived>
+    void compute_probs_(const Eigen::MatrixBase<Derived>& state,
+                        const std::vector<idx>& target,
                         const std::string& caller = {}) const {
         if (!std::is_same<NoiseType::StateDependent, noise_type>::value)
             return; // no-op
@@ -93,13 +98,11 @@ class NoiseBase {
                                       "qpp::NoiseBase::compute_probs_()");
         // END EXCEPTION CHECKS
 
-        cmat rho_i;
         idx n = internal::get_num_subsys(state.rows(), D_);
+        cmat rho_i = ptrace(state, complement(target, n), D_);
 
-        for (idx i = 0; i < Ks_.size(); ++i) {
-            rho_i = ptrace(state, complement(target, n), D_);
+        for (idx i = 0; i < Ks_.size(); ++i)
             probs_[i] = trace(Ks_[i] * rho_i * adjoint(Ks_[i])).real();
-        }
     } /* compute_probs_() */
 
     /**
@@ -342,6 +345,43 @@ class NoiseBase {
 
         return result;
     }
+
+    /**
+     * \brief Applies the underlying noise model in-place on qudit \a target
+     * of the multi-partite state vector \a psi, by sampling a single Kraus
+     * operator (quantum trajectory)
+     *
+     * \note Equivalent to \a psi = operator()(\a psi, \a target), without
+     * allocating a new state vector
+     *
+     * \param psi Multi-partite state vector
+     * \param target Target qudit index where the noise is applied
+     */
+    virtual void apply_inplace(ket& psi, idx target) const {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(psi))
+            throw exception::ZeroSize("qpp::NoiseBase::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        compute_probs_(psi, std::vector<idx>{target},
+                       "qpp::NoiseBase::apply_inplace()");
+
+        assert(probs_ != decltype(probs_)(probs_.size(), 0)); // not all zeros
+        std::discrete_distribution<idx> dd{std::begin(probs_),
+                                           std::end(probs_)};
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+        i_ = dd(gen);
+        qpp::apply_inplace(psi, Ks_[i_], std::vector<idx>{target}, D_);
+        generated_ = true;
+
+        psi /= psi.norm();
+    }
 }; /* class NoiseBase */
 
 // qubit noise models
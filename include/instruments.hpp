@@ -206,7 +206,8 @@ ip(const Eigen::MatrixBase<Derived>& phi, const Eigen::MatrixBase<Derived>& psi,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
     const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
@@ -226,21 +227,25 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
             throw exception::DimsNotEqual("qpp::measure()");
     // END EXCEPTION CHECKS
 
+    using Scalar = typename Derived::Scalar;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     // probabilities
     std::vector<double> probs(Ks.size());
     // resulting states
-    std::vector<cmat> outstates(Ks.size());
+    std::vector<dyn_mat<Scalar>> outstates(Ks.size());
 
     idx Dout = Ks[0].rows();
     //************ density matrix ************//
     if (internal::check_square_mat(rA)) // square matrix
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            outstates[i] = cmat::Zero(Dout, Dout);
-            cmat tmp = Ks[i] * rA * adjoint(Ks[i]); // un-normalized;
-            probs[i] = std::abs(trace(tmp));        // probability
+            const dyn_mat<Scalar>& rK = Ks[i].template cast<Scalar>();
+            outstates[i] = dyn_mat<Scalar>::Zero(Dout, Dout);
+            dyn_mat<Scalar> tmp = rK * rA * adjoint(rK); // un-normalized;
+            probs[i] = std::abs(trace(tmp));             // probability
             if (probs[i] > 0) {
-                outstates[i] = tmp / probs[i]; // normalized
+                outstates[i] = tmp / static_cast<Real>(probs[i]); // normalized
             }
         }
     }
@@ -248,12 +253,14 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
     else if (internal::check_cvector(rA)) // column vector
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            outstates[i] = ket::Zero(Dout);
-            ket tmp = Ks[i] * rA; // un-normalized;
+            outstates[i] = dyn_col_vect<Scalar>::Zero(Dout);
+            // un-normalized
+            dyn_col_vect<Scalar> tmp = Ks[i].template cast<Scalar>() * rA;
             // probability
             probs[i] = std::pow(norm(tmp), 2);
             if (probs[i] > 0) {
-                outstates[i] = tmp / std::sqrt(probs[i]); // normalized
+                // normalized
+                outstates[i] = tmp / static_cast<Real>(std::sqrt(probs[i]));
             }
         }
     } else
@@ -286,7 +293,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks) {
     return measure(A, std::vector<cmat>(Ks));
@@ -305,7 +313,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& U) {
     const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
@@ -350,7 +359,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& U) {
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         const std::vector<idx>& target, const std::vector<idx>& dims,
         bool destructive = true) {
@@ -400,26 +410,31 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
             throw exception::DimsNotEqual("qpp::measure()");
     // END EXCEPTION CHECKS
 
+    using Scalar = typename Derived::Scalar;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     // probabilities
     std::vector<double> probs(Ks.size());
     // resulting states
-    std::vector<cmat> outstates;
+    std::vector<dyn_mat<Scalar>> outstates;
 
     if (destructive)
-        outstates.resize(Ks.size(), cmat::Zero(Dsubsys_bar, Dsubsys_bar));
+        outstates.resize(Ks.size(),
+                         dyn_mat<Scalar>::Zero(Dsubsys_bar, Dsubsys_bar));
     else
-        outstates.resize(Ks.size(), cmat::Zero(D, D));
+        outstates.resize(Ks.size(), dyn_mat<Scalar>::Zero(D, D));
 
     //************ ket ************//
     if (internal::check_cvector(rA)) // column vector
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            ket tmp = apply(rA, Ks[i], target, dims);
+            dyn_col_vect<Scalar> tmp =
+                apply(rA, Ks[i].template cast<Scalar>(), target, dims);
             probs[i] = std::pow(norm(tmp), 2);
             if (probs[i] > 0) {
                 // normalized output state
                 // corresponding to measurement result i
-                tmp /= std::sqrt(probs[i]);
+                tmp /= static_cast<Real>(std::sqrt(probs[i]));
                 if (destructive)
                     outstates[i] = ptrace(tmp, target, dims);
                 else
@@ -431,14 +446,15 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
     else // square matrix
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            cmat tmp = apply(rA, Ks[i], target, dims);
+            dyn_mat<Scalar> tmp =
+                apply(rA, Ks[i].template cast<Scalar>(), target, dims);
             if (destructive)
                 tmp = ptrace(tmp, target, dims);
             probs[i] = std::abs(trace(tmp)); // probability
             if (probs[i] > 0) {
                 // normalized output state
                 // corresponding to measurement result i
-                outstates[i] = tmp / probs[i];
+                outstates[i] = tmp / static_cast<Real>(probs[i]);
             }
         }
     }
@@ -477,7 +493,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
         const std::vector<idx>& dims, bool destructive = true) {
@@ -502,7 +519,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         const std::vector<idx>& target, idx d = 2, bool destructive = true) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -545,7 +563,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
         idx d = 2, bool destructive = true) {
@@ -566,6 +585,10 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * of \a target. If that is the case, then the measurement probabilities sum up
  * to a number smaller than 1 (i.e., having, in effect, a filtering operation).
  *
+ * \note \a A can have any complex scalar type, e.g. std::complex<float>, in
+ * which case \a V is converted to it and the post-measurement states have the
+ * same scalar type as \a A
+ *
  * \param A Eigen expression
  * \param V Matrix whose columns represent the measurement basis vectors or the
  * ket parts of the rank-1 projectors
@@ -576,7 +599,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         const std::vector<idx>& target, const std::vector<idx>& dims,
         bool destructive = true) {
@@ -622,11 +646,16 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
     // number of basis elements or number of rank-1 projectors
     idx M = static_cast<idx>(V.cols());
 
+    using Scalar = typename Derived::Scalar;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     //************ ket ************//
     if (internal::check_cvector(rA)) {
-        const ket& rpsi = A.derived();
-        std::vector<double> probs(M);   // probabilities
-        std::vector<cmat> outstates(M); // resulting states
+        const dyn_col_vect<Scalar>& rpsi = A.derived();
+        // basis vectors in the precision of the state, no copy if the same
+        const dyn_mat<Scalar>& rV = V.template cast<Scalar>();
+        std::vector<double> probs(M);              // probabilities
+        std::vector<dyn_mat<Scalar>> outstates(M); // resulting states
 
 #ifdef HAS_OPENMP
 // NOLINTNEXTLINE
@@ -635,9 +664,10 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         for (idx i = 0; i < M; ++i) {
             if (destructive)
                 outstates[i] =
-                    ip(static_cast<const ket&>(V.col(i)), rpsi, target, dims);
+                    ip(static_cast<const dyn_col_vect<Scalar>&>(rV.col(i)),
+                       rpsi, target, dims);
             else
-                outstates[i] = apply(rpsi, prj(V.col(i)), target, dims);
+                outstates[i] = apply(rpsi, prj(rV.col(i)), target, dims);
         }
 
         for (idx i = 0; i < M; ++i) {
@@ -646,7 +676,7 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
             if (probs[i] > 0) {
                 // normalized output state
                 // corresponding to measurement result m
-                outstates[i] /= tmp;
+                outstates[i] /= static_cast<Real>(tmp);
             }
         }
 
@@ -697,7 +727,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
  * probabilities, and 3. Vector of post-measurement normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<typename Derived::Scalar>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         const std::vector<idx>& target, idx d = 2, bool destructive = true) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -737,7 +768,7 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
  * index), 2. Outcome probability, and 3. Post-measurement normalized state
  */
 template <typename Derived>
-std::tuple<std::vector<idx>, double, cmat>
+std::tuple<std::vector<idx>, double, dyn_mat<typename Derived::Scalar>>
 measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
             std::vector<idx> dims, bool destructive = true) {
     //    typename std::remove_const<
@@ -816,7 +847,7 @@ measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
  * index), 2. Outcome probability, and 3. Post-measurement normalized state
  */
 template <typename Derived>
-std::tuple<std::vector<idx>, double, cmat>
+std::tuple<std::vector<idx>, double, dyn_mat<typename Derived::Scalar>>
 measure_seq(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
             idx d = 2, bool destructive = true) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -885,8 +916,9 @@ dyn_mat<typename Derived::Scalar> reset(const Eigen::MatrixBase<Derived>& A,
 
     std::tie(resZ, std::ignore, result) = measure_seq(rA, target, dims, false);
     for (idx i = 0; i < target.size(); ++i) {
-        cmat correction =
-            powm(Gates::get_instance().Xd(dims[i]), dims[i] - resZ[i]);
+        dyn_mat<typename Derived::Scalar> correction =
+            powm(Gates::get_instance().Xd(dims[i]), dims[i] - resZ[i])
+                .template cast<typename Derived::Scalar>();
         result = apply(result, correction, {target[i]}, dims);
     }
 
@@ -0,0 +1,423 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * Copyright (c) 2013 - 2021 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file internal/simd.hpp
+ * \brief Vectorized kernels for applying qubit gates to state vectors, with
+ * runtime instruction set selection
+ */
+
+#ifndef INTERNAL_SIMD_HPP_
+#define INTERNAL_SIMD_HPP_
+
+// the vectorized kernels are available on x86/x86_64 with GNU gcc or Clang,
+// define NO_SIMD_ to disable them
+#if !defined(NO_SIMD_) && (__GNUC__ || __clang__) &&                         \
+    (defined(__x86_64__) || defined(__i386__))
+#define HAS_SIMD_X86_
+#include <immintrin.h>
+#endif // !defined(NO_SIMD_) && ...
+
+namespace qpp {
+namespace internal {
+/**
+ * \brief Instruction sets used by the vectorized qubit kernels
+ */
+enum class SimdISA {
+    NONE,   ///< scalar code
+    SSE2,   ///< SSE2, one complex amplitude per register
+    AVX2,   ///< AVX2 + FMA, two complex amplitudes per register
+    AVX512, ///< AVX-512F, four complex amplitudes per register
+};
+
+/**
+ * \brief Detects the best instruction set supported by the CPU
+ *
+ * \return Best supported instruction set
+ */
+inline SimdISA simd_detect_isa() noexcept {
+#ifdef HAS_SIMD_X86_
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdISA::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdISA::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdISA::SSE2;
+#endif // HAS_SIMD_X86_
+    return SimdISA::NONE;
+}
+
+/**
+ * \brief Instruction set used by the vectorized qubit kernels
+ *
+ * \note Detected once, at first use. May be lowered (but should not be raised
+ * above qpp::internal::simd_detect_isa()), e.g. for benchmarking. Not
+ * thread-safe, change it only outside parallel regions.
+ *
+ * \return Reference to the instruction set in use
+ */
+inline SimdISA& simd_isa() noexcept {
+    static SimdISA isa = simd_detect_isa();
+    return isa;
+}
+
+#ifdef HAS_SIMD_X86_
+// The kernels below work on the interleaved (real, imag) representation of
+// std::complex<double>. A gate entry u = ur + i*ui is stored as the broadcast
+// ur and the alternating (-ui, ui), so that u*a = ur*a + (-ui, ui)*swap(a),
+// where swap(a) exchanges the real and imaginary parts of a. Only the
+// amplitudes for which the control condition holds are visited.
+
+// SSE2 kernels, one amplitude per register
+
+__attribute__((target("sse2"))) inline __m128d
+simd_cmac_sse2(__m128d acc, __m128d ur, __m128d ui, __m128d a) {
+    __m128d a_swap = _mm_shuffle_pd(a, a, 1);
+    return _mm_add_pd(acc,
+                      _mm_add_pd(_mm_mul_pd(ur, a), _mm_mul_pd(ui, a_swap)));
+}
+
+__attribute__((target("sse2"))) inline void
+apply_qubit1_sse2(cplx* psi, idx D, const cmat& U, idx pos, idx ctrl_mask,
+                  idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m128d ur[4], ui[4];
+    for (idx k = 0; k < 4; ++k) {
+        cplx u = U(k / 2, k % 2);
+        ur[k] = _mm_set1_pd(std::real(u));
+        ui[k] = _mm_setr_pd(-std::imag(u), std::imag(u));
+    }
+    const idx bit = static_cast<idx>(1) << pos;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit, fixed);
+    const idx blocks = D >> nfixed;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i0 = insert_zero_bits(k, fixed, nfixed) | ctrl_val;
+        idx i1 = i0 | bit;
+        __m128d a0 = _mm_loadu_pd(p + 2 * i0);
+        __m128d a1 = _mm_loadu_pd(p + 2 * i1);
+        __m128d r0 = simd_cmac_sse2(_mm_setzero_pd(), ur[0], ui[0], a0);
+        __m128d r1 = simd_cmac_sse2(_mm_setzero_pd(), ur[2], ui[2], a0);
+        r0 = simd_cmac_sse2(r0, ur[1], ui[1], a1);
+        r1 = simd_cmac_sse2(r1, ur[3], ui[3], a1);
+        _mm_storeu_pd(p + 2 * i0, r0);
+        _mm_storeu_pd(p + 2 * i1, r1);
+    }
+}
+
+__attribute__((target("sse2"))) inline void
+apply_qubit2_sse2(cplx* psi, idx D, const cmat& U, idx pos0, idx pos1,
+                  idx ctrl_mask, idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m128d ur[16], ui[16];
+    for (idx k = 0; k < 16; ++k) {
+        cplx u = U(k / 4, k % 4);
+        ur[k] = _mm_set1_pd(std::real(u));
+        ui[k] = _mm_setr_pd(-std::imag(u), std::imag(u));
+    }
+    const idx bit0 = static_cast<idx>(1) << pos0;
+    const idx bit1 = static_cast<idx>(1) << pos1;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit0 | bit1, fixed);
+    const idx blocks = D >> nfixed;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i00 = insert_zero_bits(k, fixed, nfixed) | ctrl_val;
+        idx pos[4] = {i00, i00 | bit1, i00 | bit0, i00 | bit0 | bit1};
+        __m128d a[4];
+        for (idx c = 0; c < 4; ++c)
+            a[c] = _mm_loadu_pd(p + 2 * pos[c]);
+        for (idx r = 0; r < 4; ++r) {
+            __m128d acc = _mm_setzero_pd();
+            for (idx c = 0; c < 4; ++c)
+                acc = simd_cmac_sse2(acc, ur[4 * r + c], ui[4 * r + c], a[c]);
+            _mm_storeu_pd(p + 2 * pos[r], acc);
+        }
+    }
+}
+
+// AVX2 kernels, two consecutive amplitudes per register; require the target
+// bits and the control mask to leave bit 0 free
+
+__attribute__((target("avx2,fma"))) inline __m256d
+simd_cmac_avx2(__m256d acc, __m256d ur, __m256d ui, __m256d a) {
+    __m256d a_swap = _mm256_permute_pd(a, 0x5);
+    return _mm256_fmadd_pd(ur, a, _mm256_fmadd_pd(ui, a_swap, acc));
+}
+
+__attribute__((target("avx2,fma"))) inline void
+apply_qubit1_avx2(cplx* psi, idx D, const cmat& U, idx pos, idx ctrl_mask,
+                  idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m256d ur[4], ui[4];
+    for (idx k = 0; k < 4; ++k) {
+        cplx u = U(k / 2, k % 2);
+        double im = std::imag(u);
+        ur[k] = _mm256_set1_pd(std::real(u));
+        ui[k] = _mm256_setr_pd(-im, im, -im, im);
+    }
+    const idx bit = static_cast<idx>(1) << pos;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit, fixed);
+    const idx blocks = D >> (nfixed + 1);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i0 = insert_zero_bits(2 * k, fixed, nfixed) | ctrl_val;
+        idx i1 = i0 | bit;
+        __m256d a0 = _mm256_loadu_pd(p + 2 * i0);
+        __m256d a1 = _mm256_loadu_pd(p + 2 * i1);
+        __m256d r0 = simd_cmac_avx2(_mm256_setzero_pd(), ur[0], ui[0], a0);
+        __m256d r1 = simd_cmac_avx2(_mm256_setzero_pd(), ur[2], ui[2], a0);
+        r0 = simd_cmac_avx2(r0, ur[1], ui[1], a1);
+        r1 = simd_cmac_avx2(r1, ur[3], ui[3], a1);
+        _mm256_storeu_pd(p + 2 * i0, r0);
+        _mm256_storeu_pd(p + 2 * i1, r1);
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void
+apply_qubit2_avx2(cplx* psi, idx D, const cmat& U, idx pos0, idx pos1,
+                  idx ctrl_mask, idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m256d ur[16], ui[16];
+    for (idx k = 0; k < 16; ++k) {
+        cplx u = U(k / 4, k % 4);
+        double im = std::imag(u);
+        ur[k] = _mm256_set1_pd(std::real(u));
+        ui[k] = _mm256_setr_pd(-im, im, -im, im);
+    }
+    const idx bit0 = static_cast<idx>(1) << pos0;
+    const idx bit1 = static_cast<idx>(1) << pos1;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit0 | bit1, fixed);
+    const idx blocks = D >> (nfixed + 1);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i00 = insert_zero_bits(2 * k, fixed, nfixed) | ctrl_val;
+        idx pos[4] = {i00, i00 | bit1, i00 | bit0, i00 | bit0 | bit1};
+        __m256d a[4];
+        for (idx c = 0; c < 4; ++c)
+            a[c] = _mm256_loadu_pd(p + 2 * pos[c]);
+        for (idx r = 0; r < 4; ++r) {
+            __m256d acc = _mm256_setzero_pd();
+            for (idx c = 0; c < 4; ++c)
+                acc = simd_cmac_avx2(acc, ur[4 * r + c], ui[4 * r + c], a[c]);
+            _mm256_storeu_pd(p + 2 * pos[r], acc);
+        }
+    }
+}
+
+// AVX-512 kernels, four consecutive amplitudes per register; require the
+// target bits and the control mask to leave bits 0 and 1 free
+
+__attribute__((target("avx512f"))) inline __m512d
+simd_cmac_avx512(__m512d acc, __m512d ur, __m512d ui, __m512d a) {
+    __m512d a_swap = _mm512_shuffle_pd(a, a, 0x55);
+    return _mm512_fmadd_pd(ur, a, _mm512_fmadd_pd(ui, a_swap, acc));
+}
+
+__attribute__((target("avx512f"))) inline void
+apply_qubit1_avx512(cplx* psi, idx D, const cmat& U, idx pos, idx ctrl_mask,
+                    idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m512d ur[4], ui[4];
+    for (idx k = 0; k < 4; ++k) {
+        cplx u = U(k / 2, k % 2);
+        double im = std::imag(u);
+        ur[k] = _mm512_set1_pd(std::real(u));
+        ui[k] = _mm512_setr_pd(-im, im, -im, im, -im, im, -im, im);
+    }
+    const idx bit = static_cast<idx>(1) << pos;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit, fixed);
+    const idx blocks = D >> (nfixed + 2);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i0 = insert_zero_bits(4 * k, fixed, nfixed) | ctrl_val;
+        idx i1 = i0 | bit;
+        __m512d a0 = _mm512_loadu_pd(p + 2 * i0);
+        __m512d a1 = _mm512_loadu_pd(p + 2 * i1);
+        __m512d r0 = simd_cmac_avx512(_mm512_setzero_pd(), ur[0], ui[0], a0);
+        __m512d r1 = simd_cmac_avx512(_mm512_setzero_pd(), ur[2], ui[2], a0);
+        r0 = simd_cmac_avx512(r0, ur[1], ui[1], a1);
+        r1 = simd_cmac_avx512(r1, ur[3], ui[3], a1);
+        _mm512_storeu_pd(p + 2 * i0, r0);
+        _mm512_storeu_pd(p + 2 * i1, r1);
+    }
+}
+
+__attribute__((target("avx512f"))) inline void
+apply_qubit2_avx512(cplx* psi, idx D, const cmat& U, idx pos0, idx pos1,
+                    idx ctrl_mask, idx ctrl_val) {
+    double* p = reinterpret_cast<double*>(psi);
+    __m512d ur[16], ui[16];
+    for (idx k = 0; k < 16; ++k) {
+        cplx u = U(k / 4, k % 4);
+        double im = std::imag(u);
+        ur[k] = _mm512_set1_pd(std::real(u));
+        ui[k] = _mm512_setr_pd(-im, im, -im, im, -im, im, -im, im);
+    }
+    const idx bit0 = static_cast<idx>(1) << pos0;
+    const idx bit1 = static_cast<idx>(1) << pos1;
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit0 | bit1, fixed);
+    const idx blocks = D >> (nfixed + 2);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i00 = insert_zero_bits(4 * k, fixed, nfixed) | ctrl_val;
+        idx pos[4] = {i00, i00 | bit1, i00 | bit0, i00 | bit0 | bit1};
+        __m512d a[4];
+        for (idx c = 0; c < 4; ++c)
+            a[c] = _mm512_loadu_pd(p + 2 * pos[c]);
+        for (idx r = 0; r < 4; ++r) {
+            __m512d acc = _mm512_setzero_pd();
+            for (idx c = 0; c < 4; ++c)
+                acc =
+                    simd_cmac_avx512(acc, ur[4 * r + c], ui[4 * r + c], a[c]);
+            _mm512_storeu_pd(p + 2 * pos[r], acc);
+        }
+    }
+}
+#endif // HAS_SIMD_X86_
+
+/**
+ * \brief Applies in-place the 2 x 2 matrix \a U to a qubit of the state vector
+ * \a psi using vectorized kernels, see qpp::internal::apply_qubit1_inplace()
+ *
+ * \return True if a vectorized kernel was used, false otherwise (the state is
+ * then left untouched)
+ */
+template <typename Scalar>
+bool apply_qubit1_simd(Scalar*, idx, const dyn_mat<Scalar>&, idx, idx, idx) {
+    return false; // only std::complex<double> is vectorized
+}
+
+/**
+ * \brief Applies in-place the 2 x 2 matrix \a U to a qubit of the state vector
+ * \a psi using vectorized kernels, see qpp::internal::apply_qubit1_inplace()
+ *
+ * \return True if a vectorized kernel was used, false otherwise (the state is
+ * then left untouched)
+ */
+inline bool apply_qubit1_simd(cplx* psi, idx D, const cmat& U, idx pos,
+                              idx ctrl_mask, idx ctrl_val) {
+#ifdef HAS_SIMD_X86_
+    SimdISA isa = simd_isa();
+    if (isa == SimdISA::AVX512 && pos >= 2 && (ctrl_mask & 3) == 0) {
+        apply_qubit1_avx512(psi, D, U, pos, ctrl_mask, ctrl_val);
+        return true;
+    }
+    if (isa >= SimdISA::AVX2 && pos >= 1 && (ctrl_mask & 1) == 0) {
+        apply_qubit1_avx2(psi, D, U, pos, ctrl_mask, ctrl_val);
+        return true;
+    }
+    if (isa >= SimdISA::SSE2) {
+        apply_qubit1_sse2(psi, D, U, pos, ctrl_mask, ctrl_val);
+        return true;
+    }
+#else
+    (void) psi, (void) D, (void) U, (void) pos, (void) ctrl_mask,
+        (void) ctrl_val;
+#endif // HAS_SIMD_X86_
+    return false;
+}
+
+/**
+ * \brief Applies in-place the 4 x 4 matrix \a U to two qubits of the state
+ * vector \a psi using vectorized kernels, see
+ * qpp::internal::apply_qubit2_inplace()
+ *
+ * \return True if a vectorized kernel was used, false otherwise (the state is
+ * then left untouched)
+ */
+template <typename Scalar>
+bool apply_qubit2_simd(Scalar*, idx, const dyn_mat<Scalar>&, idx, idx, idx,
+                       idx) {
+    return false; // only std::complex<double> is vectorized
+}
+
+/**
+ * \brief Applies in-place the 4 x 4 matrix \a U to two qubits of the state
+ * vector \a psi using vectorized kernels, see
+ * qpp::internal::apply_qubit2_inplace()
+ *
+ * \return True if a vectorized kernel was used, false otherwise (the state is
+ * then left untouched)
+ */
+inline bool apply_qubit2_simd(cplx* psi, idx D, const cmat& U, idx pos0,
+                              idx pos1, idx ctrl_mask, idx ctrl_val) {
+#ifdef HAS_SIMD_X86_
+    SimdISA isa = simd_isa();
+    idx lo = std::min(pos0, pos1);
+    if (isa == SimdISA::AVX512 && lo >= 2 && (ctrl_mask & 3) == 0) {
+        apply_qubit2_avx512(psi, D, U, pos0, pos1, ctrl_mask, ctrl_val);
+        return true;
+    }
+    if (isa >= SimdISA::AVX2 && lo >= 1 && (ctrl_mask & 1) == 0) {
+        apply_qubit2_avx2(psi, D, U, pos0, pos1, ctrl_mask, ctrl_val);
+        return true;
+    }
+    if (isa >= SimdISA::SSE2) {
+        apply_qubit2_sse2(psi, D, U, pos0, pos1, ctrl_mask, ctrl_val);
+        return true;
+    }
+#else
+    (void) psi, (void) D, (void) U, (void) pos0, (void) pos1,
+        (void) ctrl_mask, (void) ctrl_val;
+#endif // HAS_SIMD_X86_
+    return false;
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_SIMD_HPP_ */
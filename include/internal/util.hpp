@@ -96,6 +96,132 @@ inline idx multiidx2n(const idx* const midx, idx numdims,
 #pragma GCC diagnostic pop
 #endif
 
+// inserts a zero bit at position pos (counted from the least significant bit)
+// in the binary representation of i, e.g. insert_zero_bit(0b11, 1) = 0b101
+inline idx insert_zero_bit(idx i, idx pos) noexcept {
+    idx mask = (static_cast<idx>(1) << pos) - 1;
+    return ((i & ~mask) << 1) | (i & mask);
+}
+
+// inserts zero bits at the positions pos[0] < pos[1] < ... < pos[npos - 1] of
+// the result, i.e. spreads the bits of i over the other positions
+inline idx insert_zero_bits(idx i, const idx* pos, idx npos) noexcept {
+    for (idx k = 0; k < npos; ++k)
+        i = insert_zero_bit(i, pos[k]);
+    return i;
+}
+
+// positions of the set bits of mask, in increasing order, stored in pos;
+// returns their number
+inline idx set_bit_positions(idx mask, idx* pos) noexcept {
+    idx npos = 0;
+    for (idx k = 0; mask != 0; ++k, mask >>= 1)
+        if (mask & 1)
+            pos[npos++] = k;
+    return npos;
+}
+
+// number of set bits in the binary representation of x
+inline idx popcount64(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<idx>(__builtin_popcountll(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<idx>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// strides of the subsystems of a row-major tensor with local dimensions dims,
+// i.e. the first subsystem is the most significant
+inline std::vector<idx> subsys_strides(const std::vector<idx>& dims) {
+    idx n = dims.size();
+    std::vector<idx> result(n, 1);
+    for (idx i = n; i-- > 1;)
+        result[i - 1] = result[i] * dims[i];
+
+    return result;
+}
+
+// offsets of the basis states of the subsystems subsys in a tensor with local
+// dimensions dims and subsystem strides strides, in lexicographical order of
+// subsys (the last subsystem varies the fastest); built by mixed-radix
+// expansion, without any division
+inline std::vector<idx> subsys_offsets(const std::vector<idx>& subsys,
+                                       const std::vector<idx>& dims,
+                                       const std::vector<idx>& strides) {
+    std::vector<idx> result{0};
+    for (auto&& i : subsys) {
+        std::vector<idx> expanded;
+        expanded.reserve(result.size() * dims[i]);
+        for (auto&& offset : result)
+            for (idx m = 0; m < dims[i]; ++m)
+                expanded.emplace_back(offset + m * strides[i]);
+        result.swap(expanded);
+    }
+
+    return result;
+}
+
+// permutes the subsystems of the row-major tensor src with local dimensions
+// dims into dst, the subsystem perm[i] of src becoming the subsystem i of dst;
+// the elements are copied in tiles made of the innermost subsystems of both
+// src and dst (contiguous runs of at least 64 elements in each), so that the
+// reads and the writes of a tile stay in cache
+template <typename Scalar>
+void permute_subsys(const Scalar* src, Scalar* dst,
+                    const std::vector<idx>& dims,
+                    const std::vector<idx>& perm) {
+    idx n = dims.size();
+    std::vector<idx> dst_dims(n);
+    for (idx i = 0; i < n; ++i)
+        dst_dims[i] = dims[perm[i]];
+    std::vector<idx> src_strides = subsys_strides(dims);
+    std::vector<idx> dst_strides(n); // stride in dst of subsystem i of src
+    std::vector<idx> dst_dims_strides = subsys_strides(dst_dims);
+    for (idx i = 0; i < n; ++i)
+        dst_strides[perm[i]] = dst_dims_strides[i];
+
+    // innermost subsystems of dst and of src make up a tile
+    const idx run = 64;
+    std::vector<bool> in_tile(n, false);
+    idx size = 1;
+    for (idx i = n; i-- > 0 && size < run;) {
+        in_tile[perm[i]] = true;
+        size *= dims[perm[i]];
+    }
+    size = 1;
+    for (idx i = n; i-- > 0 && size < run;) {
+        in_tile[i] = true;
+        size *= dims[i];
+    }
+    // in dst order, so that the writes are sequential within a tile
+    std::vector<idx> tile_subsys, outer_subsys;
+    for (idx i = 0; i < n; ++i)
+        (in_tile[perm[i]] ? tile_subsys : outer_subsys).emplace_back(perm[i]);
+
+    std::vector<idx> tile_src = subsys_offsets(tile_subsys, dims, src_strides);
+    std::vector<idx> tile_dst = subsys_offsets(tile_subsys, dims, dst_strides);
+    std::vector<idx> outer_src =
+        subsys_offsets(outer_subsys, dims, src_strides);
+    std::vector<idx> outer_dst =
+        subsys_offsets(outer_subsys, dims, dst_strides);
+    idx tile_size = tile_src.size();
+    idx num_tiles = outer_src.size();
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < num_tiles; ++k) {
+        const Scalar* src_tile = src + outer_src[k];
+        Scalar* dst_tile = dst + outer_dst[k];
+        for (idx m = 0; m < tile_size; ++m)
+            dst_tile[tile_dst[m]] = src_tile[tile_src[m]];
+    }
+}
+
 // check square matrix
 template <typename Derived>
 bool check_square_mat(const Eigen::MatrixBase<Derived>& A) {
@@ -34,15 +34,1191 @@
 
 namespace qpp {
 
+namespace internal {
+// product of amplitudes, real case
+template <typename Scalar>
+Scalar cmul_(const Scalar& a, const Scalar& b) {
+    return a * b;
+}
+
+// complex product, without the handling of infinite and NaN operands of
+// std::complex::operator*() that prevents its inlining
+template <typename T>
+std::complex<T> cmul_(const std::complex<T>& a, const std::complex<T>& b) {
+    return std::complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                           a.real() * b.imag() + a.imag() * b.real());
+}
+
+/**
+ * \brief Applies in-place the 2 x 2 matrix \a U to the qubit located at bit
+ * position \a pos of the qubit state vector \a psi, on the amplitudes for which
+ * the bits selected by \a ctrl_mask equal \a ctrl_val
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param D Dimension of the state vector
+ * \param U 2 x 2 matrix
+ * \param pos Bit position of the target qubit
+ * \param ctrl_mask Control bit mask
+ * \param ctrl_val Control bit values
+ */
+template <typename Scalar>
+void apply_qubit1_inplace(Scalar* psi, idx D, const dyn_mat<Scalar>& U,
+                          idx pos, idx ctrl_mask, idx ctrl_val) {
+    // vectorized kernel, if available
+    if (apply_qubit1_simd(psi, D, U, pos, ctrl_mask, ctrl_val))
+        return;
+
+    const Scalar u00 = U(0, 0), u01 = U(0, 1);
+    const Scalar u10 = U(1, 0), u11 = U(1, 1);
+    const idx bit = static_cast<idx>(1) << pos;
+    // only the amplitudes for which the control condition holds are visited
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit, fixed);
+    const idx blocks = D >> nfixed;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i0 = insert_zero_bits(k, fixed, nfixed) | ctrl_val;
+        idx i1 = i0 | bit;
+        Scalar a0 = psi[i0];
+        Scalar a1 = psi[i1];
+        psi[i0] = cmul_(u00, a0) + cmul_(u01, a1);
+        psi[i1] = cmul_(u10, a0) + cmul_(u11, a1);
+    }
+}
+
+/**
+ * \brief Applies in-place the 4 x 4 matrix \a U to the qubits located at bit
+ * positions \a pos0 and \a pos1 of the qubit state vector \a psi, on the
+ * amplitudes for which the bits selected by \a ctrl_mask equal \a ctrl_val
+ *
+ * \note The qubit at \a pos0 corresponds to the most significant qubit of \a U
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param D Dimension of the state vector
+ * \param U 4 x 4 matrix
+ * \param pos0 Bit position of the first target qubit
+ * \param pos1 Bit position of the second target qubit
+ * \param ctrl_mask Control bit mask
+ * \param ctrl_val Control bit values
+ */
+template <typename Scalar>
+void apply_qubit2_inplace(Scalar* psi, idx D, const dyn_mat<Scalar>& U,
+                          idx pos0, idx pos1, idx ctrl_mask, idx ctrl_val) {
+    // vectorized kernel, if available
+    if (apply_qubit2_simd(psi, D, U, pos0, pos1, ctrl_mask, ctrl_val))
+        return;
+
+    Scalar u[4][4];
+    for (idx r = 0; r < 4; ++r)
+        for (idx c = 0; c < 4; ++c)
+            u[r][c] = U(r, c);
+    const idx bit0 = static_cast<idx>(1) << pos0;
+    const idx bit1 = static_cast<idx>(1) << pos1;
+    // only the amplitudes for which the control condition holds are visited
+    idx fixed[maxn];
+    const idx nfixed = set_bit_positions(ctrl_mask | bit0 | bit1, fixed);
+    const idx blocks = D >> nfixed;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx k = 0; k < blocks; ++k) {
+        idx i00 = insert_zero_bits(k, fixed, nfixed) | ctrl_val;
+        idx pos[4] = {i00, i00 | bit1, i00 | bit0, i00 | bit0 | bit1};
+        Scalar a[4] = {psi[pos[0]], psi[pos[1]], psi[pos[2]], psi[pos[3]]};
+        for (idx r = 0; r < 4; ++r)
+            psi[pos[r]] = cmul_(u[r][0], a[0]) + cmul_(u[r][1], a[1]) +
+                          cmul_(u[r][2], a[2]) + cmul_(u[r][3], a[3]);
+    }
+}
+
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite state vector \a psi, general qudit case
+ *
+ * \note Processes each block of amplitudes coupled by \a A independently, so
+ * no copy of the state vector is made. Only the blocks for which all the
+ * shifted control values are equal to some \f$i > 0\f$, on which \f$A^i\f$
+ * acts, are visited; the other amplitudes are left untouched.
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param A Gate
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Control shifts, of the same size as \a ctrl
+ */
+template <typename Scalar>
+void apply_qudit_inplace(Scalar* psi, const dyn_mat<Scalar>& A,
+                         const std::vector<idx>& ctrl,
+                         const std::vector<idx>& target,
+                         const std::vector<idx>& dims,
+                         const std::vector<idx>& shift) {
+    idx n = dims.size();
+    idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
+    idx DA = static_cast<idx>(A.rows());
+
+    // strides of each subsystem in the state vector
+    idx Cstrides[internal::maxn];
+    Cstrides[n - 1] = 1;
+    for (idx k = n - 1; k > 0; --k)
+        Cstrides[k - 1] = Cstrides[k] * dims[k];
+
+    // offsets of the gate part
+    std::vector<idx> offsetsA(DA);
+    idx CdimsA[internal::maxn];
+    idx CmidxA[internal::maxn];
+    for (idx k = 0; k < target.size(); ++k)
+        CdimsA[k] = dims[target[k]];
+    for (idx m = 0; m < DA; ++m) {
+        internal::n2multiidx(m, target.size(), CdimsA, CmidxA);
+        offsetsA[m] = 0;
+        for (idx k = 0; k < target.size(); ++k)
+            offsetsA[m] += CmidxA[k] * Cstrides[target[k]];
+    }
+
+    // the gate powers A^i and the offsets of the control part; the control
+    // value i = 0 corresponds to the identity and is skipped
+    std::vector<dyn_mat<Scalar>> Ai;
+    std::vector<idx> offsetsCTRL;
+    if (ctrl.empty()) {
+        Ai.emplace_back(A);
+        offsetsCTRL.emplace_back(0);
+    } else {
+        for (idx i = 1; i < d; ++i) {
+            Ai.emplace_back(powm(A, i));
+            idx offset = 0;
+            for (idx k = 0; k < ctrl.size(); ++k)
+                offset += ((i + d - shift[k]) % d) * Cstrides[ctrl[k]];
+            offsetsCTRL.emplace_back(offset);
+        }
+    }
+
+    // the rest
+    std::vector<idx> ctrlgate = ctrl;
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+    std::vector<idx> ctrlgate_bar = complement(ctrlgate, n);
+    idx ctrlgate_barsize = ctrlgate_bar.size();
+    idx CdimsCTRLA_bar[internal::maxn];
+    idx DCTRLA_bar = 1;
+    for (idx k = 0; k < ctrlgate_barsize; ++k) {
+        CdimsCTRLA_bar[k] = dims[ctrlgate_bar[k]];
+        DCTRLA_bar *= dims[ctrlgate_bar[k]];
+    }
+    // for qubits, the bit positions of the control and gate part, in
+    // increasing order
+    bool is_qubit_system = internal::check_eq_dims(dims, 2);
+    std::vector<idx> ctrlgate_pos;
+    for (idx k = ctrlgate.size(); k-- > 0;)
+        ctrlgate_pos.emplace_back(n - 1 - ctrlgate[k]);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel
+#endif // HAS_OPENMP
+    {
+        std::vector<Scalar> v(DA);
+        idx CmidxCTRLA_bar[internal::maxn];
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp for
+#endif // HAS_OPENMP
+        for (idx r = 0; r < DCTRLA_bar; ++r) {
+            idx base = 0;
+            if (is_qubit_system)
+                base = insert_zero_bits(r, ctrlgate_pos.data(),
+                                        ctrlgate_pos.size());
+            else {
+                internal::n2multiidx(r, ctrlgate_barsize, CdimsCTRLA_bar,
+                                     CmidxCTRLA_bar);
+                for (idx k = 0; k < ctrlgate_barsize; ++k)
+                    base += CmidxCTRLA_bar[k] * Cstrides[ctrlgate_bar[k]];
+            }
+
+            for (idx i = 0; i < Ai.size(); ++i) {
+                Scalar* block = psi + base + offsetsCTRL[i];
+                for (idx m = 0; m < DA; ++m)
+                    v[m] = block[offsetsA[m]];
+                for (idx m = 0; m < DA; ++m) {
+                    Scalar coeff = 0;
+                    for (idx m_ = 0; m_ < DA; ++m_)
+                        coeff += cmul_(Ai[i](m, m_), v[m_]);
+                    block[offsetsA[m]] = coeff;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite state vector \a psi, dispatching to the qubit kernels
+ * whenever possible
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param D Dimension of the state vector
+ * \param A Gate
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Control shifts, of the same size as \a ctrl
+ */
+template <typename Scalar>
+void applyCTRL_inplace(Scalar* psi, idx D, const dyn_mat<Scalar>& A,
+                       const std::vector<idx>& ctrl,
+                       const std::vector<idx>& target,
+                       const std::vector<idx>& dims,
+                       const std::vector<idx>& shift) {
+    idx n = dims.size();
+    bool is_qubit_system = internal::check_eq_dims(dims, 2);
+
+    //************ qubit kernels ************//
+    if (is_qubit_system && target.size() <= 2) {
+        // qubit i is located at bit position n - 1 - i, and the gate is
+        // applied whenever all controls are in the state |1> (after the shift)
+        idx ctrl_mask = 0, ctrl_val = 0;
+        for (idx k = 0; k < ctrl.size(); ++k) {
+            idx bit = static_cast<idx>(1) << (n - 1 - ctrl[k]);
+            ctrl_mask |= bit;
+            if (shift[k] == 0)
+                ctrl_val |= bit;
+        }
+
+        if (target.size() == 1)
+            apply_qubit1_inplace(psi, D, A, n - 1 - target[0], ctrl_mask,
+                                 ctrl_val);
+        else
+            apply_qubit2_inplace(psi, D, A, n - 1 - target[0],
+                                 n - 1 - target[1], ctrl_mask, ctrl_val);
+    }
+    //************ general case ************//
+    else
+        apply_qudit_inplace(psi, A, ctrl, target, dims, shift);
+}
+
+/**
+ * \brief Multiplies in-place the multi-partite state vector \a psi by the
+ * diagonal gate with diagonal \a diag acting on the part \a target
+ *
+ * \note The state vector is swept in order by blocks of consecutive
+ * amplitudes, over which the index in \a diag of the lower qudits is
+ * tabulated once, so the inner loop is a plain elementwise product
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param D Dimension of the state vector
+ * \param diag Pointer to the diagonal elements of the gate
+ * \param target Subsystem indexes where the gate is applied
+ * \param dims Dimensions of the multi-partite system
+ */
+template <typename Scalar>
+void apply_diagonal_inplace(Scalar* psi, idx D, const Scalar* diag,
+                            const std::vector<idx>& target,
+                            const std::vector<idx>& dims) {
+    idx n = dims.size();
+
+    // strides of each subsystem in the state vector, and of each target in
+    // the diagonal
+    idx Cstrides[internal::maxn];
+    Cstrides[n - 1] = 1;
+    for (idx k = n - 1; k > 0; --k)
+        Cstrides[k - 1] = Cstrides[k] * dims[k];
+    std::vector<idx> diag_strides(target.size());
+    for (idx k = target.size(), stride = 1; k-- > 0;
+         stride *= dims[target[k]])
+        diag_strides[k] = stride;
+
+    // blocks of B amplitudes spanned by the lower qudits, chosen such that
+    // the table of the indexes in the diagonal stays in cache
+    idx B = 1;
+    for (idx k = n; k-- > 0 && B * dims[k] <= 4096;)
+        B *= dims[k];
+    std::vector<idx> lo(B, 0);
+    std::vector<idx> hi; // targets that are not among the lower qudits
+    for (idx k = 0; k < target.size(); ++k) {
+        if (Cstrides[target[k]] < B) {
+            for (idx b = 0; b < B; ++b)
+                lo[b] += ((b / Cstrides[target[k]]) % dims[target[k]]) *
+                         diag_strides[k];
+        } else
+            hi.emplace_back(k);
+    }
+    bool lo_empty = hi.size() == target.size();
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx h = 0; h < D / B; ++h) {
+        idx base = 0;
+        for (auto&& k : hi)
+            base += ((h * B / Cstrides[target[k]]) % dims[target[k]]) *
+                    diag_strides[k];
+        Scalar* p = psi + h * B;
+        if (lo_empty) {
+            Scalar phase = diag[base];
+            for (idx b = 0; b < B; ++b)
+                p[b] = cmul_(p[b], phase);
+        } else {
+            const Scalar* phases = diag + base;
+            for (idx b = 0; b < B; ++b)
+                p[b] = cmul_(p[b], phases[lo[b]]);
+        }
+    }
+}
+
+/**
+ * \brief Applies in-place the controlled permutation gate \a A, defined by
+ * \f$A|m\rangle = \mathrm{phases}[m]|\mathrm{perm}[m]\rangle\f$, to the
+ * part \a target of the multi-partite state vector \a psi
+ *
+ * \note Amplitudes are moved by index; they are multiplied by the phases
+ * only if \a phases is not null
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param perm Permutation of the basis states of the target
+ * \param phases Pointer to the phases of the gate, or nullptr if all of them
+ * are 1
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Control shifts, of the same size as \a ctrl
+ */
+template <typename Scalar>
+void apply_permutation_inplace(Scalar* psi, const std::vector<idx>& perm,
+                               const Scalar* phases,
+                               const std::vector<idx>& ctrl,
+                               const std::vector<idx>& target,
+                               const std::vector<idx>& dims,
+                               const std::vector<idx>& shift) {
+    idx n = dims.size();
+    idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
+    idx DA = perm.size();
+    bool is_qubit_system = internal::check_eq_dims(dims, 2);
+
+    // strides of each subsystem in the state vector
+    idx Cstrides[internal::maxn];
+    Cstrides[n - 1] = 1;
+    for (idx k = n - 1; k > 0; --k)
+        Cstrides[k - 1] = Cstrides[k] * dims[k];
+
+    // offsets of the gate part
+    std::vector<idx> offsetsA(DA);
+    idx CdimsA[internal::maxn];
+    idx CmidxA[internal::maxn];
+    for (idx k = 0; k < target.size(); ++k)
+        CdimsA[k] = dims[target[k]];
+    for (idx m = 0; m < DA; ++m) {
+        internal::n2multiidx(m, target.size(), CdimsA, CmidxA);
+        offsetsA[m] = 0;
+        for (idx k = 0; k < target.size(); ++k)
+            offsetsA[m] += CmidxA[k] * Cstrides[target[k]];
+    }
+
+    // the permutations and phases of the gate powers A^i, and the offsets of
+    // the control part; the control value i = 0 corresponds to the identity
+    // and is skipped
+    std::vector<std::vector<idx>> perms{perm};
+    std::vector<std::vector<Scalar>> phis;
+    if (phases)
+        phis.emplace_back(phases, phases + DA);
+    std::vector<idx> offsetsCTRL;
+    if (ctrl.empty())
+        offsetsCTRL.emplace_back(0);
+    else {
+        for (idx i = 1; i < d; ++i) {
+            if (i > 1) {
+                // A^i|m> = phases_{i-1}[m] A|perm_{i-1}[m]>
+                std::vector<idx> perm_i(DA);
+                for (idx m = 0; m < DA; ++m)
+                    perm_i[m] = perm[perms.back()[m]];
+                if (phases) {
+                    std::vector<Scalar> phi_i(DA);
+                    for (idx m = 0; m < DA; ++m)
+                        phi_i[m] = phis.back()[m] * phases[perms.back()[m]];
+                    phis.emplace_back(std::move(phi_i));
+                }
+                perms.emplace_back(std::move(perm_i));
+            }
+            idx offset = 0;
+            for (idx k = 0; k < ctrl.size(); ++k)
+                offset += ((i + d - shift[k]) % d) * Cstrides[ctrl[k]];
+            offsetsCTRL.emplace_back(offset);
+        }
+    }
+
+    // the rest
+    std::vector<idx> ctrlgate = ctrl;
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+    std::vector<idx> ctrlgate_bar = complement(ctrlgate, n);
+    idx ctrlgate_barsize = ctrlgate_bar.size();
+    idx CdimsCTRLA_bar[internal::maxn];
+    idx DCTRLA_bar = 1;
+    for (idx k = 0; k < ctrlgate_barsize; ++k) {
+        CdimsCTRLA_bar[k] = dims[ctrlgate_bar[k]];
+        DCTRLA_bar *= dims[ctrlgate_bar[k]];
+    }
+    // for qubits, the bit positions of the control and gate part, in
+    // increasing order
+    std::vector<idx> ctrlgate_pos;
+    for (idx k = ctrlgate.size(); k-- > 0;)
+        ctrlgate_pos.emplace_back(n - 1 - ctrlgate[k]);
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel
+#endif // HAS_OPENMP
+    {
+        std::vector<Scalar> v(DA);
+        idx CmidxCTRLA_bar[internal::maxn];
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp for
+#endif // HAS_OPENMP
+        for (idx r = 0; r < DCTRLA_bar; ++r) {
+            idx base = 0;
+            if (is_qubit_system)
+                base = insert_zero_bits(r, ctrlgate_pos.data(),
+                                        ctrlgate_pos.size());
+            else {
+                internal::n2multiidx(r, ctrlgate_barsize, CdimsCTRLA_bar,
+                                     CmidxCTRLA_bar);
+                for (idx k = 0; k < ctrlgate_barsize; ++k)
+                    base += CmidxCTRLA_bar[k] * Cstrides[ctrlgate_bar[k]];
+            }
+
+            for (idx i = 0; i < perms.size(); ++i) {
+                Scalar* block = psi + base + offsetsCTRL[i];
+                const idx* p = perms[i].data();
+                for (idx m = 0; m < DA; ++m)
+                    v[m] = block[offsetsA[m]];
+                if (phis.empty())
+                    for (idx m = 0; m < DA; ++m)
+                        block[offsetsA[p[m]]] = v[m];
+                else
+                    for (idx m = 0; m < DA; ++m)
+                        block[offsetsA[p[m]]] = cmul_(phis[i][m], v[m]);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Applies in-place one stage of the quantum Fourier transform, see
+ * qpp::internal::qft_stage_inplace(), to a row of \a B consecutive values of
+ * the lower register digits
+ *
+ * \param p Pointer to the first amplitude of the row for which the digit
+ * is 0
+ * \param d Subsystem dimensions
+ * \param step Stride of the digit
+ * \param S Stride of the least significant qudit of the register
+ * \param B Number of values of the lower register digits in the row
+ * \param tw_hi Phase of the first value of the lower register digits in the
+ * row
+ * \param lo Phases of the values of the lower register digits relative to
+ * the first one
+ * \param F Qudit Fourier gate, row-major, with the normalization factor
+ * \param work Workspace of 2 * \a d elements, used for qudits
+ * \param inverse Applies the adjoint of the stage
+ */
+template <typename Scalar>
+void qft_stage_row_(Scalar* p, idx d, idx step, idx S, idx B,
+                    const Scalar tw_hi, const Scalar* lo, const Scalar* F,
+                    Scalar* work, bool inverse) {
+    for (idx m = 0; m < B; ++m, p += S) {
+        const Scalar tw = cmul_(tw_hi, lo[m]); // omega_M^L
+        //************ qubits ************//
+        if (d == 2) {
+            const Scalar f = F[0]; // 1 / sqrt(2)
+            const Scalar tw_f = cmul_(tw, f);
+            Scalar* p1 = p + step;
+            for (idx s = 0; s < S; ++s) {
+                if (inverse) {
+                    Scalar a0 = cmul_(p[s], f);
+                    Scalar a1 = cmul_(p1[s], tw_f);
+                    p[s] = a0 + a1;
+                    p1[s] = a0 - a1;
+                } else {
+                    Scalar a0 = p[s];
+                    Scalar a1 = p1[s];
+                    p[s] = cmul_(a0 + a1, f);
+                    p1[s] = cmul_(a0 - a1, tw_f);
+                }
+            }
+            continue;
+        }
+        //************ qudits ************//
+        Scalar* a = work;
+        Scalar* w = work + d;
+        // phases w[y] = omega_M^(yL)
+        w[0] = 1;
+        for (idx y = 1; y < d; ++y)
+            w[y] = cmul_(w[y - 1], tw);
+        for (idx s = 0; s < S; ++s) {
+            for (idx x = 0; x < d; ++x)
+                a[x] = inverse ? cmul_(p[s + x * step], w[x]) : p[s + x * step];
+            for (idx y = 0; y < d; ++y) {
+                Scalar b = 0;
+                for (idx x = 0; x < d; ++x)
+                    b += cmul_(F[y * d + x], a[x]);
+                p[s + y * step] = inverse ? b : cmul_(b, w[y]);
+            }
+        }
+    }
+}
+
+template <typename Scalar>
+void qft_stage_inplace(Scalar* psi, idx D, idx d, idx k, idx S, idx i,
+                       bool inverse, bool conj) {
+    const double sign = (inverse != conj) ? -1 : 1;
+    idx M = 1; // d^(k-i), the phases are M-th roots of unity
+    for (idx m = i; m < k; ++m)
+        M *= d;
+    const idx Mq = M / d;        // number of values of the lower digits
+    const idx step = Mq * S;     // stride of the digit
+    const idx count = D / M / S; // number of values of the higher digits
+    const double r = 1. / std::sqrt(static_cast<double>(d));
+
+    // the M-th roots of unity split in two tables of about sqrt(Mq) entries,
+    // the lower digits are processed in rows of B values
+    idx B = 1;
+    while (B * B < Mq)
+        B *= d;
+    const idx row_count = Mq / B; // rows per value of the higher digits
+    std::vector<Scalar> lo(B), hi(row_count);
+    for (idx m = 0; m < B; ++m)
+        lo[m] = static_cast<Scalar>(
+            std::polar(1., sign * 2 * pi * static_cast<double>(m) / M));
+    for (idx m = 0; m < row_count; ++m)
+        hi[m] = static_cast<Scalar>(
+            std::polar(1., sign * 2 * pi * static_cast<double>(m * B) / M));
+    // qudit Fourier gate
+    std::vector<Scalar> F(d * d);
+    for (idx y = 0; y < d; ++y)
+        for (idx x = 0; x < d; ++x)
+            F[y * d + x] = static_cast<Scalar>(std::polar(
+                r, sign * 2 * pi * static_cast<double>((x * y) % d) / d));
+
+    // the rows are split in chunks of about 1024 amplitudes, the indexes being
+    // updated incrementally within a chunk
+    const idx rows = count * row_count;
+    const idx chunk = std::max(static_cast<idx>(1), 1024 / (B * S));
+    const idx num_chunks = (rows + chunk - 1) / chunk;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx c = 0; c < num_chunks; ++c) {
+        std::vector<Scalar> work(2 * d);
+        idx row = c * chunk;
+        const idx row_end = std::min(row + chunk, rows);
+        idx h = row / row_count, L_hi = row % row_count;
+        for (; row < row_end; ++row) {
+            qft_stage_row_(psi + (h * M + L_hi * B) * S, d, step, S, B,
+                           hi[L_hi], lo.data(), F.data(), work.data(),
+                           inverse);
+            if (++L_hi == row_count) {
+                L_hi = 0;
+                ++h;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Reverses in-place the order of the qudits of a register of \a k
+ * contiguous qudits of the state vector \a psi
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param D Dimension of the state vector
+ * \param d Subsystem dimensions
+ * \param k Number of qudits of the register
+ * \param S Stride of the least significant qudit of the register
+ */
+template <typename Scalar>
+void reverse_register_inplace(Scalar* psi, idx D, idx d, idx k, idx S) {
+    std::vector<idx> pw(k, 1); // d^m
+    for (idx m = 1; m < k; ++m)
+        pw[m] = pw[m - 1] * d;
+    const idx R = pw[k - 1] * d;  // dimension of the register
+    const idx count = D / R / S; // number of values of the higher qudits
+
+    // the values of the register are split in chunks, the value with the
+    // reversed digits being updated incrementally within a chunk
+    const idx chunk = 256;
+    const idx num_chunks = (R + chunk - 1) / chunk;
+
+#ifdef HAS_OPENMP
+// NOLINTNEXTLINE
+#pragma omp parallel for
+#endif // HAS_OPENMP
+    for (idx c = 0; c < num_chunks; ++c) {
+        idx x = c * chunk;
+        idx x_end = std::min(x + chunk, R);
+        std::vector<idx> digits(k); // digits of x, least significant first
+        idx rev = 0;
+        for (idx m = 0, rest = x; m < k; ++m, rest /= d) {
+            digits[m] = rest % d;
+            rev += digits[m] * pw[k - 1 - m];
+        }
+        for (; x < x_end; ++x) {
+            if (rev > x) {
+                for (idx h = 0; h < count; ++h) {
+                    Scalar* p = psi + (h * R + x) * S;
+                    Scalar* q = psi + (h * R + rev) * S;
+                    for (idx s = 0; s < S; ++s)
+                        std::swap(p[s], q[s]);
+                }
+            }
+            // increments x, and its reversed digits
+            for (idx m = 0; m < k; ++m) {
+                if (++digits[m] < d) {
+                    rev += pw[k - 1 - m];
+                    break;
+                }
+                digits[m] = 0;
+                rev -= (d - 1) * pw[k - 1 - m];
+            }
+        }
+    }
+}
+
+/**
+ * \brief Applies in-place the qudit quantum Fourier transform, or its
+ * inverse, to the part \a target of the multi-partite state vector \a psi
+ *
+ * \note The transform is computed as a batched radix-d fast Fourier
+ * transform over the target register, one stage per target qudit, see
+ * qpp::internal::qft_stage_inplace(). When the target qudits are not
+ * contiguous and in increasing order, they are first gathered at the end of
+ * a copy of the state vector, see qpp::internal::permute_subsys().
+ *
+ * \param psi Pointer to the state vector amplitudes
+ * \param n Number of subsystems
+ * \param d Subsystem dimensions
+ * \param target Subsystem indexes where the QFT is applied
+ * \param swap Swaps the qudits at the end
+ * \param inverse Applies the inverse quantum Fourier transform
+ * \param conj Applies the complex conjugate of the transform
+ */
+template <typename Scalar>
+void qft_inplace(Scalar* psi, idx n, idx d, const std::vector<idx>& target,
+                 bool swap, bool inverse, bool conj) {
+    idx k = target.size();
+    std::vector<idx> dims(n, d);
+    std::vector<idx> strides = subsys_strides(dims);
+    idx D = strides[0] * d;
+
+    bool contiguous = true;
+    for (idx i = 1; i < k; ++i)
+        if (target[i] != target[0] + i)
+            contiguous = false;
+
+    // a non-contiguous register is gathered into the last k subsystems of a
+    // copy of the state; the digit reversal is then folded into the gather
+    // (inverse) or scatter (forward) permutation instead of a separate pass
+    std::vector<Scalar> buffer;
+    Scalar* reg = psi;
+    idx S = contiguous ? strides[target[k - 1]] : 1;
+    std::vector<idx> subsys_bar;
+    if (!contiguous) {
+        std::vector<bool> is_target(n, false);
+        for (auto&& i : target)
+            is_target[i] = true;
+        for (idx i = 0; i < n; ++i)
+            if (!is_target[i])
+                subsys_bar.emplace_back(i);
+        std::vector<idx> perm = subsys_bar;
+        if (swap && inverse)
+            perm.insert(std::end(perm), target.rbegin(), target.rend());
+        else
+            perm.insert(std::end(perm), std::begin(target), std::end(target));
+        buffer.resize(D);
+        reg = buffer.data();
+        permute_subsys(psi, reg, dims, perm);
+    }
+
+    if (contiguous && swap && inverse)
+        reverse_register_inplace(reg, D, d, k, S);
+    for (idx i = 0; i < k; ++i)
+        qft_stage_inplace(reg, D, d, k, S, inverse ? k - 1 - i : i, inverse,
+                          conj);
+    if (contiguous && swap && !inverse)
+        reverse_register_inplace(reg, D, d, k, S);
+
+    if (!contiguous) {
+        std::vector<idx> perm = subsys_bar;
+        if (swap && !inverse)
+            perm.insert(std::end(perm), target.rbegin(), target.rend());
+        else
+            perm.insert(std::end(perm), std::begin(target), std::end(target));
+        std::vector<idx> inv_perm(n);
+        for (idx i = 0; i < n; ++i)
+            inv_perm[perm[i]] = i;
+        permute_subsys(reg, psi, dims, inv_perm);
+    }
+}
+
+/**
+ * \brief Applies in-place the qudit quantum Fourier transform, or its
+ * inverse, to the part \a target of the multi-partite state vector or
+ * density matrix \a A
+ *
+ * \note The density matrix is processed as the state vector of twice as many
+ * subsystems obtained by stacking its columns, the first half indexing its
+ * columns and the second half its rows. The transform is applied to the rows
+ * and its complex conjugate to the columns.
+ *
+ * \param A State vector or density matrix, overwritten with the result
+ * \param target Subsystem indexes where the QFT is applied
+ * \param d Subsystem dimensions
+ * \param swap Swaps the qudits at the end
+ * \param inverse Applies the inverse quantum Fourier transform
+ */
+template <typename Derived>
+void qft_inplace(Eigen::PlainObjectBase<Derived>& A,
+                 const std::vector<idx>& target, idx d, bool swap,
+                 bool inverse) {
+    Derived& rA = A.derived();
+    idx n = get_num_subsys(static_cast<idx>(rA.rows()), d);
+
+    if (rA.cols() == 1) {
+        qft_inplace(rA.data(), n, d, target, swap, inverse, false);
+        return;
+    }
+
+    std::vector<idx> row_target(target);
+    for (auto& i : row_target)
+        i += n;
+    qft_inplace(rA.data(), 2 * n, d, row_target, swap, inverse, false);
+    qft_inplace(rA.data(), 2 * n, d, target, swap, inverse, true);
+}
+
+} /* namespace internal */
+
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::applyCTRL()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target.
+ * Also, all control subsystems in \a ctrl must have the same dimension.
+ *
+ * \note Only the amplitudes for which the control condition holds are
+ * visited, e.g. a fraction \f$1/2^k\f$ of them for \f$k\f$ qubit controls;
+ * the other ones are left untouched. Qubit gates acting on one or two target
+ * qubits are applied by dedicated kernels.
+ *
+ * \param state State vector, overwritten with the result
+ * \param A Eigen expression
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ */
+template <typename Scalar, typename Derived>
+void applyCTRL_inplace(dyn_col_vect<Scalar>& state,
+                       const Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& ctrl,
+                       const std::vector<idx>& target,
+                       const std::vector<idx>& dims,
+                       std::vector<idx> shift = {}) {
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check types
+    if (!std::is_same<Scalar, typename Derived::Scalar>::value)
+        throw exception::TypeMismatch("qpp::applyCTRL_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check square matrix for the gate
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::applyCTRL_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, state))
+        throw exception::DimsMismatchCvector("qpp::applyCTRL_inplace()");
+
+    // check that ctrl subsystem is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(ctrl, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
+
+    // check that all control subsystems have the same dimension
+    idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
+    for (idx i = 1; i < ctrl.size(); ++i)
+        if (dims[ctrl[i]] != d)
+            throw exception::DimsNotEqual("qpp::applyCTRL_inplace()");
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
+
+    // check that gate matches the dimensions of the target
+    std::vector<idx> target_dims(target.size());
+    for (idx i = 0; i < target.size(); ++i)
+        target_dims[i] = dims[target[i]];
+    if (!internal::check_dims_match_mat(target_dims, rA))
+        throw exception::MatrixMismatchSubsys("qpp::applyCTRL_inplace()");
+
+    std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+
+    // check that ctrl + gate subsystem is valid
+    // with respect to local dimensions
+    if (!internal::check_subsys_match_dims(ctrlgate, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
+
+    // check shift
+    if (!shift.empty() && (shift.size() != ctrl.size()))
+        throw exception::SizeMismatch("qpp::applyCTRL_inplace()");
+    if (!shift.empty())
+        for (auto&& elem : shift)
+            if (elem >= d)
+                throw exception::OutOfRange("qpp::applyCTRL_inplace()");
+    // END EXCEPTION CHECKS
+
+    if (shift.empty())
+        shift = std::vector<idx>(ctrl.size(), 0);
+
+    idx D = static_cast<idx>(state.rows()); // total dimension
+    if (D == 1)
+        return;
+
+    internal::applyCTRL_inplace(state.data(), D, rA, ctrl, target, dims,
+                                shift);
+}
+
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::applyCTRL()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target.
+ * Also, all control subsystems in \a ctrl must have the same dimension.
+ *
+ * \param state State vector, overwritten with the result
+ * \param A Eigen expression
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param d Subsystem dimensions
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ */
+template <typename Scalar, typename Derived>
+void applyCTRL_inplace(dyn_col_vect<Scalar>& state,
+                       const Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& ctrl,
+                       const std::vector<idx>& target, idx d = 2,
+                       const std::vector<idx>& shift = {}) {
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    applyCTRL_inplace(state, A, ctrl, target, dims, shift);
+}
+
+/**
+ * \brief Applies in-place the gate \a A to the part \a target of the
+ * multi-partite state vector \a state
+ * \see qpp::apply()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target
+ *
+ * \param state State vector, overwritten with the result
+ * \param A Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ */
+template <typename Scalar, typename Derived>
+void apply_inplace(dyn_col_vect<Scalar>& state,
+                   const Eigen::MatrixBase<Derived>& A,
+                   const std::vector<idx>& target,
+                   const std::vector<idx>& dims) {
+    applyCTRL_inplace(state, A, {}, target, dims);
+}
+
+/**
+ * \brief Applies in-place the gate \a A to the part \a target of the
+ * multi-partite state vector \a state
+ * \see qpp::apply()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target
+ *
+ * \param state State vector, overwritten with the result
+ * \param A Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param d Subsystem dimensions
+ */
+template <typename Scalar, typename Derived>
+void apply_inplace(dyn_col_vect<Scalar>& state,
+                   const Eigen::MatrixBase<Derived>& A,
+                   const std::vector<idx>& target, idx d = 2) {
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::apply_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    applyCTRL_inplace(state, A, {}, target, dims);
+}
+
+/**
+ * \brief Applies in-place the controlled permutation gate
+ * \f$A|m\rangle = |\mathrm{perm}[m]\rangle\f$ to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::applyCTRL_inplace(), qpp::Gates::MODMUL_perm()
+ *
+ * \note The amplitudes are moved by index, so no matrix is involved and no
+ * multiplication is performed. The size of \a perm must match the dimension
+ * of \a target. Also, all control subsystems in \a ctrl must have the same
+ * dimension.
+ *
+ * \param state State vector, overwritten with the result
+ * \param perm Permutation of the basis states of the target
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ */
+template <typename Scalar>
+void applyCTRL_permutation_inplace(dyn_col_vect<Scalar>& state,
+                                   const std::vector<idx>& perm,
+                                   const std::vector<idx>& ctrl,
+                                   const std::vector<idx>& target,
+                                   const std::vector<idx>& dims,
+                                   std::vector<idx> shift = {}) {
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_permutation_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::applyCTRL_permutation_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL_permutation_inplace()");
+
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, state))
+        throw exception::DimsMismatchCvector(
+            "qpp::applyCTRL_permutation_inplace()");
+
+    // check that ctrl subsystem is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(ctrl, dims))
+        throw exception::SubsysMismatchDims(
+            "qpp::applyCTRL_permutation_inplace()");
+
+    // check that all control subsystems have the same dimension
+    idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
+    for (idx i = 1; i < ctrl.size(); ++i)
+        if (dims[ctrl[i]] != d)
+            throw exception::DimsNotEqual(
+                "qpp::applyCTRL_permutation_inplace()");
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims(
+            "qpp::applyCTRL_permutation_inplace()");
+
+    // check that the permutation is valid
+    if (!internal::check_perm(perm))
+        throw exception::PermInvalid("qpp::applyCTRL_permutation_inplace()");
+
+    // check that the permutation matches the dimensions of the target
+    idx DA = 1;
+    for (auto&& i : target)
+        DA *= dims[i];
+    if (perm.size() != DA)
+        throw exception::PermMismatchDims(
+            "qpp::applyCTRL_permutation_inplace()");
+
+    std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+
+    // check that ctrl + gate subsystem is valid
+    // with respect to local dimensions
+    if (!internal::check_subsys_match_dims(ctrlgate, dims))
+        throw exception::SubsysMismatchDims(
+            "qpp::applyCTRL_permutation_inplace()");
+
+    // check shift
+    if (!shift.empty() && (shift.size() != ctrl.size()))
+        throw exception::SizeMismatch("qpp::applyCTRL_permutation_inplace()");
+    if (!shift.empty())
+        for (auto&& elem : shift)
+            if (elem >= d)
+                throw exception::OutOfRange(
+                    "qpp::applyCTRL_permutation_inplace()");
+    // END EXCEPTION CHECKS
+
+    if (shift.empty())
+        shift = std::vector<idx>(ctrl.size(), 0);
+
+    idx D = static_cast<idx>(state.rows()); // total dimension
+    if (D == 1)
+        return;
+
+    internal::apply_permutation_inplace(state.data(), perm,
+                                        static_cast<const Scalar*>(nullptr),
+                                        ctrl, target, dims, shift);
+}
+
 /**
- * \brief Applies the controlled-gate \a A to the part \a target of the
- * multi-partite state vector or density matrix \a state
- * \see qpp::Gates::CTRL()
+ * \brief Applies in-place the controlled permutation gate
+ * \f$A|m\rangle = |\mathrm{perm}[m]\rangle\f$ to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::applyCTRL_inplace(), qpp::Gates::MODMUL_perm()
+ *
+ * \note The amplitudes are moved by index, so no matrix is involved and no
+ * multiplication is performed. The size of \a perm must match the dimension
+ * of \a target.
+ *
+ * \param state State vector, overwritten with the result
+ * \param perm Permutation of the basis states of the target
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate is applied
+ * \param d Subsystem dimensions
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ */
+template <typename Scalar>
+void applyCTRL_permutation_inplace(dyn_col_vect<Scalar>& state,
+                                   const std::vector<idx>& perm,
+                                   const std::vector<idx>& ctrl,
+                                   const std::vector<idx>& target, idx d = 2,
+                                   const std::vector<idx>& shift = {}) {
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_permutation_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyCTRL_permutation_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    applyCTRL_permutation_inplace(state, perm, ctrl, target, dims, shift);
+}
+
+/**
+ * \brief Applies in-place the permutation gate
+ * \f$A|m\rangle = |\mathrm{perm}[m]\rangle\f$ to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::apply_inplace(), qpp::Gates::MODMUL_perm()
+ *
+ * \note The amplitudes are moved by index, so no matrix is involved and no
+ * multiplication is performed. The size of \a perm must match the dimension
+ * of \a target.
+ *
+ * \param state State vector, overwritten with the result
+ * \param perm Permutation of the basis states of the target
+ * \param target Subsystem indexes where the gate is applied
+ * \param dims Dimensions of the multi-partite system
+ */
+template <typename Scalar>
+void apply_permutation_inplace(dyn_col_vect<Scalar>& state,
+                               const std::vector<idx>& perm,
+                               const std::vector<idx>& target,
+                               const std::vector<idx>& dims) {
+    applyCTRL_permutation_inplace(state, perm, {}, target, dims);
+}
+
+/**
+ * \brief Applies in-place the permutation gate
+ * \f$A|m\rangle = |\mathrm{perm}[m]\rangle\f$ to the part \a target of
+ * the multi-partite state vector \a state
+ * \see qpp::apply_inplace(), qpp::Gates::MODMUL_perm()
+ *
+ * \note The amplitudes are moved by index, so no matrix is involved and no
+ * multiplication is performed. The size of \a perm must match the dimension
+ * of \a target.
+ *
+ * \param state State vector, overwritten with the result
+ * \param perm Permutation of the basis states of the target
+ * \param target Subsystem indexes where the gate is applied
+ * \param d Subsystem dimensions
+ */
+template <typename Scalar>
+void apply_permutation_inplace(dyn_col_vect<Scalar>& state,
+                               const std::vector<idx>& perm,
+                               const std::vector<idx>& target, idx d = 2) {
+    applyCTRL_permutation_inplace(state, perm, {}, target, d);
+}
+
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite density matrix \a state
+ * \see qpp::applyCTRL()
  *
  * \note The dimension of the gate \a A must match the dimension of \a target.
  * Also, all control subsystems in \a ctrl must have the same dimension.
  *
- * \param state Eigen expression
+ * \note The density matrix is processed as the state vector of twice as many
+ * subsystems obtained by stacking its columns, the first half indexing its
+ * columns and the second half its rows. The gate is applied to the rows and
+ * its complex conjugate to the columns by the same kernels as for state
+ * vectors, so no copy of the density matrix is made.
+ *
+ * \param state Density matrix, overwritten with the result
  * \param A Eigen expression
  * \param ctrl Control subsystem indexes
  * \param target Subsystem indexes where the gate \a A is applied
@@ -50,75 +1226,70 @@ namespace qpp {
  * \param shift Performs the control as if the \a ctrl qudit states were
  * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
  * size of \a shift must be the same as the size of \a ctrl.
- * \return CTRL-A gate applied to the part \a target of \a state
  */
-template <typename Derived1, typename Derived2>
-dyn_mat<typename Derived1::Scalar>
-applyCTRL(const Eigen::MatrixBase<Derived1>& state,
-          const Eigen::MatrixBase<Derived2>& A, const std::vector<idx>& ctrl,
-          const std::vector<idx>& target, const std::vector<idx>& dims,
-          std::vector<idx> shift = {}) {
-    const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
-        state.derived();
-    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
+template <typename Scalar, typename Derived>
+void applyCTRL_inplace(dyn_mat<Scalar>& state,
+                       const Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& ctrl,
+                       const std::vector<idx>& target,
+                       const std::vector<idx>& dims,
+                       std::vector<idx> shift = {}) {
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
     // EXCEPTION CHECKS
 
     // check types
-    if (!std::is_same<typename Derived1::Scalar,
-                      typename Derived2::Scalar>::value)
-        throw exception::TypeMismatch("qpp::applyCTRL()");
+    if (!std::is_same<Scalar, typename Derived::Scalar>::value)
+        throw exception::TypeMismatch("qpp::applyCTRL_inplace()");
 
     // check zero sizes
     if (!internal::check_nonzero_size(rA))
-        throw exception::ZeroSize("qpp::applyCTRL()");
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
 
     // check zero sizes
-    if (!internal::check_nonzero_size(rstate))
-        throw exception::ZeroSize("qpp::applyCTRL()");
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
 
     // check zero sizes
     if (!internal::check_nonzero_size(target))
-        throw exception::ZeroSize("qpp::applyCTRL()");
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
 
     // check square matrix for the gate
     if (!internal::check_square_mat(rA))
-        throw exception::MatrixNotSquare("qpp::applyCTRL()");
+        throw exception::MatrixNotSquare("qpp::applyCTRL_inplace()");
 
-    // check valid state and matching dimensions
-    if (internal::check_cvector(rstate)) {
-        if (!internal::check_dims_match_cvect(dims, state))
-            throw exception::DimsMismatchCvector("qpp::applyCTRL()");
-    } else if (internal::check_square_mat(rstate)) {
-        if (!internal::check_dims_match_mat(dims, state))
-            throw exception::DimsMismatchMatrix("qpp::applyCTRL()");
-    } else
-        throw exception::MatrixNotSquareNorCvector("qpp::applyCTRL()");
+    // check square matrix for the state
+    if (!internal::check_square_mat(state))
+        throw exception::MatrixNotSquare("qpp::applyCTRL_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+
+    // check matching dimensions
+    if (!internal::check_dims_match_mat(dims, state))
+        throw exception::DimsMismatchMatrix("qpp::applyCTRL_inplace()");
 
     // check that ctrl subsystem is valid w.r.t. dims
     if (!internal::check_subsys_match_dims(ctrl, dims))
-        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
 
     // check that all control subsystems have the same dimension
     idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
     for (idx i = 1; i < ctrl.size(); ++i)
         if (dims[ctrl[i]] != d)
-            throw exception::DimsNotEqual("qpp::applyCTRL()");
-
-    // check that dimension is valid
-    if (!internal::check_dims(dims))
-        throw exception::DimsInvalid("qpp::applyCTRL()");
+            throw exception::DimsNotEqual("qpp::applyCTRL_inplace()");
 
     // check that target is valid w.r.t. dims
     if (!internal::check_subsys_match_dims(target, dims))
-        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
 
     // check that gate matches the dimensions of the target
     std::vector<idx> target_dims(target.size());
     for (idx i = 0; i < target.size(); ++i)
         target_dims[i] = dims[target[i]];
     if (!internal::check_dims_match_mat(target_dims, rA))
-        throw exception::MatrixMismatchSubsys("qpp::applyCTRL()");
+        throw exception::MatrixMismatchSubsys("qpp::applyCTRL_inplace()");
 
     std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
     ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
@@ -127,290 +1298,369 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
     // check that ctrl + gate subsystem is valid
     // with respect to local dimensions
     if (!internal::check_subsys_match_dims(ctrlgate, dims))
-        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
 
     // check shift
     if (!shift.empty() && (shift.size() != ctrl.size()))
-        throw exception::SizeMismatch("qpp::applyCTRL()");
+        throw exception::SizeMismatch("qpp::applyCTRL_inplace()");
     if (!shift.empty())
         for (auto&& elem : shift)
             if (elem >= d)
-                throw exception::OutOfRange("qpp::applyCTRL()");
+                throw exception::OutOfRange("qpp::applyCTRL_inplace()");
     // END EXCEPTION CHECKS
 
     if (shift.empty())
         shift = std::vector<idx>(ctrl.size(), 0);
 
-    // construct the table of A^i and (A^dagger)^i
-    std::vector<dyn_mat<typename Derived1::Scalar>> Ai;
-    std::vector<dyn_mat<typename Derived1::Scalar>> Aidagger;
-    for (idx i = 0; i < std::max(d, static_cast<idx>(2)); ++i) {
-        Ai.emplace_back(powm(rA, i));
-        Aidagger.emplace_back(powm(adjoint(rA), i));
-    }
+    idx D = static_cast<idx>(state.rows()); // total dimension
+    if (D == 1)
+        return;
 
-    idx D = static_cast<idx>(rstate.rows()); // total dimension
-    idx n = dims.size();                     // total number of subsystems
-    idx ctrlsize = ctrl.size();              // number of ctrl subsystem
-    idx ctrlgatesize = ctrlgate.size();      // number of ctrl+gate subsystems
-    idx targetsize = target.size(); // number of subsystems of the target
-    // dimension of ctrl subsystem
-    idx Dctrl = static_cast<idx>(std::llround(std::pow(d, ctrlsize)));
-    idx DA = static_cast<idx>(rA.rows()); // dimension of gate subsystem
-
-    idx Cdims[internal::maxn];          // local dimensions
-    idx CdimsA[internal::maxn];         // local dimensions
-    idx CdimsCTRL[internal::maxn];      // local dimensions
-    idx CdimsCTRLA_bar[internal::maxn]; // local dimensions
-
-    // compute the complementary subsystem of ctrlgate w.r.t. dims
-    std::vector<idx> ctrlgate_bar = complement(ctrlgate, n);
-    // number of subsystems that are complementary to the ctrl+gate
-    idx ctrlgate_barsize = ctrlgate_bar.size();
+    // subsystems of the stacked columns, the rows come last
+    idx n = dims.size();
+    std::vector<idx> dims_vec = dims;
+    dims_vec.insert(std::end(dims_vec), std::begin(dims), std::end(dims));
+    std::vector<idx> ctrl_rows = ctrl, target_rows = target;
+    for (auto& elem : ctrl_rows)
+        elem += n;
+    for (auto& elem : target_rows)
+        elem += n;
+
+    // A * state
+    internal::applyCTRL_inplace(state.data(), D * D, rA, ctrl_rows,
+                                target_rows, dims_vec, shift);
+    // (A * state) * adjoint(A)
+    internal::applyCTRL_inplace(state.data(), D * D,
+                                dyn_mat<Scalar>(rA.conjugate()), ctrl, target,
+                                dims_vec, shift);
+}
 
-    idx DCTRLA_bar = 1; // dimension of the rest
-    for (idx i = 0; i < ctrlgate_barsize; ++i)
-        DCTRLA_bar *= dims[ctrlgate_bar[i]];
+/**
+ * \brief Applies in-place the controlled-gate \a A to the part \a target of
+ * the multi-partite density matrix \a state
+ * \see qpp::applyCTRL()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target.
+ * Also, all control subsystems in \a ctrl must have the same dimension.
+ *
+ * \param state Density matrix, overwritten with the result
+ * \param A Eigen expression
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param d Subsystem dimensions
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ */
+template <typename Scalar, typename Derived>
+void applyCTRL_inplace(dyn_mat<Scalar>& state,
+                       const Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& ctrl,
+                       const std::vector<idx>& target, idx d = 2,
+                       const std::vector<idx>& shift = {}) {
+    // EXCEPTION CHECKS
 
-    for (idx k = 0; k < n; ++k)
-        Cdims[k] = dims[k];
-    for (idx k = 0; k < targetsize; ++k)
-        CdimsA[k] = dims[target[k]];
-    for (idx k = 0; k < ctrlsize; ++k)
-        CdimsCTRL[k] = d;
-    for (idx k = 0; k < ctrlgate_barsize; ++k)
-        CdimsCTRLA_bar[k] = dims[ctrlgate_bar[k]];
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
 
-    // worker, computes the coefficient and the index for the ket case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_ket =
-        [&](idx i_, idx m_,
-            idx r_) noexcept -> std::pair<typename Derived1::Scalar, idx> {
-        idx indx = 0;
-        typename Derived1::Scalar coeff = 0;
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+    // END EXCEPTION CHECKS
 
-        idx Cmidx[internal::maxn];          // the total multi-index
-        idx CmidxA[internal::maxn];         // the gate part multi-index
-        idx CmidxCTRLA_bar[internal::maxn]; // the rest multi-index
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
 
-        // compute the index
+    applyCTRL_inplace(state, A, ctrl, target, dims, shift);
+}
 
-        // set the CTRL part
-        for (idx k = 0; k < ctrlsize; ++k) {
-            Cmidx[ctrl[k]] = (i_ + d - shift[k]) % d;
-        }
+/**
+ * \brief Applies in-place the gate \a A to the part \a target of the
+ * multi-partite density matrix \a state
+ * \see qpp::apply()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target
+ *
+ * \param state Density matrix, overwritten with the result
+ * \param A Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ */
+template <typename Scalar, typename Derived>
+void apply_inplace(dyn_mat<Scalar>& state, const Eigen::MatrixBase<Derived>& A,
+                   const std::vector<idx>& target,
+                   const std::vector<idx>& dims) {
+    applyCTRL_inplace(state, A, {}, target, dims);
+}
 
-        // set the rest
-        internal::n2multiidx(r_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_bar);
-        for (idx k = 0; k < n - ctrlgatesize; ++k) {
-            Cmidx[ctrlgate_bar[k]] = CmidxCTRLA_bar[k];
-        }
+/**
+ * \brief Applies in-place the gate \a A to the part \a target of the
+ * multi-partite density matrix \a state
+ * \see qpp::apply()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target
+ *
+ * \param state Density matrix, overwritten with the result
+ * \param A Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param d Subsystem dimensions
+ */
+template <typename Scalar, typename Derived>
+void apply_inplace(dyn_mat<Scalar>& state, const Eigen::MatrixBase<Derived>& A,
+                   const std::vector<idx>& target, idx d = 2) {
+    // EXCEPTION CHECKS
 
-        // set the A part
-        internal::n2multiidx(m_, targetsize, CdimsA, CmidxA);
-        for (idx k = 0; k < targetsize; ++k) {
-            Cmidx[target[k]] = CmidxA[k];
-        }
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::apply_inplace()");
 
-        // we now got the total index
-        indx = internal::multiidx2n(Cmidx, n, Cdims);
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
 
-        // compute the coefficient
-        for (idx n_ = 0; n_ < DA; ++n_) {
-            internal::n2multiidx(n_, targetsize, CdimsA, CmidxA);
-            for (idx k = 0; k < targetsize; ++k) {
-                Cmidx[target[k]] = CmidxA[k];
-            }
-            coeff +=
-                Ai[i_](m_, n_) * rstate(internal::multiidx2n(Cmidx, n, Cdims));
-        }
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
 
-        return std::make_pair(coeff, indx);
-    }; /* end coeff_idx_ket */
-
-    // worker, computes the coefficient and the index
-    // for the density matrix case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_rho = [&](idx i1_, idx m1_, idx r1_, idx i2_, idx m2_,
-                             idx r2_) noexcept
-        -> std::tuple<typename Derived1::Scalar, idx, idx> {
-        idx idxrow = 0;
-        idx idxcol = 0;
-        typename Derived1::Scalar coeff = 0, lhs = 1, rhs = 1;
-
-        idx Cmidxrow[internal::maxn];          // the total row multi-index
-        idx Cmidxcol[internal::maxn];          // the total col multi-index
-        idx CmidxArow[internal::maxn];         // the gate part row multi-index
-        idx CmidxAcol[internal::maxn];         // the gate part col multi-index
-        idx CmidxCTRLrow[internal::maxn];      // the control row multi-index
-        idx CmidxCTRLcol[internal::maxn];      // the control col multi-index
-        idx CmidxCTRLA_barrow[internal::maxn]; // the rest row multi-index
-        idx CmidxCTRLA_barcol[internal::maxn]; // the rest col multi-index
-
-        // compute the ket/bra indexes
-
-        // set the CTRL part
-        internal::n2multiidx(i1_, ctrlsize, CdimsCTRL, CmidxCTRLrow);
-        internal::n2multiidx(i2_, ctrlsize, CdimsCTRL, CmidxCTRLcol);
-
-        for (idx k = 0; k < ctrlsize; ++k) {
-            Cmidxrow[ctrl[k]] = CmidxCTRLrow[k];
-            Cmidxcol[ctrl[k]] = CmidxCTRLcol[k];
-        }
+    applyCTRL_inplace(state, A, {}, target, dims);
+}
 
-        // set the rest
-        internal::n2multiidx(r1_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_barrow);
-        internal::n2multiidx(r2_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_barcol);
-        for (idx k = 0; k < n - ctrlgatesize; ++k) {
-            Cmidxrow[ctrlgate_bar[k]] = CmidxCTRLA_barrow[k];
-            Cmidxcol[ctrlgate_bar[k]] = CmidxCTRLA_barcol[k];
-        }
+/**
+ * \brief Applies in-place the channel specified by the set of Kraus
+ * operators \a Ks to the part \a target of the multi-partite density matrix
+ * \a state
+ * \see qpp::apply()
+ *
+ * \note The channel is applied as the superoperator
+ * \f$\sum_i K_i\otimes\bar{K_i}\f$ acting jointly on the rows and the
+ * columns of \a target, see qpp::applyCTRL_inplace(), so no copy of the
+ * density matrix is made
+ *
+ * \param state Density matrix, overwritten with the result
+ * \param Ks Set of Kraus operators
+ * \param target Subsystem indexes where the Kraus operators \a Ks are applied
+ * \param dims Dimensions of the multi-partite system
+ */
+inline void apply_inplace(cmat& state, const std::vector<cmat>& Ks,
+                          const std::vector<idx>& target,
+                          const std::vector<idx>& dims) {
+    // EXCEPTION CHECKS
 
-        // set the A part
-        internal::n2multiidx(m1_, targetsize, CdimsA, CmidxArow);
-        internal::n2multiidx(m2_, targetsize, CdimsA, CmidxAcol);
-        for (idx k = 0; k < target.size(); ++k) {
-            Cmidxrow[target[k]] = CmidxArow[k];
-            Cmidxcol[target[k]] = CmidxAcol[k];
-        }
+    // check zero sizes
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::apply_inplace()");
 
-        // we now got the total row/col indexes
-        idxrow = internal::multiidx2n(Cmidxrow, n, Cdims);
-        idxcol = internal::multiidx2n(Cmidxcol, n, Cdims);
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::apply_inplace()");
 
-        // check whether all CTRL row and col multi indexes are equal
-        bool all_ctrl_rows_equal = true;
-        bool all_ctrl_cols_equal = true;
+    // check square matrix for the state
+    if (!internal::check_square_mat(state))
+        throw exception::MatrixNotSquare("qpp::apply_inplace()");
 
-        idx first_ctrl_row, first_ctrl_col;
-        if (ctrlsize > 0) {
-            first_ctrl_row = (CmidxCTRLrow[0] + shift[0]) % d;
-            first_ctrl_col = (CmidxCTRLcol[0] + shift[0]) % d;
-        } else {
-            first_ctrl_row = first_ctrl_col = 1;
-        }
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::apply_inplace()");
+
+    // check matching dimensions
+    if (!internal::check_dims_match_mat(dims, state))
+        throw exception::DimsMismatchMatrix("qpp::apply_inplace()");
+
+    std::vector<idx> subsys_dims(target.size());
+    for (idx i = 0; i < target.size(); ++i)
+        subsys_dims[i] = dims[target[i]];
+
+    // check the Kraus operators
+    if (Ks.empty())
+        throw exception::ZeroSize("qpp::apply_inplace()");
+    if (!internal::check_square_mat(Ks[0]))
+        throw exception::MatrixNotSquare("qpp::apply_inplace()");
+    if (!internal::check_dims_match_mat(subsys_dims, Ks[0]))
+        throw exception::MatrixMismatchSubsys("qpp::apply_inplace()");
+    for (auto&& elem : Ks)
+        if (elem.rows() != Ks[0].rows() || elem.cols() != Ks[0].cols())
+            throw exception::DimsNotEqual("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx D = static_cast<idx>(state.rows()); // total dimension
+    idx DA = static_cast<idx>(Ks[0].rows());
+
+    // superoperator, acts on the rows then on the columns of the target
+    cmat S = cmat::Zero(DA * DA, DA * DA);
+    for (auto&& elem : Ks)
+        S += kron(elem, elem.conjugate());
+
+    // subsystems of the stacked columns, the rows come last
+    idx n = dims.size();
+    std::vector<idx> dims_vec = dims;
+    dims_vec.insert(std::end(dims_vec), std::begin(dims), std::end(dims));
+    std::vector<idx> target_vec = target;
+    for (auto& elem : target_vec)
+        elem += n;
+    target_vec.insert(std::end(target_vec), std::begin(target),
+                      std::end(target));
+
+    internal::applyCTRL_inplace(state.data(), D * D, S, {}, target_vec,
+                                dims_vec, {});
+}
+
+/**
+ * \brief Applies in-place the channel specified by the set of Kraus
+ * operators \a Ks to the part \a target of the multi-partite density matrix
+ * \a state
+ * \see qpp::apply()
+ *
+ * \param state Density matrix, overwritten with the result
+ * \param Ks Set of Kraus operators
+ * \param target Subsystem indexes where the Kraus operators \a Ks are applied
+ * \param d Subsystem dimensions
+ */
+inline void apply_inplace(cmat& state, const std::vector<cmat>& Ks,
+                          const std::vector<idx>& target, idx d = 2) {
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(state))
+        throw exception::ZeroSize("qpp::apply_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(state.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    apply_inplace(state, Ks, target, dims);
+}
+
+/**
+ * \brief Applies the controlled-gate \a A to the part \a target of the
+ * multi-partite state vector or density matrix \a state
+ * \see qpp::Gates::CTRL()
+ *
+ * \note The dimension of the gate \a A must match the dimension of \a target.
+ * Also, all control subsystems in \a ctrl must have the same dimension.
+ *
+ * \note The gate is applied to a copy of \a state by
+ * qpp::applyCTRL_inplace(), which only visits the amplitudes (or the matrix
+ * elements) for which the control condition holds
+ *
+ * \param state Eigen expression
+ * \param A Eigen expression
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ * \param shift Performs the control as if the \a ctrl qudit states were
+ * \f$X\f$-incremented component-wise by \a shift. If non-empty (default), the
+ * size of \a shift must be the same as the size of \a ctrl.
+ * \return CTRL-A gate applied to the part \a target of \a state
+ */
+template <typename Derived1, typename Derived2>
+dyn_mat<typename Derived1::Scalar>
+applyCTRL(const Eigen::MatrixBase<Derived1>& state,
+          const Eigen::MatrixBase<Derived2>& A, const std::vector<idx>& ctrl,
+          const std::vector<idx>& target, const std::vector<idx>& dims,
+          std::vector<idx> shift = {}) {
+    const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
+        state.derived();
+    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check types
+    if (!std::is_same<typename Derived1::Scalar,
+                      typename Derived2::Scalar>::value)
+        throw exception::TypeMismatch("qpp::applyCTRL()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check square matrix for the gate
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::applyCTRL()");
+
+    // check valid state and matching dimensions
+    if (internal::check_cvector(rstate)) {
+        if (!internal::check_dims_match_cvect(dims, state))
+            throw exception::DimsMismatchCvector("qpp::applyCTRL()");
+    } else if (internal::check_square_mat(rstate)) {
+        if (!internal::check_dims_match_mat(dims, state))
+            throw exception::DimsMismatchMatrix("qpp::applyCTRL()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::applyCTRL()");
 
-        for (idx k = 1; k < ctrlsize; ++k) {
-            if ((CmidxCTRLrow[k] + shift[k]) % d != first_ctrl_row) {
-                all_ctrl_rows_equal = false;
-                break;
-            }
-        }
-        for (idx k = 1; k < ctrlsize; ++k) {
-            if ((CmidxCTRLcol[k] + shift[k]) % d != first_ctrl_col) {
-                all_ctrl_cols_equal = false;
-                break;
-            }
-        }
+    // check that ctrl subsystem is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(ctrl, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
 
-        // at least one control activated, compute the coefficient
-        for (idx n1_ = 0; n1_ < DA; ++n1_) {
-            internal::n2multiidx(n1_, targetsize, CdimsA, CmidxArow);
-            for (idx k = 0; k < targetsize; ++k) {
-                Cmidxrow[target[k]] = CmidxArow[k];
-            }
-            idx idxrowtmp = internal::multiidx2n(Cmidxrow, n, Cdims);
+    // check that all control subsystems have the same dimension
+    idx d = !ctrl.empty() ? dims[ctrl[0]] : 1;
+    for (idx i = 1; i < ctrl.size(); ++i)
+        if (dims[ctrl[i]] != d)
+            throw exception::DimsNotEqual("qpp::applyCTRL()");
 
-            if (all_ctrl_rows_equal) {
-                lhs = Ai[first_ctrl_row](m1_, n1_);
-            } else {
-                lhs = (m1_ == n1_) ? 1 : 0; // identity matrix
-            }
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL()");
 
-            for (idx n2_ = 0; n2_ < DA; ++n2_) {
-                internal::n2multiidx(n2_, targetsize, CdimsA, CmidxAcol);
-                for (idx k = 0; k < targetsize; ++k) {
-                    Cmidxcol[target[k]] = CmidxAcol[k];
-                }
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
 
-                if (all_ctrl_cols_equal) {
-                    rhs = Aidagger[first_ctrl_col](n2_, m2_);
-                } else {
-                    rhs = (n2_ == m2_) ? 1 : 0; // identity matrix
-                }
+    // check that gate matches the dimensions of the target
+    std::vector<idx> target_dims(target.size());
+    for (idx i = 0; i < target.size(); ++i)
+        target_dims[i] = dims[target[i]];
+    if (!internal::check_dims_match_mat(target_dims, rA))
+        throw exception::MatrixMismatchSubsys("qpp::applyCTRL()");
 
-                idx idxcoltmp = internal::multiidx2n(Cmidxcol, n, Cdims);
+    std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
 
-                coeff += lhs * rstate(idxrowtmp, idxcoltmp) * rhs;
-            }
-        }
+    // check that ctrl + gate subsystem is valid
+    // with respect to local dimensions
+    if (!internal::check_subsys_match_dims(ctrlgate, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
 
-        return std::make_tuple(coeff, idxrow, idxcol);
-    }; /* end coeff_idx_rho */
+    // check shift
+    if (!shift.empty() && (shift.size() != ctrl.size()))
+        throw exception::SizeMismatch("qpp::applyCTRL()");
+    if (!shift.empty())
+        for (auto&& elem : shift)
+            if (elem >= d)
+                throw exception::OutOfRange("qpp::applyCTRL()");
+    // END EXCEPTION CHECKS
 
     //************ ket ************//
     if (internal::check_cvector(rstate)) // we have a ket
     {
-        // check that dims match state vector
-        if (!internal::check_dims_match_cvect(dims, rstate))
-            throw exception::DimsMismatchCvector("qpp::applyCTRL()");
-        if (D == 1)
-            return rstate;
-
-        dyn_mat<typename Derived1::Scalar> result = rstate;
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for collapse(2)
-#endif // HAS_OPENMP
-        for (idx m = 0; m < DA; ++m)
-            for (idx r = 0; r < DCTRLA_bar; ++r) {
-                if (ctrlsize == 0) // no control
-                {
-                    result(coeff_idx_ket(1, m, r).second) =
-                        coeff_idx_ket(1, m, r).first;
-                } else
-                    for (idx i = 0; i < d; ++i) {
-                        result(coeff_idx_ket(i, m, r).second) =
-                            coeff_idx_ket(i, m, r).first;
-                    }
-            }
+        dyn_col_vect<typename Derived1::Scalar> result = rstate;
+        applyCTRL_inplace(result, rA, ctrl, target, dims, shift);
 
         return result;
     }
-    //************ density matrix ************//
-    else // we have a density operator
-    {
-        // check that dims match state matrix
-        if (!internal::check_dims_match_mat(dims, rstate))
-            throw exception::DimsMismatchMatrix("qpp::applyCTRL()");
 
-        if (D == 1)
-            return rstate;
-
-        dyn_mat<typename Derived1::Scalar> result = rstate;
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for collapse(4)
-#endif // HAS_OPENMP
-        for (idx m1 = 0; m1 < DA; ++m1)
-            for (idx r1 = 0; r1 < DCTRLA_bar; ++r1)
-                for (idx m2 = 0; m2 < DA; ++m2)
-                    for (idx r2 = 0; r2 < DCTRLA_bar; ++r2)
-                        if (ctrlsize == 0) // no control
-                        {
-                            auto coeff_idxes =
-                                coeff_idx_rho(1, m1, r1, 1, m2, r2);
-                            result(std::get<1>(coeff_idxes),
-                                   std::get<2>(coeff_idxes)) =
-                                std::get<0>(coeff_idxes);
-                        } else {
-                            for (idx i1 = 0; i1 < Dctrl; ++i1)
-                                for (idx i2 = 0; i2 < Dctrl; ++i2) {
-                                    auto coeff_idxes =
-                                        coeff_idx_rho(i1, m1, r1, i2, m2, r2);
-                                    result(std::get<1>(coeff_idxes),
-                                           std::get<2>(coeff_idxes)) =
-                                        std::get<0>(coeff_idxes);
-                                }
-                        }
+    //************ density matrix ************//
+    dyn_mat<typename Derived1::Scalar> result = rstate;
+    applyCTRL_inplace(result, rA, ctrl, target, dims, shift);
 
-        return result;
-    }
+    return result;
 }
 
 /**
@@ -1368,28 +2618,7 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         Dsubsys *= dims[target[i]];
     idx Dsubsys_bar = D / Dsubsys;
 
-    idx Cdims[internal::maxn];
-    idx Csubsys[internal::maxn];
-    idx Cdimssubsys[internal::maxn];
-    idx Csubsys_bar[internal::maxn];
-    idx Cdimssubsys_bar[internal::maxn];
-
-    idx Cmidxcolsubsys_bar[internal::maxn];
-
     std::vector<idx> subsys_bar = complement(target, n);
-    std::copy(std::begin(subsys_bar), std::end(subsys_bar),
-              std::begin(Csubsys_bar));
-
-    for (idx i = 0; i < n; ++i) {
-        Cdims[i] = dims[i];
-    }
-    for (idx i = 0; i < n_subsys; ++i) {
-        Csubsys[i] = target[i];
-        Cdimssubsys[i] = dims[target[i]];
-    }
-    for (idx i = 0; i < n_subsys_bar; ++i) {
-        Cdimssubsys_bar[i] = dims[subsys_bar[i]];
-    }
 
     dyn_mat<typename Derived::Scalar> result =
         dyn_mat<typename Derived::Scalar>(Dsubsys_bar, Dsubsys_bar);
@@ -1405,51 +2634,44 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         if (target.empty())
             return rA * adjoint(rA);
 
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar {
-            // use static allocation for speed!
-            idx Cmidxrow[internal::maxn];
-            idx Cmidxcol[internal::maxn];
-            idx Cmidxrowsubsys_bar[internal::maxn];
-            idx Cmidxsubsys[internal::maxn];
-
-            /* get the row multi-indexes of the complement */
-            internal::n2multiidx(i, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < n_subsys_bar; ++k) {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a) {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, n_subsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < n_subsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]] =
-                        Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, n, Cdims)) *
-                      std::conj(rA(internal::multiidx2n(Cmidxcol, n, Cdims)));
+        // the state is viewed as a matrix with one column per basis state of
+        // the traced out subsystems, so the result is a single matrix
+        // product M * M^dagger
+        using map_t = Eigen::Map<const dyn_mat<typename Derived::Scalar>>;
+
+        // kept subsystems form the contiguous range [lo, hi)
+        idx lo = subsys_bar.front();
+        idx hi = subsys_bar.back() + 1;
+        if (hi - lo == n_subsys_bar) {
+            idx Dprefix = 1; // dimension of the subsystems before the range
+            for (idx i = 0; i < lo; ++i)
+                Dprefix *= dims[i];
+            idx Dsuffix = Dsubsys / Dprefix; // after the range
+
+            if (Dsuffix == 1) {
+                // (Dsubsys_bar x Dprefix) column major view, no copies
+                map_t M(rA.data(), Dsubsys_bar, Dprefix);
+                result.noalias() = M * M.adjoint();
+            } else {
+                // sum over the prefix of the (Dsubsys_bar x Dsuffix) views
+                result.setZero();
+                for (idx a = 0; a < Dprefix; ++a) {
+                    map_t M(rA.data() + a * Dsubsys_bar * Dsuffix, Dsuffix,
+                            Dsubsys_bar);
+                    result.noalias() += M.transpose() * M.conjugate();
+                }
             }
 
-            return sm;
-        }; /* end worker */
-
-        for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
-        {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxcolsubsys_bar);
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-            for (idx i = 0; i < Dsubsys_bar; ++i) {
-                result(i, j) = worker(i);
-            }
+            return result;
         }
+
+        // otherwise permutes the amplitudes in a (Dsubsys x Dsubsys_bar)
+        // column major matrix, traced out subsystems being the rows
+        std::vector<idx> perm = subsys_bar;
+        perm.insert(std::end(perm), std::begin(target), std::end(target));
+        dyn_mat<typename Derived::Scalar> M(Dsubsys, Dsubsys_bar);
+        internal::permute_subsys(rA.data(), M.data(), dims, perm);
+        result.noalias() = M.transpose() * M.conjugate();
     }
     //************ density matrix ************//
     else // we have a density operator
@@ -1462,49 +2684,29 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         if (target.empty())
             return rA;
 
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar {
-            // use static allocation for speed!
-            idx Cmidxrow[internal::maxn];
-            idx Cmidxcol[internal::maxn];
-            idx Cmidxrowsubsys_bar[internal::maxn];
-            idx Cmidxsubsys[internal::maxn];
-
-            /* get the row/col multi-indexes of the complement */
-            internal::n2multiidx(i, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < n_subsys_bar; ++k) {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a) {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, n_subsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < n_subsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]] =
-                        Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, n, Cdims),
-                         internal::multiidx2n(Cmidxcol, n, Cdims));
-            }
-
-            return sm;
-        }; /* end worker */
-
-        for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
-        {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxcolsubsys_bar);
+        // offsets of the basis states of the kept and of the traced out
+        // subsystems, result(i, j) is the sum over a of
+        // rA(offsets_subsys_bar[i] + offsets_subsys[a],
+        //    offsets_subsys_bar[j] + offsets_subsys[a])
+        std::vector<idx> strides = internal::subsys_strides(dims);
+        std::vector<idx> offsets_subsys =
+            internal::subsys_offsets(target, dims, strides);
+        std::vector<idx> offsets_subsys_bar =
+            internal::subsys_offsets(subsys_bar, dims, strides);
+
+        result.setZero();
 #ifdef HAS_OPENMP
 // NOLINTNEXTLINE
 #pragma omp parallel for
 #endif // HAS_OPENMP
-            for (idx i = 0; i < Dsubsys_bar; ++i) {
-                result(i, j) = worker(i);
+        // column major order for speed
+        for (idx j = 0; j < Dsubsys_bar; ++j) {
+            for (idx a = 0; a < Dsubsys; ++a) {
+                auto col =
+                    rA.col(offsets_subsys_bar[j] + offsets_subsys[a]).data() +
+                    offsets_subsys[a];
+                for (idx i = 0; i < Dsubsys_bar; ++i)
+                    result(i, j) += col[offsets_subsys_bar[i]];
             }
         }
     }
@@ -1595,16 +2797,18 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
 
     idx D = static_cast<idx>(rA.rows());
     idx n = dims.size();
-    idx n_subsys = target.size();
-    idx Cdims[internal::maxn];
-    idx Cmidxcol[internal::maxn];
-    idx Csubsys[internal::maxn];
 
-    // copy dims in Cdims and target in Csubsys
-    for (idx i = 0; i < n; ++i)
-        Cdims[i] = dims[i];
-    for (idx i = 0; i < n_subsys; ++i)
-        Csubsys[i] = target[i];
+    // the density matrix is viewed as a tensor of 2n subsystems, the column
+    // multi-index followed by the row multi-index; the partial transpose
+    // swaps the row and column subsystems of the target
+    std::vector<idx> dims2(2 * n), perm2(2 * n);
+    for (idx i = 0; i < n; ++i) {
+        dims2[i] = dims2[i + n] = dims[i];
+        perm2[i] = i;
+        perm2[i + n] = i + n;
+    }
+    for (auto&& i : target)
+        std::swap(perm2[i], perm2[i + n]);
 
     dyn_mat<typename Derived::Scalar> result(D, D);
 
@@ -1617,36 +2821,8 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
         if (target.empty())
             return rA * adjoint(rA);
 
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar {
-            // use static allocation for speed!
-            idx midxcoltmp[internal::maxn];
-            idx midxrow[internal::maxn];
-
-            for (idx k = 0; k < n; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, n, Cdims, midxrow);
-
-            for (idx k = 0; k < n_subsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, n, Cdims)) *
-                   std::conj(rA(internal::multiidx2n(midxcoltmp, n, Cdims)));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j) {
-            // compute the column multi-index
-            internal::n2multiidx(j, n, Cdims, Cmidxcol);
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
+        dyn_mat<typename Derived::Scalar> rho = rA * adjoint(rA);
+        internal::permute_subsys(rho.data(), result.data(), dims2, perm2);
     }
     //************ density matrix ************//
     else // we have a density operator
@@ -1657,36 +2833,7 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
         if (target.empty())
             return rA;
 
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar {
-            // use static allocation for speed!
-            idx midxcoltmp[internal::maxn];
-            idx midxrow[internal::maxn];
-
-            for (idx k = 0; k < n; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, n, Cdims, midxrow);
-
-            for (idx k = 0; k < n_subsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, n, Cdims),
-                      internal::multiidx2n(midxcoltmp, n, Cdims));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j) {
-            // compute the column multi-index
-            internal::n2multiidx(j, n, Cdims, Cmidxcol);
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
+        internal::permute_subsys(rA.data(), result.data(), dims2, perm2);
     }
 
     return result;
@@ -1783,86 +2930,22 @@ syspermute(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& perm,
     //************ ket ************//
     if (internal::check_cvector(rA)) // we have a column vector
     {
-        idx Cdims[internal::maxn];
-        idx Cperm[internal::maxn];
-
-        // copy dims in Cdims and perm in Cperm
-        for (idx i = 0; i < n; ++i) {
-            Cdims[i] = dims[i];
-            Cperm[i] = perm[i];
-        }
         result.resize(D, 1);
-
-        auto worker = [&Cdims, &Cperm, n](idx i) noexcept -> idx {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[internal::maxn];
-            idx midxtmp[internal::maxn];
-            idx permdims[internal::maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, n, Cdims, midx);
-
-            for (idx k = 0; k < n; ++k) {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];   // permuted multi-indexes
-            }
-
-            return internal::multiidx2n(midxtmp, n, permdims);
-        }; /* end worker */
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-        for (idx i = 0; i < D; ++i)
-            result(worker(i)) = rA(i);
+        internal::permute_subsys(rA.data(), result.data(), dims, perm);
     }
     //************ density matrix ************//
     else // we have a density operator
     {
-        idx Cdims[2 * internal::maxn];
-        idx Cperm[2 * internal::maxn];
-
-        // copy dims in Cdims and perm in Cperm
+        // the density matrix is viewed as a tensor of 2n subsystems, the
+        // column multi-index followed by the row multi-index
+        std::vector<idx> dims2(2 * n), perm2(2 * n);
         for (idx i = 0; i < n; ++i) {
-            Cdims[i] = dims[i];
-            Cdims[i + n] = dims[i];
-            Cperm[i] = perm[i];
-            Cperm[i + n] = perm[i] + n;
+            dims2[i] = dims2[i + n] = dims[i];
+            perm2[i] = perm[i];
+            perm2[i + n] = perm[i] + n;
         }
-        result.resize(D * D, 1);
-        // map A to a column vector
-        dyn_mat<typename Derived::Scalar> vectA =
-            Eigen::Map<dyn_mat<typename Derived::Scalar>>(
-                const_cast<typename Derived::Scalar*>(rA.data()), D * D, 1);
-
-        auto worker = [&Cdims, &Cperm, n](idx i) noexcept -> idx {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[2 * internal::maxn];
-            idx midxtmp[2 * internal::maxn];
-            idx permdims[2 * internal::maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, 2 * n, Cdims, midx);
-
-            for (idx k = 0; k < 2 * n; ++k) {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];   // permuted multi-indexes
-            }
-
-            return internal::multiidx2n(midxtmp, 2 * n, permdims);
-        }; /* end worker */
-
-#ifdef HAS_OPENMP
-// NOLINTNEXTLINE
-#pragma omp parallel for
-#endif // HAS_OPENMP
-        for (idx i = 0; i < D * D; ++i)
-            result(worker(i)) = rA(i);
-
-        result = reshape(result, D, D);
+        result.resize(D, D);
+        internal::permute_subsys(rA.data(), result.data(), dims2, perm2);
     }
 
     return result;
@@ -1907,6 +2990,11 @@ syspermute(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& perm,
 /**
  * \brief Applies the qudit quantum Fourier transform to the part \a target of
  * the multi-partite state vector or density matrix \a A
+ * \see qpp::applyQFT_inplace()
+ *
+ * \note The transform is computed in place on a copy of \a A, as a batched
+ * radix-d fast Fourier transform over the target register, see
+ * qpp::internal::qft_inplace()
  *
  * \param A Eigen expression
  * \param target Subsystem indexes where the QFT is applied
@@ -1951,54 +3039,7 @@ dyn_mat<typename Derived::Scalar> applyQFT(const Eigen::MatrixBase<Derived>& A,
     // END EXCEPTION CHECKS
 
     dyn_mat<typename Derived::Scalar> result = rA;
-
-    idx n_subsys = target.size();
-
-    if (d == 2) // qubits
-    {
-        for (idx i = 0; i < n_subsys; ++i) {
-            // apply Hadamard on qubit i
-            result = apply(result, Gates::get_instance().H, {target[i]});
-            // apply controlled rotations
-            for (idx j = 2; j <= n_subsys - i; ++j) {
-                // construct Rj
-                cmat Rj(2, 2);
-                Rj << 1, 0, 0, std::exp(2.0 * pi * 1_i / std::pow(2, j));
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]});
-            }
-        }
-        if (swap) {
-            // we have the qubits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAP,
-                               {target[i], target[n_subsys - i - 1]});
-            }
-        }
-
-    } else { // qudits
-        for (idx i = 0; i < n_subsys; ++i) {
-            // apply qudit Fourier on qudit i
-            result = apply(result, Gates::get_instance().Fd(d), {target[i]}, d);
-            // apply controlled rotations
-            for (idx j = 2; j <= n_subsys - i; ++j) {
-                // construct Rj
-                cmat Rj = cmat::Zero(d, d);
-                for (idx m = 0; m < d; ++m) {
-                    Rj(m, m) = std::exp(2.0 * pi * m * 1_i / std::pow(d, j));
-                }
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]}, d);
-            }
-        }
-        if (swap) {
-            // we have the qudits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAPd(d),
-                               {target[i], target[n_subsys - i - 1]}, d);
-            }
-        }
-    }
+    internal::qft_inplace(result, target, d, swap, false);
 
     return result;
 }
@@ -2007,6 +3048,11 @@ dyn_mat<typename Derived::Scalar> applyQFT(const Eigen::MatrixBase<Derived>& A,
 /**
  * \brief Applies the inverse (adjoint) qudit quantum Fourier transform to the
  * part \a target of the multi-partite state vector or density matrix \a A
+ * \see qpp::applyTFQ_inplace()
+ *
+ * \note The transform is computed in place on a copy of \a A, as a batched
+ * radix-d fast Fourier transform over the target register, see
+ * qpp::internal::qft_inplace()
  *
  * \param A Eigen expression
  * \param target Subsystem indexes where the TFQ is applied
@@ -2052,56 +3098,108 @@ dyn_mat<typename Derived::Scalar> applyTFQ(const Eigen::MatrixBase<Derived>& A,
     // END EXCEPTION CHECKS
 
     dyn_mat<typename Derived::Scalar> result = rA;
+    internal::qft_inplace(result, target, d, swap, true);
 
-    idx n_subsys = target.size();
+    return result;
+}
 
-    if (d == 2) // qubits
-    {
-        if (swap) {
-            // we have the qubits in reversed order, we must swap them
-            for (idx i = n_subsys / 2; i-- > 0;) {
-                result = apply(result, Gates::get_instance().SWAP,
-                               {target[i], target[n_subsys - i - 1]});
-            }
-        }
-        for (idx i = n_subsys; i-- > 0;) {
-            // apply controlled rotations
-            for (idx j = n_subsys - i + 1; j-- > 2;) {
-                // construct Rj
-                cmat Rj(2, 2);
-                Rj << 1, 0, 0, std::exp(-2.0 * pi * 1_i / std::pow(2, j));
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]});
-            }
-            // apply Hadamard on qubit i
-            result = apply(result, Gates::get_instance().H, {target[i]});
-        }
-    } else { // qudits
-        if (swap) {
-            // we have the qudits in reversed order, we must swap them
-            for (idx i = n_subsys / 2; i-- > 0;) {
-                result = apply(result, Gates::get_instance().SWAPd(d),
-                               {target[i], target[n_subsys - i - 1]}, d);
-            }
-        }
-        for (idx i = n_subsys; i-- > 0;) {
-            // apply controlled rotations
-            for (idx j = n_subsys - i + 1; j-- > 2;) {
-                // construct Rj
-                cmat Rj = cmat::Zero(d, d);
-                for (idx m = 0; m < d; ++m) {
-                    Rj(m, m) = std::exp(-2.0 * pi * m * 1_i / std::pow(d, j));
-                }
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]}, d);
-            }
-            // apply qudit Fourier on qudit i
-            result = apply(result, adjoint(Gates::get_instance().Fd(d)),
-                           {target[i]}, d);
-        }
-    }
+/**
+ * \brief Applies in-place the qudit quantum Fourier transform to the part
+ * \a target of the multi-partite state vector or density matrix \a state
+ * \see qpp::applyQFT()
+ *
+ * \param state State vector or density matrix, overwritten with the result
+ * \param target Subsystem indexes where the QFT is applied
+ * \param d Subsystem dimensions
+ * \param swap Swaps the qubits/qudits at the end (true by default)
+ */
+template <typename Derived>
+void applyQFT_inplace(Eigen::PlainObjectBase<Derived>& state,
+                      const std::vector<idx>& target, idx d = 2,
+                      bool swap = true) {
+    const Derived& rstate = state.derived();
 
-    return result;
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyQFT_inplace()");
+
+    // check valid subsystem dimension
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyQFT_inplace()");
+
+    // total number of qubits/qudits in the state
+    idx n = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::applyQFT_inplace()");
+
+    // check valid state and matching dimensions
+    if (internal::check_cvector(rstate)) {
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::applyQFT_inplace()");
+    } else if (internal::check_square_mat(rstate)) {
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::applyQFT_inplace()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::applyQFT_inplace()");
+    // END EXCEPTION CHECKS
+
+    internal::qft_inplace(state, target, d, swap, false);
+}
+
+/**
+ * \brief Applies in-place the inverse (adjoint) qudit quantum Fourier
+ * transform to the part \a target of the multi-partite state vector or
+ * density matrix \a state
+ * \see qpp::applyTFQ()
+ *
+ * \param state State vector or density matrix, overwritten with the result
+ * \param target Subsystem indexes where the TFQ is applied
+ * \param d Subsystem dimensions
+ * \param swap Swaps the qubits/qudits at the end (true by default)
+ */
+template <typename Derived>
+void applyTFQ_inplace(Eigen::PlainObjectBase<Derived>& state,
+                      const std::vector<idx>& target, idx d = 2,
+                      bool swap = true) {
+    const Derived& rstate = state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyTFQ_inplace()");
+
+    // check valid subsystem dimension
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyTFQ_inplace()");
+
+    // total number of qubits/qudits in the state
+    idx n = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::applyTFQ_inplace()");
+
+    // check valid state and matching dimensions
+    if (internal::check_cvector(rstate)) {
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::applyTFQ_inplace()");
+    } else if (internal::check_square_mat(rstate)) {
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::applyTFQ_inplace()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::applyTFQ_inplace()");
+    // END EXCEPTION CHECKS
+
+    internal::qft_inplace(state, target, d, swap, true);
 }
 
 // as in https://arxiv.org/abs/1707.08834
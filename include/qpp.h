@@ -52,6 +52,7 @@
 #include <chrono>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
@@ -73,6 +74,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -81,6 +83,11 @@
 #include <Eigen/Dense>
 #include <Eigen/SVD>
 
+// OpenMP header
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif // HAS_OPENMP
+
 // Quantum++ headers
 
 // do not change the order in this group, inter-dependencies
@@ -90,6 +97,7 @@
 #include "traits.hpp"
 #include "classes/idisplay.hpp"
 #include "internal/util.hpp"
+#include "internal/simd.hpp"
 #include "internal/classes/iomanip.hpp"
 #include "input_output.hpp"
 
@@ -0,0 +1,69 @@
+// Single and two-qubit gate kernels stress test on a pure state of n qubits
+// Optionally selects the kernel, "apply" (out-of-place qpp::apply()),
+// "scalar", "sse2", "avx2" or "avx512" (in-place qpp::apply_inplace() with the
+// given instruction set); by default uses the best instruction set available
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "qpp.h"
+
+int main(int argc, char** argv) {
+    using namespace qpp;
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Please specify the number of cores and qubits, and "
+                     "optionally the kernel!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int num_cores = std::stoi(argv[1]); // number of cores
+    idx n = std::stoi(argv[2]);         // number of qubits
+    omp_set_num_threads(num_cores);     // number of cores
+
+    std::string kernel = argc == 4 ? argv[3] : "";
+    bool out_of_place = false;
+    if (kernel == "apply")
+        out_of_place = true;
+    else if (kernel == "scalar")
+        internal::simd_isa() = internal::SimdISA::NONE;
+    else if (kernel == "sse2")
+        internal::simd_isa() = internal::SimdISA::SSE2;
+    else if (kernel == "avx2")
+        internal::simd_isa() = internal::SimdISA::AVX2;
+    else if (kernel == "avx512")
+        internal::simd_isa() = internal::SimdISA::AVX512;
+    else if (!kernel.empty()) {
+        std::cerr << "Unknown kernel " << kernel << "!\n";
+        exit(EXIT_FAILURE);
+    }
+    if (internal::simd_isa() > internal::simd_detect_isa()) {
+        std::cerr << "Kernel " << kernel << " not supported by the CPU!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<idx> qubits(n); // initial state
+    ket psi = mket(qubits);
+    cmat U = randU(4); // generic two-qubit gate
+
+    Timer<> t; // start timing
+    if (out_of_place) {
+        for (idx i = 0; i < n; ++i)
+            psi = apply(psi, gt.H, {i});
+        for (idx i = 0; i + 1 < n; ++i) {
+            psi = applyCTRL(psi, gt.X, {i}, {i + 1});
+            psi = apply(psi, U, {i + 1, i});
+        }
+    } else {
+        for (idx i = 0; i < n; ++i)
+            apply_inplace(psi, gt.H, {i});
+        for (idx i = 0; i + 1 < n; ++i) {
+            applyCTRL_inplace(psi, gt.X, {i}, {i + 1});
+            apply_inplace(psi, U, {i + 1, i});
+        }
+    }
+    std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+}
@@ -0,0 +1,39 @@
+// Partial trace stress test on a state vector of n qubits
+// Traces out the second half of the qubits, then every other qubit
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "qpp.h"
+
+int main(int argc, char** argv) {
+    using namespace qpp;
+    if (argc != 3) {
+        std::cerr << "Please specify the number of cores and qubits!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int num_cores = std::stoi(argv[1]);                     // number of cores
+    idx n = std::stoi(argv[2]);                             // number of qubits
+    idx D = static_cast<idx>(std::llround(std::pow(2, n))); // dimension 2^n
+    omp_set_num_threads(num_cores);                         // number of cores
+
+    ket randpsi = randket(D); // random state vector
+    // partial trace over the second half (contiguous kept qubits) and over
+    // every other qubit (non-contiguous kept qubits)
+    std::vector<idx> subsys_contiguous, subsys_interleaved;
+    for (idx i = 0; i < n / 2; ++i) {
+        subsys_contiguous.emplace_back(n - n / 2 + i);
+        subsys_interleaved.emplace_back(2 * i + 1);
+    }
+
+    Timer<> t; // start timing
+    ptrace(randpsi, subsys_contiguous);
+    ptrace(randpsi, subsys_interleaved);
+    std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+}
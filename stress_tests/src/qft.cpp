@@ -1,8 +1,14 @@
 // Quantum Fourier transform stress test on a pure state of n qubits
+// Optionally selects the implementation, "gates" (the gate sequence of the
+// circuit applied by qpp::apply() and qpp::applyCTRL()), "kernel" (the fast
+// Fourier transform kernel of qpp::applyQFT_inplace()) or "compare" (both,
+// followed by the norm of the difference of the results); by default times
+// the gate sequence
 
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -10,22 +16,9 @@
 
 #include "qpp.h"
 
-int main(int argc, char** argv) {
+// QFT applied gate by gate
+qpp::ket qft_gates(qpp::ket result, qpp::idx n) {
     using namespace qpp;
-    if (argc != 3) {
-        std::cerr << "Please specify the number of cores and qubits!\n";
-        exit(EXIT_FAILURE);
-    }
-
-    int num_cores = std::stoi(argv[1]); // number of cores
-    idx n = std::stoi(argv[2]);         // number of qubits
-    omp_set_num_threads(num_cores);     // number of cores
-
-    std::vector<idx> qubits(n); // initial state
-    ket psi = mket(qubits);
-    ket result = psi;
-
-    Timer<> t; // start timing
     for (idx i = 0; i < n; ++i) {
         result = apply(result, gt.H, {i}); // apply Hadamard on qubit i
         // apply controlled rotations
@@ -39,5 +32,47 @@ int main(int argc, char** argv) {
     for (idx i = 0; i < n / 2; ++i) {
         result = apply(result, gt.SWAP, {i, n - i - 1});
     }
-    std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    using namespace qpp;
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Please specify the number of cores and qubits, and "
+                     "optionally the implementation!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int num_cores = std::stoi(argv[1]); // number of cores
+    idx n = std::stoi(argv[2]);         // number of qubits
+    omp_set_num_threads(num_cores);     // number of cores
+
+    std::string impl = argc == 4 ? argv[3] : "gates";
+    if (impl != "gates" && impl != "kernel" && impl != "compare") {
+        std::cerr << "Unknown implementation " << impl << "!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // initial state
+    ket psi = randket(static_cast<idx>(std::llround(std::pow(2, n))));
+    std::vector<idx> target(n);
+    std::iota(std::begin(target), std::end(target), 0);
+
+    Timer<> t; // start timing
+    if (impl == "gates") {
+        ket result = qft_gates(psi, n);
+        std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+    } else if (impl == "kernel") {
+        applyQFT_inplace(psi, target);
+        std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+    } else {
+        ket result = qft_gates(psi, n);
+        double t_gates = t.toc().tics();
+        t.tic();
+        applyQFT_inplace(psi, target);
+        double t_kernel = t.toc().tics();
+        std::cout << num_cores << ", " << n << ", " << t_gates << ", "
+                  << t_kernel << ", " << norm(result - psi) << '\n';
+    }
 }
@@ -0,0 +1,42 @@
+// Clifford circuit stress test on n qubits, executed by the stabilizer engine
+// qpp::QStabilizerEngine: prepares the ring graph state, rotates every other
+// qubit to the X basis and samples the measurement outcomes of all qubits
+// Optionally sets the number of shots (1000 by default)
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <omp.h>
+
+#include "qpp.h"
+
+int main(int argc, char** argv) {
+    using namespace qpp;
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Please specify the number of cores and qubits, and "
+                     "optionally the number of shots!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int num_cores = std::stoi(argv[1]); // number of cores
+    idx n = std::stoi(argv[2]);         // number of qubits
+    omp_set_num_threads(num_cores);     // number of cores
+    idx shots = argc == 4 ? std::stoull(argv[3]) : 1000;
+
+    QCircuit qc{n, n};
+    qc.gate_fan(gt.H);
+    for (idx i = 0; i + 1 < n; ++i)
+        qc.gate(gt.CZ, i, i + 1);
+    if (n > 2)
+        qc.gate(gt.CZ, n - 1, 0);
+    for (idx i = 0; i < n; i += 2)
+        qc.gate(gt.H, i);
+    for (idx i = 0; i < n; ++i)
+        qc.measureZ(i, i);
+
+    Timer<> t; // start timing
+    QStabilizerEngine engine{qc};
+    engine.execute(shots);
+    std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+}
@@ -62,6 +62,178 @@ TEST(qpp_QCircuit_cCTRL_joint, AllTests) {}
 /// BEGIN const_iterator qpp::QCircuit::cend() const noexcept
 TEST(qpp_QCircuit_cend, AllTests) {}
 /******************************************************************************/
+/// BEGIN Program qpp::QCircuit::compile(bool fuse_diagonal) const
+TEST(qpp_QCircuit_compile, AllTests) {
+    using KT = QCircuit::KernelType;
+
+    QCircuit qc{3, 3};
+    qc.gate_fan(gt.H).CTRL(gt.X, 0, 1).measureZ(1, 0).cCTRL(gt.X, 0, 2);
+    qc.gate(gt.CNOT, 0, 2).measureV(gt.H, 0, 1).measureZ(2, 2, false);
+    qc.nop().reset(2);
+
+    auto program = qc.compile();
+    const auto& instructions = program.get_instructions();
+    // the fan gate is lowered to one instruction per qudit
+    EXPECT_EQ(qc.get_step_count() + 2, instructions.size());
+    EXPECT_EQ(0u, program.get_step_begin(0));
+    EXPECT_EQ(3u, program.get_step_begin(1));
+    EXPECT_EQ(instructions.size(),
+              program.get_step_begin(qc.get_step_count()));
+
+    // the controlled-X and the CNOT are permutation gates
+    std::vector<KT> kernels{KT::APPLY,       KT::APPLY,     KT::APPLY,
+                            KT::PERMUTATION, KT::MEASURE_Z, KT::APPLY_cCTRL,
+                            KT::PERMUTATION, KT::MEASURE_V, KT::MEASURE_Z,
+                            KT::NOP,         KT::RESET};
+    for (idx i = 0; i < kernels.size(); ++i)
+        EXPECT_EQ(kernels[i], instructions[i].kernel_);
+
+    // relative positions with respect to the measured qudits
+    EXPECT_EQ(std::vector<idx>({1}), instructions[3].target_);
+    EXPECT_EQ(std::vector<idx>({0}), instructions[3].ctrl_);
+    EXPECT_EQ(std::vector<idx>({1, 0}), *instructions[3].perm_);
+    EXPECT_EQ(nullptr, instructions[3].mat_);
+    EXPECT_EQ(std::vector<idx>({0, 1, 3, 2}), *instructions[6].perm_);
+    EXPECT_EQ(std::vector<idx>({1}), instructions[4].measured_);
+    EXPECT_EQ(std::vector<idx>({1}), instructions[5].target_);
+    EXPECT_EQ(std::vector<idx>({0, 1}), instructions[6].target_);
+    EXPECT_EQ(std::vector<idx>({0}), instructions[8].target_);
+    EXPECT_FALSE(instructions[8].destructive_);
+    EXPECT_EQ(std::vector<idx>({0}), instructions[10].target_);
+
+    // classically-controlled gates store the first d powers of the gate
+    EXPECT_EQ(std::vector<idx>({0}), instructions[5].ctrl_);
+    EXPECT_NEAR(0, norm(instructions[5].mat_[0] - gt.Id2), 1e-7);
+    EXPECT_NEAR(0, norm(instructions[5].mat_[1] - gt.X), 1e-7);
+
+    // same results as executing the steps one by one
+    for (idx seed = 0; seed < 5; ++seed) {
+        QEngine engine{qc}, engine_steps{qc};
+        rdevs.get_prng().seed(seed);
+        engine.execute();
+        rdevs.get_prng().seed(seed);
+        for (auto&& step : qc)
+            engine_steps.execute(step);
+        EXPECT_EQ(engine_steps.get_dits(), engine.get_dits());
+        EXPECT_EQ(engine_steps.get_measured(), engine.get_measured());
+        EXPECT_NEAR(0, norm(engine.get_psi() - engine_steps.get_psi()),
+                    1e-7);
+    }
+
+    // qudits, controlled gates with shifts acting on multiple targets
+    qc = QCircuit{4, 2, 3};
+    qc.gate_fan(gt.Fd(3)).CTRL(gt.Xd(3), {0, 1}, {2, 3}, {1, 2});
+    qc.measureZ(0, 0).cCTRL(gt.Zd(3), 0, {1, 3}, 1).measureZ({1, 2}, 1);
+    qc.cCTRL(gt.Xd(3), {0, 1}, 3);
+    program = qc.compile();
+    EXPECT_EQ(std::vector<idx>({2, 3}), program.get_instructions()[4].target_);
+    EXPECT_EQ(9u, program.get_instructions()[4].perm_->size());
+    EXPECT_EQ(std::vector<idx>({0, 2}), program.get_instructions()[6].target_);
+    for (idx seed = 0; seed < 5; ++seed) {
+        QEngine engine{qc}, engine_steps{qc};
+        rdevs.get_prng().seed(seed);
+        engine.execute();
+        rdevs.get_prng().seed(seed);
+        for (auto&& step : qc)
+            engine_steps.execute(step);
+        EXPECT_EQ(engine_steps.get_dits(), engine.get_dits());
+        EXPECT_NEAR(0, norm(engine.get_psi() - engine_steps.get_psi()),
+                    1e-7);
+    }
+
+    // permutation gates with phases
+    qc = QCircuit{3};
+    qc.gate_fan(gt.H).gate(gt.Y, 1).CTRL(gt.Y, {0, 2}, 1, {1, 0});
+    qc.gate(gt.TOF, 2, 0, 1).gate(gt.SWAP, 0, 2);
+    program = qc.compile();
+    for (idx i = 3; i < 6; ++i)
+        EXPECT_EQ(KT::PERMUTATION, program.get_instructions()[i].kernel_);
+    // swaps only relabel the qudits
+    EXPECT_EQ(KT::RELABEL, program.get_instructions()[6].kernel_);
+    EXPECT_NEAR(0,
+                norm(*program.get_instructions()[3].mat_ -
+                     gt.Y.transpose() * ket::Ones(2)),
+                1e-7);
+    EXPECT_EQ(nullptr, program.get_instructions()[5].mat_);
+    QEngine engine_perm{qc};
+    engine_perm.execute();
+    ket psi = kron(st.plus(), st.plus(), st.plus());
+    psi = apply(psi, gt.Y, {1});
+    psi = applyCTRL(psi, gt.Y, {0, 2}, {1}, 2, {1, 0});
+    psi = apply(psi, gt.TOF, {2, 0, 1});
+    psi = apply(psi, gt.SWAP, {0, 2});
+    EXPECT_NEAR(0, norm(engine_perm.get_psi() - psi), 1e-7);
+
+    // later instructions act on the relabeled positions, including the
+    // ones after the swaps of the quantum Fourier transform
+    qc = QCircuit{3, 1};
+    qc.gate(gt.SWAP, 0, 1).gate(gt.H, 0).QFT().gate(gt.X, 0).measureZ(1, 0);
+    qc.TFQ({0, 2}).gate(gt.Z, 2);
+    program = qc.compile();
+    kernels = {KT::RELABEL,   KT::APPLY, KT::QFT,     KT::PERMUTATION,
+               KT::MEASURE_Z, KT::TFQ,   KT::DIAGONAL};
+    ASSERT_EQ(kernels.size(), program.get_instructions().size());
+    for (idx i = 0; i < kernels.size(); ++i)
+        EXPECT_EQ(kernels[i], program.get_instructions()[i].kernel_);
+    EXPECT_EQ(std::vector<idx>({0, 1}), program.get_instructions()[0].target_);
+    EXPECT_EQ(std::vector<idx>({1}), program.get_instructions()[1].target_);
+    EXPECT_EQ(std::vector<idx>({1, 0, 2}),
+              program.get_instructions()[2].target_);
+    EXPECT_EQ(std::vector<idx>({2}), program.get_instructions()[3].target_);
+    EXPECT_EQ(std::vector<idx>({0}), program.get_instructions()[4].target_);
+    EXPECT_EQ(std::vector<idx>({0, 1}), program.get_instructions()[5].target_);
+    EXPECT_EQ(std::vector<idx>({1}), program.get_instructions()[6].target_);
+
+    // runs of consecutive diagonal gates are fused, on the union of their
+    // supports, and belong to the last step of the run
+    qc = QCircuit{3, 1};
+    qc.gate(gt.H, 0).gate(gt.T, 0).CTRL(gt.Z, 0, 2, 1).gate_fan(gt.S);
+    qc.gate(gt.H, 1).gate(gt.CZ, 1, 2).measureZ(1, 0).gate(gt.RZ(0.3), 2);
+    program = qc.compile();
+    kernels = {KT::APPLY,    KT::DIAGONAL,  KT::APPLY,
+               KT::DIAGONAL, KT::MEASURE_Z, KT::DIAGONAL};
+    ASSERT_EQ(kernels.size(), program.get_instructions().size());
+    for (idx i = 0; i < kernels.size(); ++i)
+        EXPECT_EQ(kernels[i], program.get_instructions()[i].kernel_);
+    EXPECT_EQ(1u, program.get_step_begin(3));
+    EXPECT_EQ(2u, program.get_step_begin(4));
+    EXPECT_EQ(3u, program.get_instructions()[1].ip_);
+    EXPECT_EQ(std::vector<idx>({0, 2, 1}),
+              program.get_instructions()[1].target_);
+    cmat diag = program.get_instructions()[1].mat_->col(0).asDiagonal();
+    EXPECT_NEAR(0,
+                norm(diag - kron(gt.S, gt.S, gt.S) *
+                                gt.CTRL(gt.Z, {0}, {1}, 3, 2, {1}) *
+                                kron(gt.T, gt.Id2, gt.Id2)),
+                1e-7);
+    EXPECT_EQ(std::vector<idx>({1}), program.get_instructions()[5].target_);
+
+    // not fused
+    program = qc.compile(false);
+    kernels = {KT::APPLY, KT::DIAGONAL, KT::DIAGONAL,  KT::DIAGONAL,
+               KT::APPLY, KT::DIAGONAL, KT::MEASURE_Z, KT::DIAGONAL};
+    ASSERT_EQ(kernels.size(), program.get_instructions().size());
+    for (idx i = 0; i < kernels.size(); ++i)
+        EXPECT_EQ(kernels[i], program.get_instructions()[i].kernel_);
+
+    // qudits, with controlled diagonal gates raised to the control value
+    qc = QCircuit{4, 1, 3};
+    qc.gate_fan(gt.Fd(3)).gate(gt.Zd(3), 1).CTRL(gt.Zd(3), {0, 2}, {1, 3},
+                                                   {1, 2});
+    qc.CTRL(adjoint(gt.Zd(3)), 3, 0, 1).measureZ(2, 0).gate(gt.Zd(3), 3);
+    for (idx seed = 0; seed < 5; ++seed) {
+        QEngine engine{qc}, engine_steps{qc};
+        rdevs.get_prng().seed(seed);
+        engine.execute();
+        rdevs.get_prng().seed(seed);
+        for (auto&& step : qc)
+            engine_steps.execute(step);
+        EXPECT_EQ(engine_steps.get_dits(), engine.get_dits());
+        EXPECT_NEAR(0, norm(engine.get_psi() - engine_steps.get_psi()),
+                    1e-7);
+    }
+}
+/******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::compress()
 TEST(qpp_QCircuit_compress, AllTests) {}
 /******************************************************************************/
@@ -101,6 +273,69 @@ TEST(qpp_QCircuit_end, Iterator) {}
 /// BEGIN const_iterator qpp::QCircuit::end() const noexcept
 TEST(qpp_QCircuit_end, ConstIterator) {}
 /******************************************************************************/
+/// BEGIN QCircuit& qpp::QCircuit::fuse(idx k = 2)
+TEST(qpp_QCircuit_fuse, AllTests) {
+    // 20 single qubit gates on the same wire fuse into a single gate
+    QCircuit qc{3};
+    for (idx i = 0; i < 20; ++i)
+        qc.gate(randU(), 1);
+    QCircuit qc_fused = qc;
+    qc_fused.fuse(1);
+    EXPECT_EQ(1u, qc_fused.get_gate_count());
+    EXPECT_EQ(1u, qc_fused.get_gate_count("FUSED"));
+
+    QEngine engine{qc}, engine_fused{qc_fused};
+    engine.execute();
+    engine_fused.execute();
+    EXPECT_NEAR(0, norm(engine.get_psi() - engine_fused.get_psi()), 1e-7);
+
+    // gates of all kinds, with measurements as fusion barriers
+    qc = QCircuit{5, 2};
+    qc.gate_fan(gt.H).CTRL(gt.X, 0, 1).gate(randU(), 1).CTRL(gt.Z, 1, {3, 4});
+    qc.CTRL(randU(), {0, 2}, 3, {1, 0}).gate(randU(4), 2, 4).gate(randU(8), 0,
+                                                                  1, 2);
+    qc.gate(gt.X, 3).measureZ(3, 0, false).cCTRL(gt.X, 0, 4).gate(randU(), 4);
+    qc.CTRL_joint(randU(4), {4}, {0, 2}).gate(gt.T, 0).nop().gate(gt.S, 0);
+    qc.measureZ({0, 1}, 1).gate(randU(), 2).CTRL(gt.X, 2, 4);
+
+    for (idx k = 1; k <= 4; ++k) {
+        qc_fused = fuse(qc, k);
+        EXPECT_LE(qc_fused.get_gate_count(), qc.get_gate_count());
+        EXPECT_EQ(qc.get_measurement_count(),
+                  qc_fused.get_measurement_count());
+        EXPECT_EQ(qc.get_nop_count(), qc_fused.get_nop_count());
+        EXPECT_EQ(qc.get_measured(), qc_fused.get_measured());
+        for (auto&& step : qc_fused) {
+            if (step.type_ == QCircuit::StepType::GATE &&
+                step.gates_ip_->name_ == "FUSED")
+                EXPECT_LE(step.gates_ip_->target_.size(), k);
+        }
+
+        // same random choices for the measurements
+        QEngine q_engine{qc}, q_engine_fused{qc_fused};
+        rdevs.get_prng().seed(k);
+        q_engine.execute();
+        rdevs.get_prng().seed(k);
+        q_engine_fused.execute();
+        EXPECT_EQ(q_engine.get_dits(), q_engine_fused.get_dits());
+        EXPECT_NEAR(0, norm(q_engine.get_psi() - q_engine_fused.get_psi()),
+                    1e-7);
+    }
+
+    // qudits
+    qc = QCircuit{3, 0, 3};
+    qc.gate(gt.Fd(3), 0).CTRL(gt.Xd(3), 0, 1).CTRL(gt.Zd(3), 1, 2, 2);
+    qc.gate(randU(3), 2).gate(randU(9), 0, 2);
+    EXPECT_EQ(3u, fuse(qc, 2).get_gate_count());
+    qc_fused = fuse(qc, 3);
+    EXPECT_EQ(1u, qc_fused.get_gate_count());
+    engine = QEngine{qc};
+    engine_fused = QEngine{qc_fused};
+    engine.execute();
+    engine_fused.execute();
+    EXPECT_NEAR(0, norm(engine.get_psi() - engine_fused.get_psi()), 1e-7);
+}
+/******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::gate(const cmat& U, idx i, idx j, idx k,
 ///       std::string name = {})
 TEST(qpp_QCircuit_gate, ThreeQudits) {}
@@ -236,11 +471,41 @@ TEST(qpp_QCircuit_operator_noneq, AllTests) {}
 TEST(qpp_QCircuit_operator_eq, AllTests) {}
 /******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::QFT(bool swap = true)
-TEST(qpp_QCircuit_QFT, AllQudits) {}
+TEST(qpp_QCircuit_QFT, AllQudits) {
+    // a single QFT step, executed by the FFT kernel
+    for (idx d : {2, 3}) {
+        QCircuit qc{3, 0, d};
+        qc.QFT();
+        EXPECT_EQ(1u, qc.get_step_count());
+        EXPECT_EQ(1u, qc.get_gate_count("QFT"));
+        ket psi = randket(static_cast<idx>(std::llround(std::pow(d, 3))));
+        QEngine engine{qc};
+        engine.set_psi(psi).execute();
+        EXPECT_NEAR(0, norm(engine.get_psi() - applyQFT(psi, {0, 1, 2}, d)),
+                    1e-7);
+    }
+}
 /******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::QFT(const std::vector<idx>& target,
 ///       bool swap = true)
-TEST(qpp_QCircuit_QFT, SpecificQudits) {}
+TEST(qpp_QCircuit_QFT, SpecificQudits) {
+    // without swaps the QFT is followed by explicit SWAP gates
+    QCircuit qc{4};
+    qc.QFT({3, 0, 1}, false);
+    EXPECT_EQ(1u, qc.get_gate_count("QFT"));
+    EXPECT_EQ(1u, qc.get_gate_count("SWAP"));
+    ket psi = randket(16);
+    QEngine engine{qc};
+    engine.set_psi(psi).execute();
+    ket expected = applyQFT(psi, {3, 0, 1}, 2, false);
+    EXPECT_NEAR(0, norm(engine.get_psi() - expected), 1e-7);
+
+    // the adjoint circuit is the inverse QFT
+    qc.add_circuit(adjoint(qc), 0);
+    engine = QEngine{qc};
+    engine.set_psi(psi).execute();
+    EXPECT_NEAR(0, norm(engine.get_psi() - psi), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::remove_clean_dit(idx target)
 TEST(qpp_QCircuit_remove_clean_dit, AllTests) {}
@@ -271,11 +536,34 @@ TEST(qpp_QCircuit_reset, SingleTarget) {}
 TEST(qpp_QCircuit_set_name, AllTests) {}
 /******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::TFQ(bool swap = true)
-TEST(qpp_QCircuit_TFQ, AllQudits) {}
+TEST(qpp_QCircuit_TFQ, AllQudits) {
+    for (idx d : {2, 3}) {
+        QCircuit qc{3, 0, d};
+        qc.TFQ();
+        EXPECT_EQ(1u, qc.get_step_count());
+        EXPECT_EQ(1u, qc.get_gate_count("TFQ"));
+        ket psi = randket(static_cast<idx>(std::llround(std::pow(d, 3))));
+        QEngine engine{qc};
+        engine.set_psi(psi).execute();
+        EXPECT_NEAR(0, norm(engine.get_psi() - applyTFQ(psi, {0, 1, 2}, d)),
+                    1e-7);
+    }
+}
 /******************************************************************************/
 /// BEGIN QCircuit& qpp::QCircuit::TFQ(const std::vector<idx>& target,
 ///       bool swap = true)
-TEST(qpp_QCircuit_TFQ, SpecificQudits) {}
+TEST(qpp_QCircuit_TFQ, SpecificQudits) {
+    // without swaps the inverse QFT is preceded by explicit SWAP gates
+    QCircuit qc{4};
+    qc.TFQ({3, 0, 1}, false);
+    EXPECT_EQ(1u, qc.get_gate_count("TFQ"));
+    EXPECT_EQ(1u, qc.get_gate_count("SWAP"));
+    ket psi = randket(16);
+    QEngine engine{qc};
+    engine.set_psi(psi).execute();
+    ket expected = applyTFQ(psi, {3, 0, 1}, 2, false);
+    EXPECT_NEAR(0, norm(engine.get_psi() - expected), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN std::string qpp::QCircuit::to_JSON(
 ///       bool enclosed_in_curly_brackets = true) const override
@@ -15,7 +15,74 @@ TEST(qpp_QEngine_execute, Iterator) {}
 TEST(qpp_QEngine_execute, ValueType) {}
 /******************************************************************************/
 /// BEGIN QEngine& qpp::QEngine::execute(idx reps = 1, bool clear_stats = true)
-TEST(qpp_QEngine_execute, AllCircuitWithRepetitions) {}
+TEST(qpp_QEngine_execute, AllCircuitWithRepetitions) {
+    // Bell state, both qubits measured
+    QCircuit qc{2, 2};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).measureZ(0, 0).measureZ(1, 1);
+    idx reps = 10000;
+
+    auto run = [&](std::mt19937::result_type seed) {
+        rdevs.get_prng().seed(seed);
+        QEngine engine{qc};
+        engine.execute(reps);
+        return engine.get_stats();
+    };
+
+    auto stats = run(12345);
+    EXPECT_EQ(2u, stats.size());
+    idx total = 0;
+    for (auto&& elem : stats) {
+        EXPECT_TRUE(elem.first == "0 0" || elem.first == "1 1");
+        total += elem.second;
+    }
+    EXPECT_EQ(reps, total);
+    EXPECT_NEAR(0.5, static_cast<double>(stats["0 0"]) / reps, 0.05);
+
+    // non-terminal measurement, repetitions are executed
+    qc = QCircuit{2, 2};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).measureZ(0, 0).gate(gt.X, 1);
+    qc.measureZ(1, 1);
+    stats = run(12345);
+    EXPECT_EQ(2u, stats.size());
+    EXPECT_EQ(reps, stats["0 1"] + stats["1 0"]);
+
+    // deterministic for a given seed and number of threads
+#ifdef HAS_OPENMP
+    int num_threads = omp_get_max_threads();
+    for (int nt : {1, 4}) {
+        omp_set_num_threads(nt);
+        EXPECT_EQ(run(42), run(42));
+    }
+    omp_set_num_threads(num_threads);
+#else
+    EXPECT_EQ(run(42), run(42));
+#endif // HAS_OPENMP
+
+    // terminal measurements, outcomes are sampled from the final state
+    QCircuit qc_terminal{3, 3};
+    qc_terminal.gate(gt.X, 1).gate(gt.H, 0).CTRL(gt.X, 0, 2).nop();
+    qc_terminal.measureZ(1, 1, false).measureZ({2, 1}, 0).measureZ(0, 2);
+    QEngine engine_terminal{qc_terminal};
+    engine_terminal.execute(reps);
+    auto stats_terminal = engine_terminal.get_stats();
+    EXPECT_EQ(2u, stats_terminal.size());
+    EXPECT_EQ(reps, stats_terminal["1 1 0"] + stats_terminal["3 1 1"]);
+    EXPECT_NEAR(0.5, static_cast<double>(stats_terminal["1 1 0"]) / reps,
+                0.05);
+    // the last repetition is executed
+    EXPECT_EQ(std::vector<idx>({0, 1, 2}), engine_terminal.get_measured());
+    std::vector<idx> dits = engine_terminal.get_dits();
+    EXPECT_EQ(1u, dits[1]);
+    EXPECT_EQ(2 * dits[2] + 1, dits[0]);
+
+    // accumulates the statistics when not clearing them
+    QEngine engine{qc};
+    engine.execute(reps).reset(false).execute(reps, false);
+    total = 0;
+    for (auto&& elem : engine.get_stats())
+        total += elem.second;
+    EXPECT_EQ(2 * reps, total);
+}
 /******************************************************************************/
 /// BEGIN const QEngine& qpp::QEngine::get_circuit() const& noexcept
 TEST(qpp_QEngine_get_circuit, Lvalue) {}
@@ -41,12 +108,102 @@ TEST(qpp_QEngine_get_non_measured, AllTests) {}
 /// BEGIN std::vector<double> qpp::QEngine::get_probs() const
 TEST(qpp_QEngine_get_probs, AllTests) {}
 /******************************************************************************/
-/// BEGIN ket qpp::QEngine::get_psi() const
-TEST(qpp_QEngine_get_psi, AllTests) {}
+/// BEGIN dyn_col_vect<Scalar> qpp::QEngine::get_psi() const
+TEST(qpp_QEngine_get_psi, AllTests) {
+    // swapped qudits are permuted back when the state is read
+    for (idx d : {2, 3}) {
+        QCircuit qc{4, 1, d};
+        qc.gate(gt.Fd(d), 0).CTRL(gt.Xd(d), 0, 1).gate(gt.SWAPd(d), 1, 3);
+        qc.QFT({0, 2, 3}).gate(gt.SWAPd(d), 0, 2).measureZ(3, 0);
+        qc.gate(gt.Fd(d), 1).TFQ({2, 0}).CTRL(gt.Xd(d), 2, 1);
+        ket psi = st.zero(4, d);
+        psi = apply(psi, gt.Fd(d), {0}, d);
+        psi = applyCTRL(psi, gt.Xd(d), {0}, {1}, d);
+        psi = apply(psi, gt.SWAPd(d), {1, 3}, d);
+        psi = applyQFT(psi, {0, 2, 3}, d);
+        psi = apply(psi, gt.SWAPd(d), {0, 2}, d);
+
+        // compiled, and one step at a time
+        for (bool steps : {false, true}) {
+            QEngine engine{qc};
+            if (steps)
+                for (auto&& step : qc)
+                    engine.execute(step);
+            else
+                engine.execute();
+            idx m = engine.get_dit(0);
+            // qudit 3 is measured in the state m, then discarded
+            ket expected = kron(gt.Id(d * d * d), adjoint(mket({m}, d))) * psi;
+            expected = apply(expected, gt.Fd(d), {1}, d);
+            expected = applyTFQ(expected, {2, 0}, d);
+            expected = applyCTRL(expected, gt.Xd(d), {2}, {1}, d);
+            expected /= norm(expected);
+            EXPECT_EQ(std::vector<idx>({3}), engine.get_measured());
+            EXPECT_NEAR(1, std::abs(engine.get_psi().dot(expected)), 1e-7);
+        }
+    }
+}
 /******************************************************************************/
 /// BEGIN std::map<std::string, idx, internal::EqualSameSizeStringDits>
 ///       qpp::QEngine::get_stats() const
-TEST(qpp_QEngine_get_stats, AllTests) {}
+TEST(qpp_QEngine_get_stats, AllTests) {
+    // joint measurement stored in a single classical dit
+    QCircuit qc{3, 2};
+    qc.gate(gt.X, 0).gate(gt.X, 2).measureZ({0, 1}, 0).measureZ(2, 1);
+    QEngine engine{qc};
+    engine.execute(10);
+    auto stats = engine.get_stats();
+    EXPECT_EQ(1u, stats.size());
+    EXPECT_EQ(10u, stats["2 1"]);
+
+    // classical dit set beyond the qudit dimension
+    QCircuit qc_set{1, 2};
+    qc_set.measureZ(0, 0);
+    QEngine engine_set{qc_set};
+    engine_set.set_dit(1, 7).execute(10);
+    stats = engine_set.get_stats();
+    EXPECT_EQ(1u, stats.size());
+    EXPECT_EQ(10u, stats["0 7"]);
+}
+/******************************************************************************/
+/// BEGIN const std::unordered_map<idx, idx>&
+///       qpp::QEngine::get_stats_packed() const
+TEST(qpp_QEngine_get_stats_packed, AllTests) {
+    QCircuit qc{3, 2};
+    qc.gate(gt.X, 0).gate(gt.X, 2).measureZ({0, 1}, 0).measureZ(2, 1);
+    QEngine engine{qc};
+    EXPECT_EQ(std::vector<idx>({4, 2}), engine.get_stats_dims());
+    engine.execute(10);
+    auto packed = engine.get_stats_packed();
+    EXPECT_EQ(1u, packed.size());
+    EXPECT_EQ(10u, packed[multiidx2n({2, 1}, engine.get_stats_dims())]);
+
+    // outcomes that do not fit are only reported by get_stats()
+    QCircuit qc_set{1, 2};
+    qc_set.measureZ(0, 0);
+    QEngine engine_set{qc_set};
+    engine_set.set_dit(1, 7).execute(10);
+    EXPECT_TRUE(engine_set.get_stats_packed().empty());
+
+    // packed dits that do not fit in an idx
+    QCircuit qc_wide{1, 65};
+    qc_wide.measureZ(0, 64);
+    QEngine engine_wide{qc_wide};
+    EXPECT_TRUE(engine_wide.get_stats_dims().empty());
+    engine_wide.execute(10);
+    EXPECT_TRUE(engine_wide.get_stats_packed().empty());
+    EXPECT_EQ(1u, engine_wide.get_stats().size());
+}
+/******************************************************************************/
+/// BEGIN std::vector<idx> qpp::QEngine::get_stats_dims() const
+TEST(qpp_QEngine_get_stats_dims, AllTests) {
+    QCircuit qc{2, 3, 3};
+    qc.measureZ(0, 1, false).measureV(gt.Id(9), {0, 1}, 0);
+    QEngine engine{qc};
+    EXPECT_EQ(std::vector<idx>({9, 3, 3}), engine.get_stats_dims());
+    engine.execute(10);
+    EXPECT_EQ(10u, engine.get_stats_packed().at(0));
+}
 /******************************************************************************/
 /// BEGIN QEngine& qpp::QEngine::reset(bool reset_stats = true)
 TEST(qpp_QEngine_reset, AllTests) {}
@@ -60,14 +217,100 @@ TEST(qpp_QEngine_set_dit, AllTests) {}
 /// BEGIN QEngine& qpp::QEngine::set_dits(std::vector<idx> dits)
 TEST(qpp_QEngine_set_dits, AllTests) {}
 /******************************************************************************/
-/// BEGIN QEngine& qpp::QEngine::set_psi(const ket& psi)
+/// BEGIN QEngine& qpp::QEngine::set_psi(const dyn_col_vect<Scalar>& psi)
 TEST(qpp_QEngine_set_psi, AllTests) {}
 /******************************************************************************/
 /// BEGIN std::string qpp::QEngine::to_JSON(
 ///       bool enclosed_in_curly_brackets = true) const override
 TEST(qpp_QEngine_to_JSON, AllTests) {}
 /******************************************************************************/
+/// BEGIN template <typename Scalar> class qpp::QEngineT
+TEST(qpp_QEngineT, SinglePrecision) {
+    using fcplx = std::complex<float>;
+    for (idx d : {2, 3}) {
+        QCircuit qc{4, 3, d};
+        qc.gate_fan(gt.Fd(d)).CTRL(gt.Xd(d), {0, 2}, 3);
+        qc.gate(gt.SWAPd(d), 1, 3).QFT({0, 2, 3}).gate(gt.Zd(d), 2);
+        qc.gate(gt.Zd(d), 3).gate(randU(d * d), 0, 1).TFQ({1, 3});
+
+        // compiled, and one step at a time
+        for (bool steps : {false, true}) {
+            QEngine engine{qc};
+            QEngineT<fcplx> engine_float{qc};
+            if (steps)
+                for (auto&& step : qc) {
+                    engine.execute(step);
+                    engine_float.execute(step);
+                }
+            else {
+                engine.execute();
+                engine_float.execute();
+            }
+            dyn_col_vect<fcplx> psi = engine_float.get_psi();
+            EXPECT_NEAR(0, norm(engine.get_psi() - psi.cast<cplx>()), 1e-5);
+        }
+
+        // measurements with deterministic outcomes
+        QCircuit qc_measured{3, 3, d};
+        qc_measured.gate(gt.Xd(d), 0).measureZ(0, 0).cCTRL(gt.Xd(d), 0, 1);
+        qc_measured.gate(gt.Fd(d), 2).measureV(gt.Fd(d), 2, 1);
+        qc_measured.reset(1).measureZ(1, 2, false);
+        QEngineT<fcplx> engine_float{qc_measured};
+        engine_float.execute(10);
+        EXPECT_EQ(std::vector<idx>({1, 0, 0}), engine_float.get_dits());
+        EXPECT_NEAR(1, engine_float.get_probs()[1], 1e-5);
+        EXPECT_EQ(std::vector<idx>({0, 2}), engine_float.get_measured());
+        EXPECT_EQ(10u, engine_float.get_stats().at("1 0 0"));
+    }
+}
+/******************************************************************************/
 
+/******************************************************************************/
+/// BEGIN QNoisyEngine& qpp::QNoisyEngine::execute(idx reps = 1,
+///       bool clear_stats = true) override
+TEST(qpp_QNoisyEngine_execute, AllCircuitWithRepetitions) {
+    QCircuit qc{2, 2};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).nop().measureZ(0, 0).measureZ(1, 1);
+    QubitBitFlipNoise noise{0.1};
+    idx reps = 1000;
+    auto& rdevs = RandomDevices::get_thread_local_instance();
+
+    auto run = [&](std::mt19937::result_type seed) {
+        rdevs.get_prng().seed(seed);
+        QNoisyEngine<QubitBitFlipNoise> engine{qc, noise};
+        engine.execute(reps);
+        return std::make_pair(engine.get_stats(), engine.get_noise_results());
+    };
+
+    // the noise results of all repetitions are recorded, in order
+    auto result = run(42);
+    idx total = 0;
+    for (auto&& elem : result.first)
+        total += elem.second;
+    EXPECT_EQ(reps, total);
+    EXPECT_EQ(5u, result.second.size());
+    for (idx i = 0; i < 3; ++i)
+        EXPECT_EQ(2 * reps, result.second[i].size());
+    EXPECT_TRUE(result.second[3].empty());
+    EXPECT_TRUE(result.second[4].empty());
+    // the results differ whenever an odd number among the 4 bit flips that
+    // do not leave the Bell state invariant occurs, i.e. with probability
+    // (1 - (1 - 2 * 0.1)^4) / 2
+    double p = static_cast<double>(result.first["0 1"] + result.first["1 0"]);
+    EXPECT_NEAR((1 - std::pow(0.8, 4)) / 2, p / reps, 0.05);
+
+    // deterministic for a given seed and number of threads
+#ifdef HAS_OPENMP
+    int num_threads = omp_get_max_threads();
+    for (int nt : {1, 4}) {
+        omp_set_num_threads(nt);
+        EXPECT_EQ(run(42), run(42));
+    }
+    omp_set_num_threads(num_threads);
+#else
+    EXPECT_EQ(run(42), run(42));
+#endif // HAS_OPENMP
+}
 /******************************************************************************/
 /// BEGIN QNoisyEngine& qpp::QNoisyEngine::execute(
 ///       const QCircuit::iterator::value_type& elem) override
@@ -77,3 +320,323 @@ TEST(qpp_QNoisyEngine_execute, ValueType) {}
 ///       qpp::QNoisyEngine::get_noise_results() const
 TEST(qpp_QNoisyEngine_get_noise_results, AllTests) {}
 /******************************************************************************/
+
+/******************************************************************************/
+/// BEGIN QDensityEngine& qpp::QDensityEngine::execute()
+TEST(qpp_QDensityEngine_execute, AllCircuit) {
+    // noiseless, compare with the state vector evolution
+    QCircuit qc{3};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).gate(gt.RY(0.3), 2).CTRL(gt.Z, 2, 0);
+    qc.gate_fan(gt.T).CTRL(gt.X, {0, 2}, {1}, {1, 0});
+    QEngine engine{qc};
+    engine.execute();
+    QDensityEngine density_engine{qc};
+    density_engine.execute();
+    EXPECT_NEAR(0, norm(density_engine.get_rho() - prj(engine.get_psi())),
+                1e-7);
+    EXPECT_TRUE(density_engine.get_stats().empty());
+
+    // mid-circuit measurement and classically-controlled gate
+    qc = QCircuit{3, 3};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).measureZ(0, 0).cCTRL(gt.X, 0, 1);
+    qc.gate(gt.H, 2).measureZ(2, 2, false).measureV(gt.H, 1, 1);
+    density_engine = QDensityEngine{qc};
+    density_engine.execute();
+    auto stats = density_engine.get_stats();
+    EXPECT_EQ(8u, stats.size());
+    for (auto&& elem : stats)
+        EXPECT_NEAR(0.125, elem.second, 1e-7);
+    EXPECT_EQ(std::vector<idx>({0, 1}), density_engine.get_measured());
+    EXPECT_NEAR(0, norm(density_engine.get_rho() - gt.Id2 / 2), 1e-7);
+
+    // reset, discard and joint measurement of qutrits
+    qc = QCircuit{3, 1, 3};
+    qc.gate(gt.Xd(3), 0).reset(0).gate(gt.Fd(3), 1).discard(1);
+    qc.gate(gt.Xd(3), 2).measureZ({2, 0}, 0);
+    density_engine = QDensityEngine{qc};
+    density_engine.execute();
+    stats = density_engine.get_stats();
+    EXPECT_EQ(1u, stats.size());
+    EXPECT_NEAR(1, stats["3"], 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template <typename NoiseModel>
+///       explicit qpp::QDensityEngine::QDensityEngine(const QCircuit& qc,
+///       const NoiseModel& noise)
+TEST(qpp_QDensityEngine_QDensityEngine, Noise) {
+    QCircuit qc{2, 1};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).nop();
+
+    // the noise acts on every qubit before every step, exactly
+    auto expected = [&](std::vector<cmat> Ks) {
+        cmat rho = prj(00_ket);
+        for (idx step = 0; step < 3; ++step) {
+            rho = apply(apply(rho, Ks, {0}), Ks, {1});
+            if (step == 0)
+                rho = apply(rho, gt.H, {0});
+            else if (step == 1)
+                rho = apply(rho, gt.CNOT, {0, 1});
+        }
+        return rho;
+    };
+
+    // state-independent noise, the probabilities are part of the channel
+    QubitDepolarizingNoise depolarizing{0.1};
+    std::vector<cmat> Ks = depolarizing.get_Ks();
+    std::vector<double> probs = depolarizing.get_probs();
+    for (idx i = 0; i < Ks.size(); ++i)
+        Ks[i] *= std::sqrt(probs[i]);
+    QDensityEngine density_engine{qc, depolarizing};
+    density_engine.execute();
+    EXPECT_NEAR(0, norm(density_engine.get_rho() - expected(Ks)), 1e-7);
+
+    // state-dependent noise
+    QubitAmplitudeDampingNoise damping{0.7};
+    density_engine = QDensityEngine{qc, damping};
+    density_engine.execute();
+    EXPECT_NEAR(0, norm(density_engine.get_rho() - expected(damping.get_Ks())),
+                1e-7);
+    EXPECT_NEAR(1, std::real(trace(density_engine.get_rho())), 1e-7);
+
+    // measurement statistics of the noisy Bell state
+    qc.measureZ({0, 1}, 0);
+    density_engine = QDensityEngine{qc, depolarizing};
+    density_engine.execute();
+    auto stats = density_engine.get_stats();
+    double total = 0;
+    for (auto&& elem : stats)
+        total += elem.second;
+    EXPECT_NEAR(1, total, 1e-7);
+    EXPECT_NEAR(stats["0"], stats["3"], 1e-7);
+    EXPECT_GT(stats["0"], stats["1"]);
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/// BEGIN QMPSEngine& qpp::QMPSEngine::execute(idx reps = 1,
+///       bool clear_stats = true)
+TEST(qpp_QMPSEngine_execute, AllCircuitWithRepetitions) {
+    // exact (untruncated) evolution, compare with the state vector evolution
+    for (idx d : {2, 3}) {
+        idx n = d == 2 ? 6 : 4;
+        QCircuit qc{n, 0, d};
+        qc.gate_fan(gt.Fd(d)).gate(randU(d * d), 0, n - 1);
+        qc.CTRL(randU(d), {n - 1, 1}, 2).gate_joint(randU(d * d * d), {3, 0, 1});
+        qc.CTRL(gt.Xd(d), 1, 0, d - 1).QFT({1, 3, 0}).TFQ({2, 0}, false);
+        QEngine engine{qc};
+        engine.execute();
+        QMPSEngine mps_engine{qc};
+        mps_engine.execute();
+        EXPECT_NEAR(0, norm(engine.get_psi() - mps_engine.get_psi()), 1e-7);
+        EXPECT_NEAR(0, mps_engine.get_trunc_err(), 1e-12);
+    }
+
+    // mid-circuit measurements and classically-controlled gate
+    QCircuit qc{4, 4};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 3).gate(gt.H, 1).measureZ(3, 0);
+    qc.cCTRL(gt.X, 0, 2).measureZ({0, 2}, 1, false).measureV(gt.H, 1, 2);
+    qc.reset(0).measureZ({2, 0}, 3);
+    QMPSEngine mps_engine{qc};
+    mps_engine.execute(100);
+    auto stats = mps_engine.get_stats();
+    EXPECT_EQ(2u, stats.size());
+    EXPECT_EQ(100u, stats["0 0 0 0"] + stats["1 3 0 2"]);
+    EXPECT_EQ(std::vector<idx>({0, 1, 2, 3}), mps_engine.get_measured());
+
+    // GHZ state of 100 qubits, with long-range gates and terminal
+    // measurements sampled from the matrix product state
+    idx n = 100;
+    qc = QCircuit{n, n};
+    qc.gate(gt.H, 0);
+    for (idx i = 0; i + 1 < n; ++i)
+        qc.CTRL(gt.X, i, i + 1);
+    qc.CTRL(gt.Z, 0, n - 1).CTRL(gt.Z, n - 1, 0);
+    for (idx i = 0; i < n; ++i)
+        qc.measureZ(i, i);
+    mps_engine = QMPSEngine{qc};
+    mps_engine.execute(1000);
+    stats = mps_engine.get_stats();
+    EXPECT_EQ(2u, stats.size());
+    std::vector<idx> dits = mps_engine.get_dits();
+    EXPECT_EQ(dits, std::vector<idx>(n, dits[0]));
+    EXPECT_NEAR(0, mps_engine.get_trunc_err(), 1e-12);
+
+    // sampled statistics follow the Born rule
+    qc = QCircuit{3, 1};
+    qc.gate_joint(randU(8), {0, 1, 2}).measureZ({2, 0, 1}, 0);
+    QEngine engine{qc};
+    idx reps = 10000;
+    for (auto it = qc.begin(); it != qc.end(); ++it)
+        if ((*it).type_ == QCircuit::StepType::GATE)
+            engine.execute(it);
+    ket psi = syspermute(engine.get_psi(), {2, 0, 1});
+    mps_engine = QMPSEngine{qc};
+    mps_engine.execute(reps);
+    stats = mps_engine.get_stats();
+    for (idx i = 0; i < 8; ++i)
+        EXPECT_NEAR(std::norm(psi(i)),
+                    static_cast<double>(stats[std::to_string(i)]) / reps,
+                    0.03);
+}
+/******************************************************************************/
+/// BEGIN explicit qpp::QMPSEngine::QMPSEngine(const QCircuit& qc,
+///       idx max_bond_dim = 256, double max_trunc_err = 1e-12)
+TEST(qpp_QMPSEngine_QMPSEngine, Truncation) {
+    // random brickwork circuit
+    idx n = 10;
+    QCircuit qc{n};
+    for (idx layer = 0; layer < 6; ++layer)
+        for (idx i = layer % 2; i + 1 < n; i += 2)
+            qc.gate(randU(4), i, i + 1);
+    QEngine engine{qc};
+    engine.execute();
+
+    QMPSEngine mps_engine{qc};
+    mps_engine.execute();
+    EXPECT_NEAR(0, norm(engine.get_psi() - mps_engine.get_psi()), 1e-7);
+
+    // the bond dimension cap is enforced, and the error is reported
+    mps_engine = QMPSEngine{qc, 4};
+    mps_engine.execute();
+    for (auto&& chi : mps_engine.get_bond_dims())
+        EXPECT_LE(chi, 4u);
+    double trunc_err = mps_engine.get_trunc_err();
+    EXPECT_GT(trunc_err, 0);
+    ket psi = mps_engine.get_psi();
+    EXPECT_NEAR(1, norm(psi), 1e-7);
+    double fidelity = std::norm(engine.get_psi().dot(psi));
+    EXPECT_LT(fidelity, 1);
+    EXPECT_GT(fidelity, 1 - 2 * trunc_err);
+
+    // the error cap drops small singular values only
+    mps_engine = QMPSEngine{qc, 256, 1e-2};
+    mps_engine.execute();
+    fidelity = std::norm(engine.get_psi().dot(mps_engine.get_psi()));
+    EXPECT_GT(fidelity, 1 - 2 * mps_engine.get_trunc_err());
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/// BEGIN QStabilizerEngine& qpp::QStabilizerEngine::execute(idx reps = 1,
+///       bool clear_stats = true)
+TEST(qpp_QStabilizerEngine_execute, AllCircuitWithRepetitions) {
+    // random Clifford circuits, compare with the state vector evolution
+    for (idx rep = 0; rep < 10; ++rep) {
+        idx n = 5;
+        QCircuit qc{n};
+        std::vector<cmat> gates{gt.Id2, gt.H, gt.S, adjoint(gt.S),
+                                gt.X,   gt.Y, gt.Z};
+        std::vector<cmat> gates2{gt.CNOT, gt.CZ, gt.SWAP};
+        std::vector<cmat> paulis{gt.X, gt.Y, gt.Z};
+        for (idx i = 0; i < 40; ++i) {
+            idx a = randidx(0, n - 1);
+            idx b = (a + randidx(1, n - 1)) % n;
+            switch (randidx(0, 4)) {
+                case 0:
+                    qc.gate(gates[randidx(0, gates.size() - 1)], a);
+                    break;
+                case 1:
+                    qc.gate(gates2[randidx(0, gates2.size() - 1)], a, b);
+                    break;
+                case 2:
+                    qc.CTRL(paulis[randidx(0, 2)], a, b, randidx(0, 1));
+                    break;
+                case 3:
+                    qc.gate_fan(gates[randidx(0, gates.size() - 1)], {a, b});
+                    break;
+                case 4:
+                    qc.QFT({a});
+                    break;
+            }
+        }
+        QEngine engine{qc};
+        engine.execute();
+        QStabilizerEngine stab_engine{qc};
+        stab_engine.execute();
+        EXPECT_NEAR(
+            1, std::abs(engine.get_psi().dot(stab_engine.get_psi())), 1e-7);
+    }
+
+    // Bell state
+    QCircuit qc_bell{2};
+    qc_bell.gate(gt.H, 0).gate(gt.CNOT, 0, 1);
+    QStabilizerEngine bell{qc_bell};
+    bell.execute();
+    EXPECT_EQ((std::vector<std::string>{"+XX", "+ZZ"}), bell.get_stabilizers());
+
+    // teleportation, mid-circuit measurements and classically-controlled
+    // gates, every repetition is executed
+    QCircuit qc{3, 2};
+    qc.gate(gt.H, 0).gate(gt.S, 0).gate(gt.H, 1).CTRL(gt.X, 1, 2);
+    qc.CTRL(gt.X, 0, 1).gate(gt.H, 0).measureZ(0, 0).measureZ(1, 1);
+    qc.cCTRL(gt.X, 1, 2).cCTRL(gt.Z, 0, 2);
+    QStabilizerEngine stab_engine{qc};
+    idx reps = 1000;
+    stab_engine.execute(reps);
+    ket expected = (0_ket + 1_i * 1_ket) / std::sqrt(2);
+    EXPECT_NEAR(1, std::abs(expected.dot(stab_engine.get_psi())), 1e-7);
+    EXPECT_EQ(std::vector<idx>({0, 1}), stab_engine.get_measured());
+    auto stats = stab_engine.get_stats();
+    EXPECT_EQ(4u, stats.size());
+    idx total = 0;
+    for (auto&& elem : stats)
+        total += elem.second;
+    EXPECT_EQ(reps, total);
+
+    // GHZ state on many qubits, terminal measurements are sampled
+    idx n = 200;
+    QCircuit qc_ghz{n, n};
+    qc_ghz.gate(gt.H, 0);
+    for (idx i = 0; i + 1 < n; ++i)
+        qc_ghz.CTRL(gt.X, i, i + 1);
+    for (idx i = 0; i < n; ++i)
+        qc_ghz.measureZ(i, i);
+    QStabilizerEngine ghz{qc_ghz};
+    reps = 10000;
+    ghz.execute(reps);
+    stats = ghz.get_stats();
+    EXPECT_EQ(2u, stats.size());
+    std::stringstream ones;
+    ones << disp(std::vector<idx>(n, 1), " ", "", "");
+    total = 0;
+    for (auto&& elem : stats)
+        total += elem.second;
+    EXPECT_EQ(reps, total);
+    EXPECT_NEAR(0.5, static_cast<double>(stats[ones.str()]) / reps, 0.05);
+    EXPECT_EQ(ghz.get_dit(0), ghz.get_dit(n - 1));
+    EXPECT_EQ(n, ghz.get_measured().size());
+}
+/******************************************************************************/
+/// BEGIN explicit qpp::QStabilizerEngine::QStabilizerEngine(
+///       const QCircuit& qc)
+TEST(qpp_QStabilizerEngine_QStabilizerEngine, NonClifford) {
+    QCircuit qc{3, 1};
+    qc.gate(gt.T, 0);
+    EXPECT_THROW(QStabilizerEngine{qc}, exception::NotClifford);
+
+    qc = QCircuit{3, 1};
+    qc.CTRL(gt.X, {0, 1}, 2);
+    EXPECT_THROW(QStabilizerEngine{qc}, exception::NotClifford);
+
+    qc = QCircuit{3, 1};
+    qc.CTRL(gt.H, 0, 1);
+    EXPECT_THROW(QStabilizerEngine{qc}, exception::NotClifford);
+
+    qc = QCircuit{3, 1};
+    qc.QFT({0, 1});
+    EXPECT_THROW(QStabilizerEngine{qc}, exception::NotClifford);
+
+    qc = QCircuit{3, 1};
+    qc.measureV(gt.H, 0, 0);
+    EXPECT_THROW(QStabilizerEngine{qc}, exception::NotClifford);
+
+    QCircuit qc_qutrits{2, 0, 3};
+    EXPECT_THROW(QStabilizerEngine{qc_qutrits}, exception::NotQubitSubsys);
+
+    qc = QCircuit{3, 1};
+    qc.gate(gt.H, 0).CTRL(gt.Z, 0, 1).measureZ(2, 0, false).reset(2);
+    QStabilizerEngine stab_engine{qc};
+    stab_engine.execute();
+    EXPECT_EQ(std::vector<idx>({0}), stab_engine.get_dits());
+}
+/******************************************************************************/
@@ -176,6 +176,23 @@ TEST(qpp_Gates_Id, AllTests) {
 /// BEGIN cmat qpp::Gates::MODMUL(idx a, idx N) const
 TEST(qpp_Gates_MODMUL, AllTests) {}
 /******************************************************************************/
+/// BEGIN std::vector<idx> qpp::Gates::MODMUL_perm(idx a, idx N, idx n) const
+TEST(qpp_Gates_MODMUL_perm, AllTests) {
+    // |x> -> |ax mod N> for x < N, identity otherwise
+    std::vector<idx> perm = gt.MODMUL_perm(7, 15, 4);
+    EXPECT_EQ(16u, perm.size());
+    for (idx x = 0; x < 15; ++x)
+        EXPECT_EQ(7 * x % 15, perm[x]);
+    EXPECT_EQ(15u, perm[15]);
+
+    // same as the gate matrix
+    cmat U = gt.MODMUL(7, 15, 4);
+    for (idx x = 0; x < 16; ++x)
+        EXPECT_NEAR(0, norm(U.col(x) - mket({perm[x]}, {16})), 1e-7);
+
+    EXPECT_THROW(gt.MODMUL_perm(7, 15, 3), exception::OutOfRange);
+}
+/******************************************************************************/
 /// BEGIN cmat qpp::Gates::Rn(double theta, const std::vector<double>& n) const
 TEST(qpp_Gates_Rn, AllTests) {
     // |z0> stays invariant (up to a phase) if rotated by any angle
@@ -36,6 +36,45 @@ TEST(qpp_NoiseBase_functor, SpecificQudit) {}
 ///       const std::vector<idx>& target) const
 TEST(qpp_NoiseBase_functor, CorrelatedNoise) {}
 /******************************************************************************/
+/// BEGIN virtual void qpp::NoiseBase::apply_inplace(ket& psi, idx target)
+///       const
+TEST(qpp_NoiseBase_apply_inplace, AllTests) {
+    auto& gen = RandomDevices::get_thread_local_instance().get_prng();
+
+    // same trajectory as the functor, for the same seed
+    QubitAmplitudeDampingNoise damping{0.4};
+    ket psi = randket(16);
+    for (idx target = 0; target < 4; ++target) {
+        gen.seed(target);
+        ket expected = damping(psi, target);
+        idx expected_idx = damping.get_last_idx();
+        std::vector<double> expected_probs = damping.get_probs();
+        gen.seed(target);
+        damping.apply_inplace(psi, target);
+        EXPECT_EQ(expected_idx, damping.get_last_idx());
+        EXPECT_EQ(expected_probs.size(), damping.get_probs().size());
+        for (idx i = 0; i < expected_probs.size(); ++i)
+            EXPECT_NEAR(expected_probs[i], damping.get_probs()[i], 1e-7);
+        EXPECT_NEAR(0, norm(expected - psi), 1e-7);
+    }
+
+    // probabilities of state-dependent noise, K1 = sqrt(1 - gamma)|0><1|
+    ket phi = kron(0_ket, 1_ket);
+    damping.apply_inplace(phi, 1);
+    EXPECT_NEAR(0.4, damping.get_probs()[0], 1e-7);
+    EXPECT_NEAR(0.6, damping.get_probs()[1], 1e-7);
+
+    // state-independent noise, qutrits
+    QuditDepolarizingNoise depolarizing{0.2, 3};
+    ket chi = randket(9);
+    gen.seed(1);
+    ket expected = depolarizing(chi, 0);
+    gen.seed(1);
+    depolarizing.apply_inplace(chi, 0);
+    EXPECT_NEAR(0, norm(expected - chi), 1e-7);
+    EXPECT_NEAR(1, norm(chi), 1e-7);
+}
+/******************************************************************************/
 
 /******************************************************************************/
 /// BEGIN explicit qpp::QubitAmplitudeDampingNoise::QubitAmplitudeDampingNoise(
@@ -31,69 +31,82 @@ TEST(qpp_ip, Qudits) {}
 TEST(qpp_ip, Qubits) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>> qpp::measure(
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>> qpp::measure(
 ///       const Eigen::MatrixBase<Derived>& A, const cmat& U)
 TEST(qpp_measure, Orthonormal) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>> qpp::measure(
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>> qpp::measure(
 ///       const Eigen::MatrixBase<Derived>& A, const cmat& V,
 ///       const std::vector<idx>& target, const std::vector<idx>& dims,
 ///       bool destructive = true)
 TEST(qpp_measure, RankOneQudits) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>> qpp::measure(
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>> qpp::measure(
 ///       const Eigen::MatrixBase<Derived>& A, const cmat& V,
 ///       const std::vector<idx>& target, idx d = 2, bool destructive = true)
 TEST(qpp_measure, RankOneQubits) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::initializer_list<cmat>& Ks)
 TEST(qpp_measure, KrausInitList) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
 ///       const std::vector<idx>& dims, bool destructive = true)
 TEST(qpp_measure, SubsysKrausInitList) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
 ///       idx d = 2, bool destructive = true)
 TEST(qpp_measure, SubsysKrausInitListQubits) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<cmat>& Ks)
 TEST(qpp_measure, KrausVector) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<cmat>& Ks, const std::vector<idx>& target,
 ///       const std::vector<idx>& dims, bool destructive = true)
 TEST(qpp_measure, SubsysKrausVector) {}
 /******************************************************************************/
 /// BEGIN template <typename Derived>
-///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       std::tuple<idx, std::vector<double>,
+///       std::vector<dyn_mat<typename Derived::Scalar>>>
 ///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<cmat>& Ks, const std::vector<idx>& target,
 ///       idx d = 2)
 TEST(qpp_measure, SubsysKrausVectorQubits) {}
 /******************************************************************************/
-/// BEGIN template <typename Derived> std::tuple<std::vector<idx>, double, cmat>
+/// BEGIN template <typename Derived>
+///       std::tuple<std::vector<idx>, double,
+///       dyn_mat<typename Derived::Scalar>>
 ///       qpp::measure_seq(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, idx d = 2, bool destructive = true)
 TEST(qpp_measure_seq, Qubits) {}
 /******************************************************************************/
-/// BEGIN template <typename Derived> std::tuple<std::vector<idx>, double, cmat>
+/// BEGIN template <typename Derived>
+///       std::tuple<std::vector<idx>, double,
+///       dyn_mat<typename Derived::Scalar>>
 ///       qpp::measure_seq(const Eigen::MatrixBase<Derived>& A,
 ///       std::vector<idx> target, std::vector<idx> dims,
 ///       bool destructive = true)
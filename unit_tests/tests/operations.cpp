@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <vector>
 #include "gtest/gtest.h"
 #include "qpp.h"
@@ -157,17 +159,432 @@ TEST(qpp_applyCTRL, EmptyControl) {
 ///       const Eigen::MatrixBase<Derived2>& A, const std::vector<idx>& ctrl,
 ///       const std::vector<idx>& target, idx d = 2,
 ///       std::vector<idx> shift = {})
-TEST(qpp_applyCTRL, Qubits) {}
+TEST(qpp_applyCTRL, Qubits) {
+    // many controls, only the control subspace is modified
+    idx n = 7;
+    ket psi = randket(static_cast<idx>(1) << n);
+    cmat rho = randrho(static_cast<idx>(1) << n);
+    std::vector<idx> ctrl{5, 0, 3, 1};
+    for (auto&& target :
+         std::vector<std::vector<idx>>{{2}, {6, 4}, {4, 2, 6}}) {
+        cmat U = randU(static_cast<idx>(1) << target.size());
+        for (auto&& shift :
+             std::vector<std::vector<idx>>{{}, {1, 0, 0, 1}}) {
+            cmat CTRL = gt.CTRL(U, ctrl, target, n, 2, shift);
+            ket result = applyCTRL(psi, U, ctrl, target, 2, shift);
+            EXPECT_NEAR(0, norm(result - CTRL * psi), 1e-7);
+            EXPECT_NEAR(0,
+                        norm(applyCTRL(rho, U, ctrl, target, 2, shift) -
+                             CTRL * rho * adjoint(CTRL)),
+                        1e-7);
+
+            // amplitudes outside the control subspace are left untouched
+            idx changed = 0;
+            for (idx i = 0; i < result.size(); ++i)
+                if (result(i) != psi(i))
+                    ++changed;
+            EXPECT_GE(psi.size() >> ctrl.size(), changed);
+        }
+    }
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar, typename Derived>
+///       void qpp::applyCTRL_inplace(dyn_col_vect<Scalar>& state,
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& ctrl,
+///       const std::vector<idx>& target, const std::vector<idx>& dims,
+///       std::vector<idx> shift = {})
+TEST(qpp_applyCTRL_inplace, Qudits) {
+    // qubits, 1 and 2 targets (dedicated kernels) and 3 targets
+    idx n = 5, d = 2;
+    std::vector<idx> dims(n, d);
+    ket psi = randket(prod(dims));
+
+    std::vector<idx> ctrl{3, 0};
+    for (auto&& target :
+         std::vector<std::vector<idx>>{{2}, {4, 1}, {1, 4, 2}}) {
+        cmat U = randU(static_cast<idx>(1) << target.size());
+        for (auto&& shift : std::vector<std::vector<idx>>{{}, {1, 0}}) {
+            ket result = psi;
+            applyCTRL_inplace(result, U, ctrl, target, dims, shift);
+            ket expected = gt.CTRL(U, ctrl, target, n, d, shift) * psi;
+            EXPECT_NEAR(0, norm(result - expected), 1e-7);
+        }
+    }
+
+    // qudits
+    n = 4, d = 3;
+    dims = std::vector<idx>(n, d);
+    psi = randket(prod(dims));
+    ctrl = {1, 3};
+    std::vector<idx> target{2, 0};
+    cmat U = randU(d * d);
+    for (auto&& shift : std::vector<std::vector<idx>>{{}, {2, 1}}) {
+        ket result = psi;
+        applyCTRL_inplace(result, U, ctrl, target, dims, shift);
+        ket expected = gt.CTRL(U, ctrl, target, n, d, shift) * psi;
+        EXPECT_NEAR(0, norm(result - expected), 1e-7);
+    }
+
+    // mixed dimensions, no control
+    dims = {2, 3, 2};
+    psi = randket(prod(dims));
+    U = randU(6);
+    ket result = psi;
+    applyCTRL_inplace(result, U, {}, {2, 1}, dims);
+    EXPECT_NEAR(0, norm(prj(result) - apply(prj(psi), U, {2, 1}, dims)),
+                1e-7);
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar, typename Derived>
+///       void qpp::applyCTRL_inplace(dyn_mat<Scalar>& state,
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& ctrl,
+///       const std::vector<idx>& target, const std::vector<idx>& dims,
+///       std::vector<idx> shift = {})
+TEST(qpp_applyCTRL_inplace, DensityMatrices) {
+    // qubits, 1 and 2 targets (dedicated kernels) and 3 targets
+    idx n = 4, d = 2;
+    std::vector<idx> dims(n, d);
+    cmat rho = randrho(prod(dims));
+
+    std::vector<idx> ctrl{3};
+    for (auto&& target :
+         std::vector<std::vector<idx>>{{2}, {0, 1}, {1, 0, 2}}) {
+        cmat U = randU(static_cast<idx>(1) << target.size());
+        for (auto&& shift : std::vector<std::vector<idx>>{{}, {1}}) {
+            cmat result = rho;
+            applyCTRL_inplace(result, U, ctrl, target, dims, shift);
+            cmat expected = applyCTRL(rho, U, ctrl, target, dims, shift);
+            EXPECT_NEAR(0, norm(result - expected), 1e-7);
+        }
+    }
+
+    // qudits
+    n = 3, d = 3;
+    rho = randrho(static_cast<idx>(std::llround(std::pow(d, n))));
+    cmat U = randU(d);
+    cmat result = rho;
+    applyCTRL_inplace(result, U, {0, 2}, {1}, d, {2, 1});
+    EXPECT_NEAR(0, norm(result - applyCTRL(rho, U, {0, 2}, {1}, d, {2, 1})),
+                1e-7);
+
+    // mixed dimensions, no control
+    dims = {2, 3, 2};
+    rho = randrho(prod(dims));
+    U = randU(6);
+    result = rho;
+    applyCTRL_inplace(result, U, {}, {2, 1}, dims);
+    EXPECT_NEAR(0, norm(result - apply(rho, U, {2, 1}, dims)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar>
+///       void qpp::applyCTRL_permutation_inplace(dyn_col_vect<Scalar>& state,
+///       const std::vector<idx>& perm, const std::vector<idx>& ctrl,
+///       const std::vector<idx>& target, const std::vector<idx>& dims,
+///       std::vector<idx> shift = {})
+TEST(qpp_applyCTRL_permutation_inplace, AllTests) {
+    // Toffoli
+    ket psi = 0.8 * 110_ket + 0.6 * 011_ket;
+    applyCTRL_permutation_inplace(psi, {1, 0}, {0, 1}, {2});
+    EXPECT_EQ(0.8 * 111_ket + 0.6 * 011_ket, psi);
+
+    // qubits, modular multiplication
+    psi = randket(64);
+    ket result = psi;
+    applyCTRL_permutation_inplace(result, gt.MODMUL_perm(7, 15, 4), {1},
+                                  {2, 0, 4, 5});
+    EXPECT_NEAR(
+        0,
+        norm(result - applyCTRL(psi, gt.MODMUL(7, 15, 4), {1}, {2, 0, 4, 5})),
+        1e-7);
+
+    // qudits, the gate being raised to the value of the controls
+    idx d = 3;
+    std::vector<idx> perm{3, 1, 8, 0, 2, 4, 7, 5, 6};
+    cmat P = cmat::Zero(9, 9);
+    for (idx m = 0; m < 9; ++m)
+        P(perm[m], m) = 1;
+    psi = randket(81);
+    result = psi;
+    applyCTRL_permutation_inplace(result, perm, {0, 2}, {3, 1}, d, {1, 2});
+    EXPECT_NEAR(0,
+                norm(result - applyCTRL(psi, P, {0, 2}, {3, 1}, d, {1, 2})),
+                1e-7);
+
+    // mixed dimensions
+    std::vector<idx> dims{2, 3, 2};
+    psi = randket(12);
+    result = psi;
+    applyCTRL_permutation_inplace(result, {1, 2, 0}, {2}, {1}, dims);
+    EXPECT_NEAR(0, norm(result - applyCTRL(psi, gt.Xd(3), {2}, {1}, dims)),
+                1e-7);
+
+    // invalid permutations
+    EXPECT_THROW(applyCTRL_permutation_inplace(result, {1, 1, 0}, {2}, {1},
+                                               dims),
+                 exception::PermInvalid);
+    EXPECT_THROW(applyCTRL_permutation_inplace(result, {1, 0}, {2}, {1},
+                                               dims),
+                 exception::PermMismatchDims);
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar, typename Derived>
+///       void qpp::apply_inplace(dyn_col_vect<Scalar>& state,
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
+///       idx d = 2)
+TEST(qpp_apply_inplace, Qubits) {
+    ket psi = 0.8 * 00_ket + 0.6 * 11_ket;
+    apply_inplace(psi, gt.X, {1});
+    EXPECT_EQ(0.8 * 01_ket + 0.6 * 10_ket, psi);
+    apply_inplace(psi, gt.CNOT, {1, 0});
+    EXPECT_EQ(0.8 * 11_ket + 0.6 * 10_ket, psi);
+
+    psi = 0.8 * 0000_ket + 0.6 * 1111_ket;
+    apply_inplace(psi, kron(gt.X, gt.Z), {2, 1});
+    EXPECT_EQ(0.8 * 0010_ket - 0.6 * 1101_ket, psi);
+    apply_inplace(psi, gt.TOF, {0, 1, 3});
+    EXPECT_EQ(0.8 * 0010_ket - 0.6 * 1100_ket, psi);
+
+    // random gates on 6 qubits
+    idx n = 6;
+    psi = randket(static_cast<idx>(1) << n);
+    cmat rho = prj(psi);
+    for (auto&& target :
+         std::vector<std::vector<idx>>{{0}, {5}, {3, 1}, {0, 5}}) {
+        cmat U = randU(static_cast<idx>(1) << target.size());
+        ket result = psi;
+        apply_inplace(result, U, target);
+        // compare with the density matrix evolution
+        EXPECT_NEAR(0, norm(prj(result) - apply(rho, U, target)), 1e-7);
+    }
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar, typename Derived>
+///       void qpp::apply_inplace(dyn_mat<Scalar>& state,
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
+///       idx d = 2)
+TEST(qpp_apply_inplace, DensityMatrices) {
+    cmat rho = prj(0.8 * 00_ket + 0.6 * 11_ket);
+    apply_inplace(rho, gt.X, {1});
+    EXPECT_NEAR(0, norm(rho - prj(0.8 * 01_ket + 0.6 * 10_ket)), 1e-7);
+
+    // random gates on 4 qutrits
+    idx n = 4, d = 3;
+    rho = randrho(static_cast<idx>(std::llround(std::pow(d, n))));
+    for (auto&& target : std::vector<std::vector<idx>>{{0}, {3}, {2, 0}}) {
+        cmat U = randU(
+            static_cast<idx>(std::llround(std::pow(d, target.size()))));
+        cmat result = rho;
+        apply_inplace(result, U, target, d);
+        EXPECT_NEAR(0, norm(result - apply(rho, U, target, d)), 1e-7);
+    }
+}
+/******************************************************************************/
+/// BEGIN inline void qpp::apply_inplace(cmat& state,
+///       const std::vector<cmat>& Ks, const std::vector<idx>& target,
+///       idx d = 2)
+TEST(qpp_apply_inplace, KrausOperators) {
+    // qubits, single and two-qubit channels
+    idx n = 4;
+    cmat rho = randrho(static_cast<idx>(1) << n);
+    for (auto&& target : std::vector<std::vector<idx>>{{0}, {3}, {2, 1}}) {
+        std::vector<cmat> Ks =
+            randkraus(3, static_cast<idx>(1) << target.size());
+        cmat result = rho;
+        apply_inplace(result, Ks, target);
+        EXPECT_NEAR(0, norm(result - apply(rho, Ks, target)), 1e-7);
+    }
+
+    // mixed dimensions
+    std::vector<idx> dims{2, 3, 2};
+    rho = randrho(prod(dims));
+    std::vector<cmat> Ks = randkraus(2, 3);
+    cmat result = rho;
+    apply_inplace(result, Ks, {1}, dims);
+    EXPECT_NEAR(0, norm(result - apply(rho, Ks, {1}, dims)), 1e-7);
+
+    // trace preserving
+    EXPECT_NEAR(1, std::real(trace(result)), 1e-7);
+}
+/******************************************************************************/
+TEST(qpp_apply_inplace, VectorizedKernels) {
+    using internal::SimdISA;
+    SimdISA detected = internal::simd_isa();
+
+    // every supported instruction set must agree with the scalar kernels,
+    // including the cases that fall back to narrower registers (target or
+    // control on the least significant qubits)
+    idx n = 6;
+    ket psi = randket(static_cast<idx>(1) << n);
+    std::vector<std::pair<std::vector<idx>, std::vector<idx>>> ctrl_target{
+        {{}, {0}},     {{}, {5}},     {{}, {4}},     {{2}, {3}},
+        {{5}, {0}},    {{}, {1, 5}},  {{}, {5, 4}},  {{0}, {3, 2}},
+        {{4}, {0, 2}}, {{3, 1}, {0}}, {{5}, {4, 3}}, {{2}, {1, 0}}};
+    for (auto&& elem : ctrl_target) {
+        const std::vector<idx>& ctrl = elem.first;
+        const std::vector<idx>& target = elem.second;
+        cmat U = randU(static_cast<idx>(1) << target.size());
+
+        internal::simd_isa() = SimdISA::NONE;
+        ket expected = psi;
+        applyCTRL_inplace(expected, U, ctrl, target);
+
+        for (auto isa : {SimdISA::SSE2, SimdISA::AVX2, SimdISA::AVX512}) {
+            if (isa > detected)
+                break;
+            internal::simd_isa() = isa;
+            ket result = psi;
+            applyCTRL_inplace(result, U, ctrl, target);
+            EXPECT_NEAR(0, norm(result - expected), 1e-12);
+        }
+    }
+
+    internal::simd_isa() = detected;
+}
+/******************************************************************************/
+/// BEGIN template <typename Scalar>
+///       void qpp::apply_permutation_inplace(dyn_col_vect<Scalar>& state,
+///       const std::vector<idx>& perm, const std::vector<idx>& target,
+///       idx d = 2)
+TEST(qpp_apply_permutation_inplace, AllTests) {
+    ket psi = 0.8 * 001_ket + 0.6 * 110_ket;
+    apply_permutation_inplace(psi, {0, 2, 1, 3}, {2, 0});
+    EXPECT_EQ(0.8 * 100_ket + 0.6 * 011_ket, psi);
+
+    // qudits
+    idx d = 3;
+    std::vector<idx> perm{3, 1, 8, 0, 2, 4, 7, 5, 6};
+    cmat P = cmat::Zero(9, 9);
+    for (idx m = 0; m < 9; ++m)
+        P(perm[m], m) = 1;
+    psi = randket(27);
+    ket result = psi;
+    apply_permutation_inplace(result, perm, {2, 1}, d);
+    EXPECT_NEAR(0, norm(result - apply(psi, P, {2, 1}, d)), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::applyQFT(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, idx d = 2, bool swap = true)
-TEST(qpp_applyQFT, AllTests) {}
+TEST(qpp_applyQFT, AllTests) {
+    // the QFT (with swaps) on k qudits is the DFT matrix Fd(d^k); without
+    // swaps the target digits come out in reverse order
+    for (idx d : {2, 3}) {
+        idx n = 4;
+        std::vector<idx> dims(n, d);
+        idx D = prod(dims);
+        ket psi = randket(D);
+        cmat rho = randrho(D);
+
+        for (auto&& target : std::vector<std::vector<idx>>{
+                 {1}, {0, 1, 2, 3}, {1, 2}, {3, 0, 2}}) {
+            idx k = target.size();
+            cmat F = gt.Fd(static_cast<idx>(std::llround(std::pow(d, k))));
+            std::vector<idx> perm(n); // reverses the target digits
+            std::iota(std::begin(perm), std::end(perm), 0);
+            for (idx i = 0; i < k; ++i)
+                perm[target[i]] = target[k - 1 - i];
+
+            ket expected = apply(psi, F, target, d);
+            EXPECT_NEAR(0, norm(applyQFT(psi, target, d) - expected), 1e-10);
+            EXPECT_NEAR(0,
+                        norm(applyQFT(psi, target, d, false) -
+                             syspermute(expected, perm, d)),
+                        1e-10);
+
+            cmat expected_rho = apply(rho, F, target, d);
+            EXPECT_NEAR(0, norm(applyQFT(rho, target, d) - expected_rho),
+                        1e-10);
+        }
+    }
+}
+/******************************************************************************/
+/// BEGIN template <typename Derived> void qpp::applyQFT_inplace(
+///       Eigen::PlainObjectBase<Derived>& state,
+///       const std::vector<idx>& target, idx d = 2, bool swap = true)
+TEST(qpp_applyQFT_inplace, AllTests) {
+    // must agree with the out-of-place version, in particular on large
+    // registers that use the blocked twiddle tables
+    idx n = 12, d = 2;
+    ket psi = randket(static_cast<idx>(1) << n);
+    for (auto&& target : std::vector<std::vector<idx>>{
+             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, {2, 3, 4, 5, 6}, {7, 1}}) {
+        for (bool swap : {true, false}) {
+            ket result = psi;
+            applyQFT_inplace(result, target, d, swap);
+            EXPECT_NEAR(0, norm(result - applyQFT(psi, target, d, swap)),
+                        1e-10);
+        }
+    }
+
+    // qutrit density matrix
+    d = 3;
+    cmat rho = randrho(27);
+    cmat result = rho;
+    applyQFT_inplace(result, {0, 2}, d);
+    EXPECT_NEAR(0, norm(result - apply(rho, gt.Fd(9), {0, 2}, d)), 1e-10);
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::applyTFQ(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, idx d = 2, bool swap = true)
-TEST(qpp_applyTQF, AllTests) {}
+TEST(qpp_applyTQF, AllTests) {
+    // the inverse QFT undoes the QFT, with and without swaps
+    for (idx d : {2, 3}) {
+        idx n = 4;
+        std::vector<idx> dims(n, d);
+        idx D = prod(dims);
+        ket psi = randket(D);
+        cmat rho = randrho(D);
+
+        for (auto&& target : std::vector<std::vector<idx>>{
+                 {2}, {0, 1, 2, 3}, {2, 3}, {3, 0, 2}}) {
+            idx k = target.size();
+            cmat F = gt.Fd(static_cast<idx>(std::llround(std::pow(d, k))));
+
+            EXPECT_NEAR(0,
+                        norm(applyTFQ(psi, target, d) -
+                             apply(psi, adjoint(F), target, d)),
+                        1e-10);
+            for (bool swap : {true, false}) {
+                EXPECT_NEAR(0,
+                            norm(applyTFQ(applyQFT(psi, target, d, swap),
+                                          target, d, swap) -
+                                 psi),
+                            1e-10);
+                EXPECT_NEAR(0,
+                            norm(applyTFQ(applyQFT(rho, target, d, swap),
+                                          target, d, swap) -
+                                 rho),
+                            1e-10);
+            }
+        }
+    }
+}
+/******************************************************************************/
+/// BEGIN template <typename Derived> void qpp::applyTFQ_inplace(
+///       Eigen::PlainObjectBase<Derived>& state,
+///       const std::vector<idx>& target, idx d = 2, bool swap = true)
+TEST(qpp_applyTFQ_inplace, AllTests) {
+    idx n = 12, d = 2;
+    ket psi = randket(static_cast<idx>(1) << n);
+    for (auto&& target : std::vector<std::vector<idx>>{
+             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, {2, 3, 4, 5, 6}, {7, 1}}) {
+        for (bool swap : {true, false}) {
+            ket result = psi;
+            applyTFQ_inplace(result, target, d, swap);
+            EXPECT_NEAR(0, norm(result - applyTFQ(psi, target, d, swap)),
+                        1e-10);
+        }
+    }
+
+    // qutrit density matrix
+    d = 3;
+    cmat rho = randrho(27);
+    cmat result = rho;
+    applyTFQ_inplace(result, {0, 2}, d);
+    EXPECT_NEAR(0, norm(result - apply(rho, adjoint(gt.Fd(9)), {0, 2}, d)),
+                1e-10);
+}
 /******************************************************************************/
 /// BEGIN inline std::vector<cmat> qpp::choi2kraus(const cmat& A, idx Din,
 ///       idx Dout)
@@ -185,12 +602,57 @@ TEST(qpp_kraus2super, AllTests) {}
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptrace(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, const std::vector<idx>& dims)
-TEST(qpp_ptrace, Qudits) {}
+TEST(qpp_ptrace, Qudits) {
+    // state vectors, compared with the partial trace of the density matrix,
+    // for every subset of traced out subsystems
+    std::vector<idx> dims{2, 3, 2, 3};
+    ket psi = randket(36);
+    cmat rho = prj(psi);
+    for (idx mask = 0; mask < 16; ++mask) {
+        std::vector<idx> target;
+        for (idx i = 0; i < 4; ++i)
+            if (mask & (1u << i))
+                target.emplace_back(i);
+        cmat result = ptrace(psi, target, dims);
+        EXPECT_NEAR(0, norm(result - ptrace(rho, target, dims)), 1e-7);
+        EXPECT_NEAR(1, std::abs(trace(result)), 1e-7);
+    }
+
+    // order of the traced out subsystems is irrelevant
+    EXPECT_NEAR(0,
+                norm(ptrace(psi, {3, 0}, dims) - ptrace(psi, {0, 3}, dims)),
+                1e-7);
+
+    // product state
+    ket a = randket(3), b = randket(2), c = randket(3);
+    ket abc = kron(a, b, c);
+    EXPECT_NEAR(0, norm(ptrace(abc, {1}, {3, 2, 3}) - prj(kron(a, c))), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(abc, {0, 2}, {3, 2, 3}) - prj(b)), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptrace(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, idx d = 2)
-TEST(qpp_ptrace, Qubits) {}
+TEST(qpp_ptrace, Qubits) {
+    // Bell pair between qubits 1 and 3, qubits 0 and 2 in a product state
+    ket psi = kron(0_ket, st.b00);
+    psi = syspermute(kron(psi, 1_ket), {0, 1, 3, 2});
+    EXPECT_NEAR(0, norm(ptrace(psi, {0, 2}) - prj(st.b00)), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(psi, {0, 1, 2}) - gt.Id2 / 2), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(psi, {1, 3}) - prj(01_ket)), 1e-7);
+    EXPECT_NEAR(1, std::abs(ptrace(psi, {0, 1, 2, 3})(0, 0)), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(psi, {}) - prj(psi)), 1e-7);
+
+    // larger random states, contiguous and non-contiguous kept qubits
+    ket phi = randket(256);
+    cmat rho = prj(phi);
+    for (auto&& target : {std::vector<idx>{0, 1, 2}, std::vector<idx>{5, 6, 7},
+                          std::vector<idx>{0, 1, 6, 7},
+                          std::vector<idx>{1, 3, 5, 7}}) {
+        EXPECT_NEAR(0, norm(ptrace(phi, target) - ptrace(rho, target)),
+                    1e-7);
+    }
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptrace1(const Eigen::MatrixBase<Derived>& A,
@@ -213,7 +675,39 @@ TEST(qpp_ptrace2, Qubits) {}
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptranspose(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target, const std::vector<idx>& dims)
-TEST(qpp_ptranspose, Qudits) {}
+TEST(qpp_ptranspose, Qudits) {
+    // product states
+    std::vector<idx> dims{2, 3, 4};
+    cmat rhoA = randrho(2), rhoB = randrho(3), rhoC = randrho(4);
+    cmat rho = kron(rhoA, rhoB, rhoC);
+    EXPECT_NEAR(0,
+                norm(ptranspose(rho, {1}, dims) -
+                     kron(rhoA, transpose(rhoB), rhoC)),
+                1e-7);
+    EXPECT_NEAR(0,
+                norm(ptranspose(rho, {2, 0}, dims) -
+                     kron(transpose(rhoA), rhoB, transpose(rhoC))),
+                1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {0, 1, 2}, dims) - transpose(rho)),
+                1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {}, dims) - rho), 1e-7);
+
+    // generic states, the partial transpose is an involution and the
+    // partial transposes on complementary subsystems are related by the
+    // full transpose
+    rho = randrho(24);
+    cmat result = ptranspose(rho, {0, 2}, dims);
+    EXPECT_NEAR(0, norm(ptranspose(result, {0, 2}, dims) - rho), 1e-7);
+    EXPECT_NEAR(0, norm(transpose(result) - ptranspose(rho, {1}, dims)),
+                1e-7);
+
+    // state vectors
+    ket psi = randket(24);
+    EXPECT_NEAR(0,
+                norm(ptranspose(psi, {1, 2}, dims) -
+                     ptranspose(prj(psi), {1, 2}, dims)),
+                1e-7);
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptranspose(const Eigen::MatrixBase<Derived>& A,
@@ -223,7 +717,16 @@ TEST(qpp_ptranspose, Qubits) {}
 /// BEGIN template <typename Derived> dyn_col_vect<typename Derived::Scalar>
 ///       qpp::QFT(const Eigen::MatrixBase<Derived>& A, idx d = 2,
 ///       bool swap = true)
-TEST(qpp_QFT, AllTests) {}
+TEST(qpp_QFT, AllTests) {
+    // the QFT of a computational basis state |x> is the DFT column x
+    idx n = 3, d = 3;
+    idx D = 27;
+    cmat F = gt.Fd(D);
+    for (idx x : {0, 5, 26}) {
+        ket psi = mket(n2multiidx(x, std::vector<idx>(n, d)), d);
+        EXPECT_NEAR(0, norm(QFT(psi, d) - F.col(x)), 1e-10);
+    }
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_col_vect<typename Derived::Scalar>
 ///       qpp::qRAM(const Eigen::MatrixBase<Derived>& psi, const qram& data,
@@ -239,7 +742,49 @@ TEST(qpp_super2kraus, AllTests) {}
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::syspermute(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& perm, const std::vector<idx>& dims)
-TEST(qpp_syspermute, Qudits) {}
+TEST(qpp_syspermute, Qudits) {
+    // product states
+    std::vector<idx> dims{2, 3, 4};
+    ket a = randket(2), b = randket(3), c = randket(4);
+    EXPECT_NEAR(0, norm(syspermute(kron(a, b, c), {2, 0, 1}, dims) -
+                        kron(c, a, b)),
+                1e-7);
+    EXPECT_NEAR(0, norm(syspermute(kron(a, b, c), {1, 2, 0}, dims) -
+                        kron(b, c, a)),
+                1e-7);
+    cmat rhoA = randrho(2), rhoB = randrho(3), rhoC = randrho(4);
+    EXPECT_NEAR(0,
+                norm(syspermute(kron(rhoA, rhoB, rhoC), {2, 1, 0}, dims) -
+                     kron(rhoC, rhoB, rhoA)),
+                1e-7);
+
+    // the inverse permutation restores the state, for every permutation
+    ket psi = randket(24);
+    cmat rho = randrho(24);
+    std::vector<idx> perm{0, 1, 2};
+    do {
+        std::vector<idx> perm_dims(3), inv(3);
+        for (idx i = 0; i < 3; ++i) {
+            perm_dims[i] = dims[perm[i]];
+            inv[perm[i]] = i;
+        }
+        EXPECT_NEAR(0,
+                    norm(syspermute(syspermute(psi, perm, dims), inv,
+                                    perm_dims) -
+                         psi),
+                    1e-7);
+        EXPECT_NEAR(0,
+                    norm(syspermute(syspermute(rho, perm, dims), inv,
+                                    perm_dims) -
+                         rho),
+                    1e-7);
+        // consistent with the action on state vectors
+        EXPECT_NEAR(0,
+                    norm(syspermute(prj(psi), perm, dims) -
+                         prj(syspermute(psi, perm, dims))),
+                    1e-7);
+    } while (std::next_permutation(std::begin(perm), std::end(perm)));
+}
 /******************************************************************************/
 /// BEGIN template <typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::syspermute(const Eigen::MatrixBase<Derived>& A,
@@ -249,5 +794,10 @@ TEST(qpp_syspermute, Qubits) {}
 /// BEGIN template <typename Derived> dyn_col_vect<typename Derived::Scalar>
 ///       qpp::TFQ(const Eigen::MatrixBase<Derived>& A,
 ///       idx d = 2, bool swap = true)
-TEST(qpp_TFQ, AllTests) {}
+TEST(qpp_TFQ, AllTests) {
+    idx D = static_cast<idx>(1) << 5;
+    ket psi = randket(D);
+    EXPECT_NEAR(0, norm(TFQ(QFT(psi)) - psi), 1e-10);
+    EXPECT_NEAR(0, norm(TFQ(psi) - adjoint(gt.Fd(D)) * psi), 1e-10);
+}
 /******************************************************************************/